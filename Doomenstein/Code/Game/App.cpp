@@ -4,11 +4,13 @@
 #include "Engine/Core/XmlUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/Clock.hpp"
+#include "Engine/Core/Profiler.hpp"
 
 Renderer* g_theRenderer = nullptr; // created and owned by the App
 BitmapFont* g_testFont = nullptr;
 InputSystem* g_theInput = nullptr;
 AudioSystem* g_theAudio = nullptr;
+JobSystem* g_theJobSystem = nullptr;
 Window* g_theWindow = nullptr;
 Game* g_theGame = nullptr;
 
@@ -31,6 +33,8 @@ App::~App()
 {
 	delete g_theGame;
 	g_theGame = nullptr;
+	delete g_theJobSystem;
+	g_theJobSystem = nullptr;
 	delete g_theAudio;
 	g_theAudio = nullptr;
 	delete g_theConsole;
@@ -84,12 +88,17 @@ void App::Startup()
 	AudioSystemConfig audioSystemConfig;
 	g_theAudio = new AudioSystem(audioSystemConfig);
 
+	JobSystemConfig jobSystemConfig;
+	g_theJobSystem = new JobSystem(jobSystemConfig);
+
 	g_theEventSystem->Startup();
 	g_theInput->Startup();
 	g_theWindow->Startup();
 	g_theRenderer->Startup();
 	g_theConsole->Startup();
 	g_theAudio->Startup();
+	g_theJobSystem->Startup();
+	Profiler::SetThreadName("main");
 
 	g_theGame = new Game(); // create an instance that will handle different modes soon
 	g_theGame->Startup(); // start up the game when there is a renderer
@@ -99,6 +108,7 @@ void App::Shutdown()
 {
 	g_theGame->Shutdown();
 
+	g_theJobSystem->Shutdown();
 	g_theAudio->Shutdown();
 	g_theConsole->Shutdown();
 	g_theRenderer->Shutdown();
@@ -139,6 +149,7 @@ void App::BeginFrame()
 	g_theRenderer->BeginFrame();
 	g_theConsole->BeginFrame();
 	g_theAudio->BeginFrame();
+	g_theJobSystem->BeginFrame();
 };
 
 void App::Update(float deltaSeconds)
@@ -160,6 +171,8 @@ void App::Render() const
 
 void App::EndFrame()
 {
+	g_theJobSystem->EndFrame();
+	Profiler::EndFrame();
 	g_theAudio->EndFrame();
 	g_theConsole->EndFrame();
 	g_theRenderer->EndFrame();
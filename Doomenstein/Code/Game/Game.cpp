@@ -7,6 +7,9 @@
 #include "Engine/Renderer/DebugRenderMode.hpp"
 #include "Game/MapDefinition.hpp"
 #include "Game/WeaponDefinition.hpp"
+#include "Game/Map.hpp"
+#include "Engine/Core/JobSystemBenchmark.hpp"
+#include "Engine/Core/Profiler.hpp"
 
 RandomNumberGenerator random; // singleton for now only used by entities in the Game
 
@@ -18,6 +21,57 @@ bool Command_Test(EventArgs& args)
 	return false;
 }
 
+// console command: parallelbench workers=<max> repeats=<count>
+// scaling of the distance field sweeps on the current map, flooding from the map center, worker count 0 is the serial baseline
+bool Command_ParallelBenchmark(EventArgs& args)
+{
+	Map* map = g_theGame->m_map;
+	if (map == nullptr)
+	{
+		g_theConsole->AddLine(DevConsole::TINT_ERROR, "parallelbench needs a map, start a game first");
+		return false;
+	}
+	int maxWorkers = args.GetValue("workers", 16);
+	int repeats = args.GetValue("repeats", 20);
+
+	TileHeatMap maskMap(map->m_dimensions);
+	map->CreateMaskMap(maskMap);
+	TileHeatMap distanceField(map->m_dimensions);
+	RunParallelScalingBenchmark("distance field", maxWorkers, repeats, [&](JobSystem& jobSystem)
+	{
+		distanceField.SetAllValues(HEAT_MAX);
+		distanceField.Set(0.0f, map->m_dimensions.x / 2, map->m_dimensions.y / 2);
+		map->RelaxDistanceField(distanceField, maskMap, jobSystem);
+	});
+	return true;
+}
+
+// console command: jobidle reset=<true|false>
+// busy, spinning and parked time per worker plus the queue to start latency, since startup or the last reset
+bool Command_JobIdle(EventArgs& args)
+{
+	g_theJobSystem->ReportWorkerIdleStats();
+	if (args.GetValue("reset", false))
+	{
+		g_theJobSystem->ResetWorkerIdleStats();
+		g_theJobSystem->ResetQueueWaitHistograms();
+	}
+	return true;
+}
+
+// console command: jobtrace seconds=<duration> file=<path>
+// starts recording every job run, the next jobtrace (or the time limit) writes Chrome trace JSON for chrome://tracing
+bool Command_JobTrace(EventArgs& args)
+{
+	if (g_theJobSystem->IsTracing())
+	{
+		g_theJobSystem->StopTrace();
+		return true;
+	}
+	g_theJobSystem->StartTrace(args.GetValue("seconds", 0.0f), args.GetValue("file", "JobTrace.json"));
+	return true;
+}
+
 Game::~Game()
 {
 	for (int index = 0; index < g_maxPlayers; index++)
@@ -33,6 +87,10 @@ Game::~Game()
 Game::Game()
 {
 	g_theEventSystem->SubscribeEventCallbackFunction( "test", Command_Test );
+	g_theEventSystem->SubscribeEventCallbackFunction( "parallelbench", Command_ParallelBenchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "jobidle", Command_JobIdle );
+	g_theEventSystem->SubscribeEventCallbackFunction( "jobtrace", Command_JobTrace );
+	g_theEventSystem->SubscribeEventCallbackFunction( "profile", Command_Profile );
 
 	// Load the test font for testing
 	g_testFont = g_theRenderer->CreateOrGetBitmapFont( "Data/Fonts/MyFixedFont" ); // DO NOT SPECIFY FILE EXTENSION!!  (Important later on.)
@@ -157,6 +215,7 @@ void Game::Startup()
 
 void Game::Update(float deltaSeconds)
 {
+	PROFILE_SCOPE("Game::Update");
 // 	float fontSize = 20.0f;
 // 	float vertical = g_gameConfigBlackboard.GetValue("SCREEN_CAMERA_HEIGHT", 800.0f);
 	Vec3 pos;
@@ -488,6 +547,7 @@ void Game::UpdateCameras(float deltaSeconds)
 
 void Game::Render() const
 {
+	PROFILE_SCOPE("Game::Render");
 //	float screenHeight = g_gameConfigBlackboard.GetValue("SCREEN_CAMERA_HEIGHT", 800.0f);
 	std::string str;
 	std::vector<Vertex_PCU> vertexArray;
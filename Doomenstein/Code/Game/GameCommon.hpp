@@ -7,6 +7,7 @@
 #include "Engine/InputSystem/InputSystem.hpp"
 #include "Engine/InputSystem/XboxController.hpp"
 #include "Engine/Audio/AudioSystem.hpp"
+#include "Engine/Core/JobSystem.hpp"
 #include "Engine/Renderer/Window.hpp"
 
 struct Vec2;
@@ -16,6 +17,7 @@ class BitmapFont;
 
 constexpr float GTIME = 15.0f;
 constexpr float HEAT_MAX = 9999.0f;
+constexpr int DISTANCE_FIELD_LINES_PER_BATCH = 8; // ParallelFor grain for the distance field sweeps
 constexpr float BOSS_MAX = 40.0f;
 constexpr float GRAVITY = 2.0f;
 constexpr float FRACTION = 0.15f;
@@ -29,6 +31,7 @@ void DebugDrawRing(Vec2 center, float radius, Rgba8 color, float width);
 // Anyone interested in these systems has scope to use global renderer
 extern InputSystem* g_theInput;
 extern AudioSystem* g_theAudio;
+extern JobSystem* g_theJobSystem;
 extern Renderer* g_theRenderer;
 extern Window* g_theWindow;
 extern BitmapFont* g_testFont;
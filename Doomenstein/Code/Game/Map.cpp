@@ -13,6 +13,7 @@
 #include "Player.hpp"
 #include "Game.hpp"
 #include "Game/AI.hpp"
+#include "Engine/Core/Profiler.hpp"
 
 bool indexedDraw = true;
 
@@ -237,6 +238,7 @@ Actor* Map::GetClosestVisibleEnemy(Actor const& actor) const
 
 void Map::Update(float deltaSeconds)
 {
+	PROFILE_SCOPE("Map::Update");
 	UpdatePlayers(deltaSeconds);
 	UpdateAI(deltaSeconds);
 	UpdateActors(deltaSeconds);
@@ -250,6 +252,7 @@ void Map::Update(float deltaSeconds)
 
 void Map::Render()
 {
+	PROFILE_SCOPE("Map::Render");
 	Texture* terrainTexture = g_theRenderer->CreateOrGetTextureFromFile((char const*)"Data/Images/Terrain_8x8.png");
 	g_theRenderer->BindTexture(terrainTexture);
 	g_theRenderer->SetModelMatrix(Mat44());
@@ -398,6 +401,7 @@ void Map::PushActorsOutOfEachOther(Actor* a, Actor* b)
 
 void Map::CollideActors()
 {
+	PROFILE_SCOPE("Map::CollideActors");
 	// actor vs actor
 	for (int a = 0; a < static_cast<int>(m_actors.size()); a++)
 	{
@@ -427,6 +431,7 @@ void Map::CollideActors(Actor* actorA, Actor* actorB)
 
 void Map::CollideActorsWithMap()
 {
+	PROFILE_SCOPE("Map::CollideActorsWithMap");
 	for (int index = 0; index < static_cast<int>(m_actors.size()); index++)
 	{
 		if (m_actors[index] && m_actors[index]->m_definition->m_collidesWithWorld)
@@ -1043,6 +1048,7 @@ Actor* Map::SpawnProjectile(const std::string& name)
 
 void Map::UpdateActors(float deltaSeconds)
 {
+	PROFILE_SCOPE("Map::UpdateActors");
 	for (int index = 0; index < static_cast<int>(m_actors.size()); index++)
 	{
 		if (m_actors[index])
@@ -1074,6 +1080,7 @@ void Map::UpdatePlayers(float deltaSeconds)
 
 void Map::UpdateAI(float deltaSeconds)
 {
+	PROFILE_SCOPE("Map::UpdateAI");
 	for (int index = 0; index < static_cast<int>(m_actors.size()); index++)
 	{
 		if (m_actors[index] && m_actors[index]->m_aiController)
@@ -1085,6 +1092,7 @@ void Map::UpdateAI(float deltaSeconds)
 
 void Map::UpdatePhysics(float deltaSeconds)
 {
+	PROFILE_SCOPE("Map::UpdatePhysics");
 	for (int index = 0; index < static_cast<int>(m_actors.size()); index++)
 	{
 		if (m_actors[index] && m_actors[index]->m_definition->m_simulated && !m_actors[index]->m_isDead)
@@ -1176,6 +1184,12 @@ void Map::CreateMaskMap(TileHeatMap& out_maskMap)
 // if there are no dead targets, then the heat map will be map cost
 void Map::PopulateDistanceFieldMask(TileHeatMap& out_distanceField, std::vector<Actor*> const& targets, float maxCost, TileHeatMap& maskHeatMap)
 {
+	PopulateDistanceFieldMask(out_distanceField, targets, maxCost, maskHeatMap, *g_theJobSystem);
+}
+
+void Map::PopulateDistanceFieldMask(TileHeatMap& out_distanceField, std::vector<Actor*> const& targets, float maxCost, TileHeatMap& maskHeatMap, JobSystem& jobSystem)
+{
+	PROFILE_SCOPE("Map::PopulateDistanceFieldMask");
 	TileHeatMap& heatMap = out_distanceField;
 	heatMap.SetAllValues(maxCost); // assumes all tiles can have this cost
 	for (Actor const* a : targets)
@@ -1185,42 +1199,54 @@ void Map::PopulateDistanceFieldMask(TileHeatMap& out_distanceField, std::vector<
 			heatMap.Set(0.0f, a->GetTileCoords()); // assumes this is start tile
 		}
 	}
-	bool changed = false; // flag to determine stopping condition
+	RelaxDistanceField(heatMap, maskHeatMap, jobSystem);
+}
+
+// relaxes rows (both directions) and then columns (both directions) until nothing changes
+// each row only reads and writes its own tiles during the row sweep and each column during the column sweep,
+// so the lines run in parallel, the fixed point is the same distance field the in-place sweep converged to
+void Map::RelaxDistanceField(TileHeatMap& heatMap, TileHeatMap const& maskHeatMap, JobSystem& jobSystem)
+{
+	// returns true if the tile was lowered from its neighbor
+	auto relax = [&](int x, int y, int neighborX, int neighborY)
+	{
+		if (maskHeatMap.Get(x, y) != 0.0f || heatMap.Get(x, y) <= heatMap.Get(neighborX, neighborY) + 1.0f)
+		{
+			return false;
+		}
+		heatMap.Set(heatMap.Get(neighborX, neighborY) + 1.0f, x, y);
+		return true;
+	};
+	auto either = [](bool a, bool b) { return a || b; };
 
+	bool changed = false; // flag to determine stopping condition
 	do
 	{
-		changed = false; // assume nothing changes until it does
-		for (int y = 1; y < m_dimensions.y - 1; y++)
+		bool rowsChanged = jobSystem.ParallelReduce(1, m_dimensions.y - 1, DISTANCE_FIELD_LINES_PER_BATCH, false, [&](int y, bool& lineChanged)
 		{
 			for (int x = 1; x < m_dimensions.x - 1; x++)
 			{
-				if (maskHeatMap.Get(x, y) != 0.0f)
-					continue;
-				if (heatMap.Get(x, y) > heatMap.Get(x + 1, y) + 1.0f)
-				{
-					heatMap.Set(heatMap.Get(x + 1, y) + 1.0f, x, y);
-					changed = true;
-				}
-
-				if (heatMap.Get(x, y) > heatMap.Get(x - 1, y) + 1.0f)
-				{
-					heatMap.Set(heatMap.Get(x - 1, y) + 1.0f, x, y);
-					changed = true;
-				}
-
-				if (heatMap.Get(x, y) > heatMap.Get(x, y + 1) + 1.0f)
-				{
-					heatMap.Set(heatMap.Get(x, y + 1) + 1.0f, x, y);
-					changed = true;
-				}
+				lineChanged = relax(x, y, x - 1, y) || lineChanged;
+			}
+			for (int x = m_dimensions.x - 2; x > 0; x--)
+			{
+				lineChanged = relax(x, y, x + 1, y) || lineChanged;
+			}
+		}, either);
 
-				if (heatMap.Get(x, y) > heatMap.Get(x, y - 1) + 1.0f)
-				{
-					heatMap.Set(heatMap.Get(x, y - 1) + 1.0f, x, y);
-					changed = true;
-				}
+		bool columnsChanged = jobSystem.ParallelReduce(1, m_dimensions.x - 1, DISTANCE_FIELD_LINES_PER_BATCH, false, [&](int x, bool& lineChanged)
+		{
+			for (int y = 1; y < m_dimensions.y - 1; y++)
+			{
+				lineChanged = relax(x, y, x, y - 1) || lineChanged;
 			}
-		}
+			for (int y = m_dimensions.y - 2; y > 0; y--)
+			{
+				lineChanged = relax(x, y, x, y + 1) || lineChanged;
+			}
+		}, either);
+
+		changed = rowsChanged || columnsChanged;
 	} while (changed);
 }
 
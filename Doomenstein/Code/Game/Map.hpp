@@ -63,6 +63,8 @@ public:
 
 	void CreateMaskMap(TileHeatMap& out_maskMap);
 	void PopulateDistanceFieldMask(TileHeatMap& out_distanceField, std::vector<Actor*> const& targets, float maxCost, TileHeatMap& maskHeatMap);
+	void PopulateDistanceFieldMask(TileHeatMap& out_distanceField, std::vector<Actor*> const& targets, float maxCost, TileHeatMap& maskHeatMap, JobSystem& jobSystem);
+	void RelaxDistanceField(TileHeatMap& heatMap, TileHeatMap const& maskHeatMap, JobSystem& jobSystem);
 	Player* GetPlayer();
 	Game* GetGame();
 
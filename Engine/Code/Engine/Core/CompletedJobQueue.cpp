@@ -0,0 +1,41 @@
+#include "Engine/Core/CompletedJobQueue.hpp"
+#include "Engine/Core/Job.hpp"
+
+// A Treiber stack where the consumer only ever detaches the whole stack. Producers publish with a
+// release compare-exchange on the head, the consumer swaps the head for null with acquire and
+// reverses the detached chain so jobs come out in the order they finished.
+
+//--------------------------------------------------------------------
+void CompletedJobQueue::Push(Job* job)
+{
+	Job* head = m_head.load(std::memory_order_relaxed);
+	do
+	{
+		job->m_nextCompleted = head;
+	} while (!m_head.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+}
+
+//--------------------------------------------------------------------
+Job* CompletedJobQueue::PopAll()
+{
+	if (m_head.load(std::memory_order_relaxed) == nullptr)
+	{
+		return nullptr;
+	}
+	Job* newest = m_head.exchange(nullptr, std::memory_order_acquire);
+	Job* oldest = nullptr;
+	while (newest)
+	{
+		Job* next = newest->m_nextCompleted;
+		newest->m_nextCompleted = oldest;
+		oldest = newest;
+		newest = next;
+	}
+	return oldest;
+}
+
+//--------------------------------------------------------------------
+bool CompletedJobQueue::IsEmpty() const
+{
+	return m_head.load(std::memory_order_relaxed) == nullptr;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <atomic>
+
+class Job;
+
+// unbounded lock-free multi-producer/single-consumer list of finished jobs, linked through the jobs themselves
+// workers push as they finish, the retiring thread takes everything in one exchange and never pops single nodes,
+// so there is no ABA problem and no node allocation
+class CompletedJobQueue
+{
+public:
+	CompletedJobQueue() = default;
+	CompletedJobQueue(const CompletedJobQueue& copy) = delete;
+
+	void Push(Job* job);
+	Job* PopAll(); // oldest first, follow Job::m_nextCompleted, only one thread may call this
+	bool IsEmpty() const;
+
+private:
+	std::atomic<Job*> m_head = nullptr; // newest first
+};
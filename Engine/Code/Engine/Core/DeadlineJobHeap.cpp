@@ -0,0 +1,104 @@
+#include "Engine/Core/DeadlineJobHeap.hpp"
+#include "Engine/Core/Job.hpp"
+#include "Engine/Core/JobPool.hpp"
+#include <cfloat>
+
+//--------------------------------------------------------------------
+void DeadlineJobHeap::Push(Job* job)
+{
+	PushBackCountingGrowth(m_jobs, job);
+	job->m_deadlineSlot = (int)m_jobs.size() - 1;
+	SiftUp(job->m_deadlineSlot);
+}
+
+//--------------------------------------------------------------------
+Job* DeadlineJobHeap::Pop()
+{
+	if (m_jobs.empty())
+	{
+		return nullptr;
+	}
+	Job* job = m_jobs[0];
+	Remove(job);
+	return job;
+}
+
+//--------------------------------------------------------------------
+// the last job fills the hole and moves whichever way its deadline needs
+void DeadlineJobHeap::Remove(Job* job)
+{
+	int slot = job->m_deadlineSlot;
+	Job* last = m_jobs.back();
+	m_jobs.pop_back();
+	job->m_deadlineSlot = -1;
+	if (last != job)
+	{
+		Place(slot, last);
+		SiftUp(slot);
+		SiftDown(last->m_deadlineSlot);
+	}
+}
+
+//--------------------------------------------------------------------
+void DeadlineJobHeap::Update(Job* job)
+{
+	SiftUp(job->m_deadlineSlot);
+	SiftDown(job->m_deadlineSlot);
+}
+
+//--------------------------------------------------------------------
+double DeadlineJobHeap::GetEarliestDeadline() const
+{
+	return m_jobs.empty() ? DBL_MAX : m_jobs[0]->m_deadline;
+}
+
+//--------------------------------------------------------------------
+bool DeadlineJobHeap::IsEmpty() const
+{
+	return m_jobs.empty();
+}
+
+//--------------------------------------------------------------------
+void DeadlineJobHeap::Place(int slot, Job* job)
+{
+	m_jobs[slot] = job;
+	job->m_deadlineSlot = slot;
+}
+
+//--------------------------------------------------------------------
+void DeadlineJobHeap::SiftUp(int slot)
+{
+	Job* job = m_jobs[slot];
+	while (slot > 0)
+	{
+		int parent = (slot - 1) / 2;
+		if (m_jobs[parent]->m_deadline <= job->m_deadline)
+		{
+			break;
+		}
+		Place(slot, m_jobs[parent]);
+		slot = parent;
+	}
+	Place(slot, job);
+}
+
+//--------------------------------------------------------------------
+void DeadlineJobHeap::SiftDown(int slot)
+{
+	Job* job = m_jobs[slot];
+	int count = (int)m_jobs.size();
+	for (int child = slot * 2 + 1; child < count; child = slot * 2 + 1)
+	{
+		if (child + 1 < count && m_jobs[child + 1]->m_deadline < m_jobs[child]->m_deadline)
+		{
+			child++;
+		}
+		if (job->m_deadline <= m_jobs[child]->m_deadline)
+		{
+			break;
+		}
+		Place(slot, m_jobs[child]);
+		slot = child;
+	}
+	Place(slot, job);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <mutex>
+#include <vector>
+
+class Job;
+
+// min-heap of queued jobs by deadline for one lane and job type, each job keeps its slot in Job::m_deadlineSlot so it can be
+// moved or removed without a search, the owner locks m_mutex around every call
+class DeadlineJobHeap
+{
+public:
+	DeadlineJobHeap() = default;
+	DeadlineJobHeap(const DeadlineJobHeap& copy) = delete;
+
+	void Push(Job* job);
+	Job* Pop();					// earliest deadline, null when empty
+	void Remove(Job* job);
+	void Update(Job* job);		// after the job's deadline changed
+	double GetEarliestDeadline() const; // DBL_MAX when empty
+	bool IsEmpty() const;
+
+	std::mutex m_mutex;
+
+private:
+	void Place(int slot, Job* job);
+	void SiftUp(int slot);
+	void SiftDown(int slot);
+
+	std::vector<Job*> m_jobs;
+};
@@ -1,13 +1,179 @@
 #include "Engine/Core/Job.hpp"
-#include "Engine/Core/Job.hpp"
 
-Job::~Job()
+//--------------------------------------------------------------------
+void JobCompletion::AddReference()
+{
+	m_references++;
+}
+
+//--------------------------------------------------------------------
+void JobCompletion::Release()
+{
+	if (--m_references == 0)
+	{
+		delete this;
+	}
+}
+
+//--------------------------------------------------------------------
+JobHandle::~JobHandle()
+{
+	if (m_completion)
+	{
+		m_completion->Release();
+	}
+}
+
+//--------------------------------------------------------------------
+JobHandle::JobHandle(JobCompletion* completion)
+	: m_completion(completion)
+{
+	if (m_completion)
+	{
+		m_completion->AddReference();
+	}
+}
+
+//--------------------------------------------------------------------
+JobHandle::JobHandle(JobHandle const& copy)
+	: JobHandle(copy.m_completion)
+{
+
+}
+
+//--------------------------------------------------------------------
+JobHandle& JobHandle::operator=(JobHandle const& copy)
+{
+	if (copy.m_completion)
+	{
+		copy.m_completion->AddReference(); // first, so assigning a handle to itself keeps the completion alive
+	}
+	if (m_completion)
+	{
+		m_completion->Release();
+	}
+	m_completion = copy.m_completion;
+	return *this;
+}
+
+//--------------------------------------------------------------------
+bool JobHandle::IsValid() const
+{
+	return m_completion != nullptr;
+}
+
+//--------------------------------------------------------------------
+bool JobHandle::IsComplete() const
+{
+	return m_completion == nullptr || m_completion->m_isComplete;
+}
+
+//--------------------------------------------------------------------
+void JobHandle::Wait() const
 {
+	if (m_completion == nullptr)
+	{
+		return;
+	}
+	std::unique_lock<std::mutex> lock(m_completion->m_mutex);
+	m_completion->m_condition.wait(lock, [this] { return m_completion->m_isComplete.load(); });
+}
 
+//--------------------------------------------------------------------
+Job::~Job()
+{
+	while (m_continuations) // only left when the job is deleted without running
+	{
+		JobContinuation* next = m_continuations->m_next;
+		delete m_continuations;
+		m_continuations = next;
+	}
+	if (m_completion)
+	{
+		m_completion->Release();
+	}
 }
 
+//--------------------------------------------------------------------
 Job::Job(int jobType)
 	: m_jobType(jobType)
 {
 
 }
+
+//--------------------------------------------------------------------
+void Job::AddPrerequisite(Job* prerequisite)
+{
+	if (prerequisite == nullptr || prerequisite == this)
+	{
+		return;
+	}
+	prerequisite->m_dependencyMutex.lock();
+	if (!prerequisite->m_isFinished)
+	{
+		m_unfinishedDependencies++;
+		JobContinuation* continuation = new JobContinuation();
+		continuation->m_job = this;
+		if (prerequisite->m_lastContinuation)
+		{
+			prerequisite->m_lastContinuation->m_next = continuation;
+		}
+		else
+		{
+			prerequisite->m_continuations = continuation;
+		}
+		prerequisite->m_lastContinuation = continuation;
+	}
+	prerequisite->m_dependencyMutex.unlock();
+}
+
+//--------------------------------------------------------------------
+void Job::AddContinuation(Job* continuation)
+{
+	if (continuation)
+	{
+		continuation->AddPrerequisite(this);
+	}
+}
+
+//--------------------------------------------------------------------
+JobHandle Job::GetHandle()
+{
+	m_dependencyMutex.lock();
+	if (m_completion == nullptr)
+	{
+		m_completion = new JobCompletion();
+		m_completion->m_isComplete = m_isFinished;
+	}
+	JobHandle handle(m_completion);
+	m_dependencyMutex.unlock();
+	return handle;
+}
+
+//--------------------------------------------------------------------
+bool Job::ReleaseDependency()
+{
+	return --m_unfinishedDependencies == 0;
+}
+
+//--------------------------------------------------------------------
+// called by the worker right after Execute, before the job is published to the completed list
+JobContinuation* Job::FinishExecution()
+{
+	m_dependencyMutex.lock();
+	m_isFinished = true;
+	JobContinuation* continuations = m_continuations;
+	m_continuations = nullptr;
+	m_lastContinuation = nullptr;
+	JobCompletion* completion = m_completion; // the job's reference keeps it alive, the job is not deleted before this returns
+	m_dependencyMutex.unlock();
+
+	if (completion)
+	{
+		completion->m_mutex.lock();
+		completion->m_isComplete = true;
+		completion->m_mutex.unlock();
+		completion->m_condition.notify_all();
+	}
+	return continuations;
+}
@@ -1,8 +1,15 @@
 #pragma once
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include "Engine/Core/JobPool.hpp"
 
 enum class JobState
 {
 	UNKNOWN,
+	WAITING,	// submitted but still waiting on prerequisite jobs
 	QUEUED,
 	PROCESSING,
 	COMPLETE,
@@ -10,16 +17,94 @@ enum class JobState
 	RETIRED,
 };
 
+// lanes are served most urgent first, inside a lane jobs with a deadline go ahead of jobs without one
+enum class JobPriority
+{
+	CRITICAL,	// someone is blocked waiting on the result
+	HIGH,
+	NORMAL,
+	LOW,
+	COUNT
+};
+
+// shared by a job and its handles so a handle stays valid after the job is retired and deleted, pooled so taking a handle
+// does not touch the heap
+struct JobCompletion : public Pooled<JobCompletion>
+{
+	std::atomic<bool> m_isComplete = false;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::atomic<int> m_references = 1; // the job's, each handle adds one
+
+	void AddReference();
+	void Release();
+};
+
+class Job;
+
+// one job waiting on a prerequisite, pooled so declaring dependencies does not touch the heap
+struct JobContinuation : public Pooled<JobContinuation>
+{
+	Job* m_job = nullptr;
+	JobContinuation* m_next = nullptr;
+};
+
+class JobHandle
+{
+public:
+	~JobHandle();
+	JobHandle() = default;
+	explicit JobHandle(JobCompletion* completion);
+	JobHandle(JobHandle const& copy);
+	JobHandle& operator=(JobHandle const& copy);
+
+	bool IsValid() const;
+	bool IsComplete() const; // poll, an invalid handle counts as complete
+	void Wait() const;		// block the calling thread until the job has executed
+
+private:
+	JobCompletion* m_completion = nullptr;
+};
+
 class Job
 {
 public:
 	friend class JobWorkerThread;
+	friend class JobSystem;
+	friend class CompletedJobQueue;
+	friend class DeadlineJobHeap;
 	virtual ~Job();
 	Job(int jobType);
 //private:
 	virtual void Execute() = 0; // entry point to do the work of generating the chunk
 
 public:
-	JobState m_state = JobState::UNKNOWN;
+	// dependencies must be declared before this job is passed to QueueJob
+	void AddPrerequisite(Job* prerequisite);
+	void AddContinuation(Job* continuation); // continuation still goes through QueueJob but only runs once this job finishes
+	JobHandle GetHandle();
+
+private:
+	bool ReleaseDependency();				// true when the last outstanding dependency is gone
+	JobContinuation* FinishExecution(); // hands back the continuation list, the caller releases each one and frees the nodes
+
+public:
+	std::atomic<JobState> m_state = JobState::UNKNOWN;
 	int m_jobType;
+	bool m_deleteWhenComplete = false; // engine owned jobs are freed by the worker instead of going to the completed list
+	// set before QueueJob, afterwards only JobSystem::Reprioritize may change them
+	JobPriority m_priority = JobPriority::NORMAL;
+	double m_deadline = 0.0;		// GetCurrentTimeSeconds() the result is needed by, 0 for none
+	double m_readyTime = 0.0;		// when the job became runnable, for the queue wait histograms
+
+private:
+	// starts at one for the submission itself so a job never runs before QueueJob has been called
+	std::atomic<int> m_unfinishedDependencies = 1;
+	std::mutex m_dependencyMutex;
+	bool m_isFinished = false;
+	JobContinuation* m_continuations = nullptr;		// in the order they were added
+	JobContinuation* m_lastContinuation = nullptr;
+	JobCompletion* m_completion = nullptr; // created by the first GetHandle, the job holds one reference
+	Job* m_nextCompleted = nullptr; // link in the completed queue, owned by CompletedJobQueue
+	int m_deadlineSlot = -1;		// index in its DeadlineJobHeap while queued with a deadline, owned by DeadlineJobHeap
 };
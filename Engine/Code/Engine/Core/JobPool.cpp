@@ -0,0 +1,118 @@
+#include "Engine/Core/JobPool.hpp"
+#include <cstdint>
+
+std::atomic<JobPool*> JobPool::s_firstPool = nullptr;
+std::atomic<int> JobPool::s_unpooledHeapAllocations = 0;
+
+// Each slab is one heap block aligned by hand: a header holding the link to the previous slab and the
+// block to free, padded to OBJECT_ALIGNMENT, followed by OBJECTS_PER_SLAB objects. Objects are pushed on the free list when
+// the slab is added and never handed back to the heap until the pool itself is destroyed.
+
+//--------------------------------------------------------------------
+JobPool::~JobPool()
+{
+	while (m_slabs)
+	{
+		void** header = static_cast<void**>(m_slabs);
+		m_slabs = header[0];
+		::operator delete(header[1]);
+	}
+	m_freeList = nullptr;
+}
+
+//--------------------------------------------------------------------
+JobPool::JobPool(size_t objectSize, char const* name)
+	: m_name(name)
+{
+	// room for the free list link and a whole number of cache lines
+	objectSize = objectSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : objectSize;
+	m_objectSize = (objectSize + OBJECT_ALIGNMENT - 1) & ~(OBJECT_ALIGNMENT - 1);
+
+	JobPool* first = s_firstPool.load();
+	do
+	{
+		m_nextPool = first;
+	} while (!s_firstPool.compare_exchange_weak(first, this));
+}
+
+//--------------------------------------------------------------------
+void* JobPool::Allocate()
+{
+	m_mutex.lock();
+	if (m_freeList == nullptr)
+	{
+		AddSlab();
+	}
+	FreeBlock* block = m_freeList;
+	m_freeList = block->m_next;
+	m_mutex.unlock();
+	m_liveCount++;
+	return block;
+}
+
+//--------------------------------------------------------------------
+void JobPool::Free(void* object)
+{
+	FreeBlock* block = static_cast<FreeBlock*>(object);
+	m_mutex.lock();
+	block->m_next = m_freeList;
+	m_freeList = block;
+	m_mutex.unlock();
+	m_liveCount--;
+}
+
+//--------------------------------------------------------------------
+void* JobPool::AllocateFromHeap(size_t size)
+{
+	m_heapAllocations++;
+	return ::operator new(size);
+}
+
+//--------------------------------------------------------------------
+void JobPool::Reserve(int count)
+{
+	m_mutex.lock();
+	while (m_capacity - m_liveCount < count)
+	{
+		AddSlab();
+	}
+	m_mutex.unlock();
+}
+
+//--------------------------------------------------------------------
+// caller holds m_mutex
+void JobPool::AddSlab()
+{
+	void* block = ::operator new(OBJECT_ALIGNMENT * 2 + m_objectSize * OBJECTS_PER_SLAB);
+	char* slab = reinterpret_cast<char*>(((uintptr_t)block + OBJECT_ALIGNMENT - 1) & ~(uintptr_t)(OBJECT_ALIGNMENT - 1));
+	void** header = reinterpret_cast<void**>(slab);
+	header[0] = m_slabs;
+	header[1] = block;
+	m_slabs = slab;
+	char* objects = slab + OBJECT_ALIGNMENT;
+	for (int index = OBJECTS_PER_SLAB - 1; index >= 0; index--)
+	{
+		FreeBlock* block = reinterpret_cast<FreeBlock*>(objects + index * m_objectSize);
+		block->m_next = m_freeList;
+		m_freeList = block;
+	}
+	m_capacity += OBJECTS_PER_SLAB;
+	m_heapAllocations++;
+}
+
+//--------------------------------------------------------------------
+void JobPool::CountHeapAllocation()
+{
+	s_unpooledHeapAllocations++;
+}
+
+//--------------------------------------------------------------------
+int JobPool::GetTotalHeapAllocations()
+{
+	int total = s_unpooledHeapAllocations;
+	for (JobPool* pool = s_firstPool; pool; pool = pool->m_nextPool)
+	{
+		total += pool->m_heapAllocations;
+	}
+	return total;
+}
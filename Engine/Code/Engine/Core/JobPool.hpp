@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <typeinfo>
+#include <vector>
+
+// free list of fixed size blocks for one job class, carved from slabs that are only returned to the heap at exit
+// after the first few frames every new/delete of a pooled job is a pop/push under an uncontended lock
+class JobPool
+{
+public:
+	~JobPool();
+	JobPool(size_t objectSize, char const* name);
+	JobPool(const JobPool& copy) = delete;
+
+	void* Allocate();
+	void Free(void* object);
+	void* AllocateFromHeap(size_t size); // for classes derived from a pooled one, counted as heap traffic
+	void Reserve(int count); // warm up so the first frames do not grow the pool either
+
+	size_t GetObjectSize() const { return m_objectSize; }
+	char const* GetName() const { return m_name; }
+	int GetLiveCount() const { return m_liveCount; }
+	int GetCapacity() const { return m_capacity; }
+	int GetHeapAllocations() const { return m_heapAllocations; }
+
+	static JobPool* GetFirstPool() { return s_firstPool; }
+	JobPool* GetNextPool() const { return m_nextPool; }
+	static int GetTotalHeapAllocations(); // slab allocations over every pool plus the counted ones outside them, since startup
+	static void CountHeapAllocation(); // for job system containers and buffers that go to the heap outside the pools
+	static int GetUnpooledHeapAllocations() { return s_unpooledHeapAllocations; }
+
+	static constexpr int OBJECTS_PER_SLAB = 64;
+	static constexpr size_t OBJECT_ALIGNMENT = 64; // a cache line per job, neighbors run on different workers
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* m_next;
+	};
+
+	void AddSlab();
+
+	size_t m_objectSize = 0;
+	char const* m_name = nullptr;
+	std::mutex m_mutex;
+	FreeBlock* m_freeList = nullptr;
+	void* m_slabs = nullptr;		// each slab starts with the link to the previous one, then the heap block to free
+	std::atomic<int> m_liveCount = 0;
+	std::atomic<int> m_capacity = 0;
+	std::atomic<int> m_heapAllocations = 0;
+
+	JobPool* m_nextPool = nullptr;
+	static std::atomic<JobPool*> s_firstPool; // every pool registers itself for the jobpool report
+	static std::atomic<int> s_unpooledHeapAllocations;
+};
+
+// push_back for the job system's own vectors, the growth is counted with the pools' heap allocations
+template <typename T>
+void PushBackCountingGrowth(std::vector<T>& vector, T const& value)
+{
+	if (vector.size() == vector.capacity())
+	{
+		JobPool::CountHeapAllocation();
+	}
+	vector.push_back(value);
+}
+
+// inherit alongside Job to route new/delete of the class through its own pool: class MyJob : public Job, public Pooled<MyJob>
+// a class derived from a pooled one has a different size and falls back to the heap (and is counted as heap traffic)
+template <typename T>
+class Pooled
+{
+public:
+	static void* operator new(size_t size)
+	{
+		if (size != sizeof(T))
+		{
+			return GetPool().AllocateFromHeap(size);
+		}
+		return GetPool().Allocate();
+	}
+
+	static void operator delete(void* object, size_t size)
+	{
+		if (object == nullptr)
+		{
+			return;
+		}
+		if (size != sizeof(T))
+		{
+			::operator delete(object);
+			return;
+		}
+		GetPool().Free(object);
+	}
+
+	static JobPool& GetPool()
+	{
+		static JobPool s_pool(sizeof(T), typeid(T).name());
+		return s_pool;
+	}
+};
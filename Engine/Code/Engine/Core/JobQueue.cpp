@@ -0,0 +1,113 @@
+#include "Engine/Core/JobQueue.hpp"
+#include "Engine/Core/Job.hpp"
+#include <stdint.h>
+
+// Based on Dmitry Vyukov's bounded MPMC queue: every cell carries a sequence number that tells
+// producers and consumers whether the cell is free for the current lap of the ring, so a push or
+// pop is a single compare-exchange on the matching cursor followed by a release store on the cell.
+
+//--------------------------------------------------------------------
+JobQueue::~JobQueue()
+{
+	delete[] m_cells;
+	m_cells = nullptr;
+}
+
+//--------------------------------------------------------------------
+JobQueue::JobQueue(int capacity)
+{
+	// round capacity up to a power of two so the ring index is a mask
+	size_t size = 2;
+	while (size < (size_t)capacity)
+	{
+		size <<= 1;
+	}
+	m_mask = size - 1;
+	m_cells = new Cell[size];
+	for (size_t index = 0; index < size; index++)
+	{
+		m_cells[index].m_sequence.store(index, std::memory_order_relaxed);
+	}
+}
+
+//--------------------------------------------------------------------
+bool JobQueue::Push(Job* job)
+{
+	Cell* cell = nullptr;
+	size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		cell = &m_cells[position & m_mask];
+		size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+		if (difference == 0)
+		{
+			if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			return false; // full
+		}
+		else
+		{
+			position = m_enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+	cell->m_job = job;
+	cell->m_sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+//--------------------------------------------------------------------
+Job* JobQueue::Pop()
+{
+	Cell* cell = nullptr;
+	size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		cell = &m_cells[position & m_mask];
+		size_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+		if (difference == 0)
+		{
+			if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			return nullptr; // empty
+		}
+		else
+		{
+			position = m_dequeuePosition.load(std::memory_order_relaxed);
+		}
+	}
+	Job* job = cell->m_job;
+	cell->m_sequence.store(position + m_mask + 1, std::memory_order_release);
+	return job;
+}
+
+//--------------------------------------------------------------------
+int JobQueue::GetApproximateCount() const
+{
+	size_t enqueued = m_enqueuePosition.load(std::memory_order_relaxed);
+	size_t dequeued = m_dequeuePosition.load(std::memory_order_relaxed);
+	return enqueued > dequeued ? (int)(enqueued - dequeued) : 0;
+}
+
+//--------------------------------------------------------------------
+bool JobQueue::IsEmpty() const
+{
+	return GetApproximateCount() == 0;
+}
+
+//--------------------------------------------------------------------
+int JobQueue::GetCapacity() const
+{
+	return (int)(m_mask + 1);
+}
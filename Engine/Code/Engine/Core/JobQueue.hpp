@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+
+class Job;
+
+// bounded lock-free multi-producer/multi-consumer ring of jobs (one per worker thread)
+// any thread may push (the main thread queues jobs, workers may spawn them) and any thread may pop,
+// which is what lets idle workers steal from a busy worker's queue without taking a lock
+class JobQueue
+{
+public:
+	~JobQueue();
+	explicit JobQueue(int capacity);
+	JobQueue(const JobQueue& copy) = delete;
+
+	bool Push(Job* job); // returns false if the ring is full
+	Job* Pop();
+	int GetApproximateCount() const;
+	bool IsEmpty() const;
+	int GetCapacity() const;
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> m_sequence;
+		Job* m_job = nullptr;
+	};
+
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+
+	Cell* m_cells = nullptr;
+	size_t m_mask = 0;
+	// keep producer and consumer cursors on separate cache lines to avoid false sharing
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_enqueuePosition = 0;
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_dequeuePosition = 0;
+};
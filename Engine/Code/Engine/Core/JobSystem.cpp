@@ -1,4 +1,8 @@
 #include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include <cfloat>
 // #include "Game/ChunkGenerateJob.hpp"
 // #include "Game/TestJob.hpp"
 // #include "Game/Chunk.hpp"
@@ -14,6 +18,79 @@
 // 	// generate the chunk data
 // }
 
+// the job system whose worker runs on this thread, null on every other thread
+static thread_local JobSystem const* t_workerJobSystem = nullptr;
+
+//--------------------------------------------------------------------
+// the heap a deadline job waits in, job types queued with a deadline are single bits
+static int GetDeadlineTypeBit(int jobType)
+{
+	int bit = 0;
+	while (bit < 31 && (jobType & (1 << bit)) == 0)
+	{
+		bit++;
+	}
+	return bit;
+}
+
+// shared by a ParallelFor caller and its helper jobs, helpers can start after the caller has returned so they co-own it
+struct ParallelBatchState : public Pooled<ParallelBatchState>
+{
+	ParallelBatchFunction m_function = nullptr;
+	void* m_context = nullptr;
+	int m_batchCount = 0;
+	std::atomic<int> m_nextBatch = 0;
+	std::atomic<int> m_completedBatches = 0;
+	std::atomic<int> m_references = 1; // the caller's, each helper adds one
+
+	void RunBatches()
+	{
+		int completed = 0;
+		for (int batchIndex = m_nextBatch++; batchIndex < m_batchCount; batchIndex = m_nextBatch++)
+		{
+			m_function(m_context, batchIndex);
+			completed++;
+		}
+		if (completed)
+		{
+			m_completedBatches += completed;
+		}
+	}
+
+	void Release()
+	{
+		if (--m_references == 0)
+		{
+			delete this;
+		}
+	}
+};
+
+// claims batches until none are left, one helper per worker at most so the per-batch cost is a single atomic add
+class ParallelBatchJob : public Job, public Pooled<ParallelBatchJob>
+{
+public:
+	ParallelBatchJob(ParallelBatchState* state)
+		: Job(JOB_TYPE_PARALLEL_FOR), m_batchState(state)
+	{
+		m_batchState->m_references++;
+		m_deleteWhenComplete = true;
+		m_priority = JobPriority::CRITICAL; // the caller is blocked until its batches are done
+	}
+
+	virtual ~ParallelBatchJob()
+	{
+		m_batchState->Release();
+	}
+
+	virtual void Execute() override
+	{
+		m_batchState->RunBatches();
+	}
+
+	ParallelBatchState* m_batchState = nullptr;
+};
+
 //--------------------------------------------------------------------
 JobSystem::~JobSystem()
 {
@@ -25,6 +102,11 @@ JobSystem::~JobSystem()
 		}
 	}
 	m_threads.clear();
+	for (int index = 0; index < (int)m_traceBuffers.size(); index++)
+	{
+		delete m_traceBuffers[index];
+	}
+	m_traceBuffers.clear();
 }
 
 //--------------------------------------------------------------------
@@ -32,35 +114,66 @@ JobSystem::JobSystem(JobSystemConfig& config)
 	: m_config(config)
 {
 	m_workerThreads = config.m_workerThreads;
+	SetJobTypeName(JOB_TYPE_PARALLEL_FOR, "parallel for");
 }
 
 //--------------------------------------------------------------------
 void JobSystem::Startup()
 {
-	int cores = std::thread::hardware_concurrency();
-	m_workerThreads = m_workerThreads > cores ? cores : m_workerThreads;
+	if (m_config.m_limitToHardwareThreads)
+	{
+		int cores = std::thread::hardware_concurrency();
+		m_workerThreads = m_workerThreads > cores ? cores : m_workerThreads;
+	}
 
 	for (int i = 0; i < m_workerThreads; i++)
 	{
-//		JobWorkerThread* thread = new JobWorkerThread(i, this, i ? JobType::JOB_CREATE : (JobType::JOB_LOAD | JobType::JOB_SAVE));
-		JobWorkerThread* thread = new JobWorkerThread(i, this, i ? 1 : (2 | 4));
+		int jobTypes = i < (int)m_config.m_workerJobTypes.size() ? m_config.m_workerJobTypes[i] : m_config.m_defaultWorkerJobTypes;
+		JobWorkerThread* thread = new JobWorkerThread(i, this, jobTypes | JOB_TYPE_PARALLEL_FOR, m_config.m_jobQueueCapacity);
 		m_threads.push_back(thread);
 	}
+	m_idleStatsStartTime = GetCurrentTimeSeconds();
+	// start the threads only when the worker list is complete since workers steal from each other
+	for (int index = 0; index < (int)m_threads.size(); index++)
+	{
+		m_threads[index]->Start();
+	}
 }
 
 //--------------------------------------------------------------------
 void JobSystem::Shutdown()
 {
-	// this is not guaranteed to catch all jobs
-	while(m_jobsQueue.size() || m_jobsExecuting.size())
+	// jobs of a type no worker accepts would never drain, so this thread runs those itself
+	int acceptedJobTypes = 0;
+	for (int index = 0; index < (int)m_threads.size(); index++)
 	{
-		std::this_thread::sleep_for(std::chrono::microseconds(100));
+		acceptedJobTypes |= m_threads[index]->m_jobType;
 	}
+	int orphanJobTypes = ~acceptedJobTypes;
 
+	// this thread also empties the overflow, whatever its type, so it only sleeps while the workers hold every job left
+	// and wakes when they finish or a job lands in the overflow
+	// a job still waiting on a prerequisite that was never queued can not finish, and would hang the drain
+	m_isDraining = true;
+	std::unique_lock<std::mutex> lock(m_drainMutex);
+	while (m_jobsInFlight > 0)
+	{
+		lock.unlock();
+		for (Job* job = RetrieveDrainJob(orphanJobTypes); job; job = RetrieveDrainJob(orphanJobTypes))
+		{
+			ExecuteJob(job);
+		}
+		lock.lock();
+		m_drainCondition.wait(lock, [this]() { return m_jobsInFlight == 0 || m_jobsQueueCount > 0; });
+	}
+	lock.unlock();
+
+	// nothing is left to run, so every worker is spinning or parked and quits as soon as it sees the flag
 	for (int index = 0; index < (int)m_threads.size(); index++)
 	{
 		JobWorkerThread* thread = m_threads[index];
 		thread->m_isQuitting = true;
+		thread->Wake();
 	}
 	// join all threads before stopping
 	for (int index = 0; index < (int)m_threads.size(); index++)
@@ -73,56 +186,331 @@ void JobSystem::Shutdown()
 		delete m_threads[index];
 	}
 	m_threads.clear();
+	m_isDraining = false;
+	if (m_isTracing)
+	{
+		StopTrace();
+	}
 }
 
 //--------------------------------------------------------------------
 void JobSystem::BeginFrame()
 {
-
+	if (m_isTracing && m_traceStopTime > 0.0 && GetCurrentTimeSeconds() >= m_traceStopTime)
+	{
+		StopTrace();
+	}
 }
 
 //--------------------------------------------------------------------
+// once the pools and containers have warmed up a frame of queueing and retiring pooled jobs should not touch the heap at
+// all: jobs, handles, continuations and ParallelFor state come from pools, and the overflow, deadline heaps and completed
+// list count every time they outgrow their capacity, as does a ParallelReduce too wide for its inline partials
 void JobSystem::EndFrame()
 {
-
+	int heapAllocations = JobPool::GetTotalHeapAllocations();
+	m_frameHeapAllocations = heapAllocations - m_lastHeapAllocations;
+	m_lastHeapAllocations = heapAllocations;
+	m_framesWithoutHeapAllocation = m_frameHeapAllocations == 0 ? m_framesWithoutHeapAllocation + 1 : 0;
 }
 
 //--------------------------------------------------------------------
 void JobSystem::QueueJob(Job* job)
 {
-	m_jobsQueueMutex.lock();
+	job->m_state = JobState::WAITING;
+	m_jobsQueuedTotal++;
+	m_jobsInFlight++;
+	if (job->ReleaseDependency())
+	{
+		ScheduleJob(job);
+	}
+}
+
+//--------------------------------------------------------------------
+// route the job to a worker whose type mask accepts it, round robin so the rings fill evenly
+void JobSystem::ScheduleJob(Job* job)
+{
 	job->m_state = JobState::QUEUED;
-	m_jobsQueue.push_back(job);
+	job->m_readyTime = GetCurrentTimeSeconds();
+	int lane = (int)job->m_priority;
+
+	if (job->m_deadline > 0.0)
+	{
+		PushDeadlineJob(job);
+		WakeWorkerFor(job, nullptr);
+		return;
+	}
+
+	int workerCount = (int)m_threads.size();
+	unsigned int first = m_nextWorker++;
+	for (int count = 0; count < workerCount; count++)
+	{
+		JobWorkerThread* worker = m_threads[(first + count) % workerCount];
+		if ((worker->m_jobType & job->m_jobType) && worker->m_jobs[lane]->Push(job))
+		{
+			WakeWorkerFor(job, worker);
+			return;
+		}
+	}
+
+	// no worker takes this type (or every matching ring is full) so park it in the shared overflow
+	m_jobsQueueMutex.lock();
+	PushBackCountingGrowth(m_jobsQueue, job);
+	m_jobsQueueCount++;
 	m_jobsQueueMutex.unlock();
+	WakeWorkerFor(job, nullptr);
+	if (m_isDraining)
+	{
+		// Shutdown runs what lands in the overflow, it sleeps until the overflow has something for it
+		m_drainMutex.lock();
+		m_drainMutex.unlock();
+		m_drainCondition.notify_all();
+	}
+}
+
+//--------------------------------------------------------------------
+// prefer the ring's owner, otherwise any parked worker that can take the job (for a ring, one allowed to steal from it)
+void JobSystem::WakeWorkerFor(Job* job, JobWorkerThread* owner)
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in JobWorkerThread::Park
+	if (m_parkedWorkerCount == 0)
+	{
+		return;
+	}
+	if (owner && owner->Wake())
+	{
+		return;
+	}
+	int workerCount = (int)m_threads.size();
+	unsigned int first = m_nextWorker++;
+	for (int count = 0; count < workerCount; count++)
+	{
+		JobWorkerThread* worker = m_threads[(first + count) % workerCount];
+		bool canRun = owner ? (owner->m_jobType & ~worker->m_jobType) == 0 : (worker->m_jobType & job->m_jobType) != 0;
+		if (canRun && worker->Wake())
+		{
+			return;
+		}
+	}
 }
 
 //--------------------------------------------------------------------
-Job* JobSystem::RetrieveJobToExecute(int jobTypes)
+// workerID is the calling worker (-1 from any other thread), lanes are checked most urgent first
+// and within a lane deadline jobs, then its own queue, then other workers' queues
+Job* JobSystem::RetrieveJobToExecute(int jobTypes, int workerID)
 {
 	Job *job = nullptr; // default to no job available
-	// safely remove job from queue
+	bool isWorker = workerID >= 0 && workerID < (int)m_threads.size();
+	for (int lane = 0; lane < (int)JobPriority::COUNT && job == nullptr; lane++)
+	{
+		if (m_deadlineJobBits[lane] & (unsigned int)jobTypes)
+		{
+			job = RetrieveDeadlineJob(jobTypes, lane);
+		}
+		if (job == nullptr && isWorker)
+		{
+			job = m_threads[workerID]->m_jobs[lane]->Pop();
+		}
+		if (job == nullptr)
+		{
+			job = StealJob(jobTypes, workerID, lane);
+		}
+	}
+	if (job == nullptr && m_jobsQueueCount > 0)
+	{
+		job = RetrieveOverflowJob(jobTypes);
+	}
+
+	if (job)
+	{
+		MarkRetrieved(job);
+	}
+
+	return job;
+}
+
+//--------------------------------------------------------------------
+// Shutdown takes the jobs of types no worker takes, then anything in the overflow whatever its type
+Job* JobSystem::RetrieveDrainJob(int orphanJobTypes)
+{
+	Job* job = RetrieveJobToExecute(orphanJobTypes);
+	if (job == nullptr && m_jobsQueueCount > 0)
+	{
+		job = RetrieveOverflowJob(~0);
+		if (job)
+		{
+			MarkRetrieved(job);
+		}
+	}
+	return job;
+}
+
+//--------------------------------------------------------------------
+void JobSystem::MarkRetrieved(Job* job)
+{
+	RecordQueueWait(job);
+	job->m_state = JobState::PROCESSING;
+	m_jobsQueuedTotal--;
+}
+
+//--------------------------------------------------------------------
+void JobSystem::PushDeadlineJob(Job* job)
+{
+	int lane = (int)job->m_priority;
+	int bit = GetDeadlineTypeBit(job->m_jobType);
+	DeadlineJobHeap& heap = m_deadlineJobs[lane][bit];
+	heap.m_mutex.lock();
+	heap.Push(job);
+	m_deadlineJobBits[lane] |= 1u << bit;
+	heap.m_mutex.unlock();
+}
+
+//--------------------------------------------------------------------
+// earliest deadline first among the heaps of this lane that the caller accepts, a heap's bit only clears under its lock
+Job* JobSystem::RetrieveDeadlineJob(int jobTypes, int lane)
+{
+	unsigned int bits = m_deadlineJobBits[lane] & (unsigned int)jobTypes;
+	int bestBit = -1;
+	double bestDeadline = DBL_MAX;
+	for (int bit = 0; bits != 0; bit++, bits >>= 1)
+	{
+		if ((bits & 1) == 0)
+		{
+			continue;
+		}
+		if (bits == 1 && bestBit < 0)
+		{
+			bestBit = bit; // the only candidate, no need to peek
+			break;
+		}
+		DeadlineJobHeap& heap = m_deadlineJobs[lane][bit];
+		heap.m_mutex.lock();
+		double deadline = heap.GetEarliestDeadline();
+		heap.m_mutex.unlock();
+		if (deadline < bestDeadline)
+		{
+			bestBit = bit;
+			bestDeadline = deadline;
+		}
+	}
+	if (bestBit < 0)
+	{
+		return nullptr;
+	}
+
+	DeadlineJobHeap& heap = m_deadlineJobs[lane][bestBit];
+	heap.m_mutex.lock();
+	Job* job = heap.Pop();
+	if (heap.IsEmpty())
+	{
+		m_deadlineJobBits[lane] &= ~(1u << bestBit);
+	}
+	heap.m_mutex.unlock();
+	return job;
+}
+
+//--------------------------------------------------------------------
+// only steal from workers whose type mask is a subset of ours, so whatever we pop we are allowed to run
+Job* JobSystem::StealJob(int jobTypes, int thiefID, int lane)
+{
+	int workerCount = (int)m_threads.size();
+	for (int count = 1; count <= workerCount; count++)
+	{
+		int victimID = (thiefID + count) % workerCount;
+		if (victimID < 0 || victimID == thiefID)
+		{
+			continue;
+		}
+		JobWorkerThread* victim = m_threads[victimID];
+		if ((victim->m_jobType & ~jobTypes) != 0 || victim->m_jobs[lane]->IsEmpty())
+		{
+			continue;
+		}
+		Job* job = victim->m_jobs[lane]->Pop();
+		if (job)
+		{
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+//--------------------------------------------------------------------
+// the overflow is rarely used so a scan for the most urgent eligible job and an erase from the middle are fine
+Job* JobSystem::RetrieveOverflowJob(int jobTypes)
+{
+	Job* job = nullptr;
 	m_jobsQueueMutex.lock();
+	auto best = m_jobsQueue.end();
 	for (auto index = m_jobsQueue.begin(); index < m_jobsQueue.end(); index++)
 	{
 		// use bit mask for jobs to return
-		if ((*index)->m_jobType & jobTypes)
+		if (((*index)->m_jobType & jobTypes) && (best == m_jobsQueue.end() || (*index)->m_priority < (*best)->m_priority))
 		{
-			job = *index;
-			m_jobsQueue.erase(index);
-			break;
+			best = index;
 		}
 	}
+	if (best != m_jobsQueue.end())
+	{
+		job = *best;
+		m_jobsQueue.erase(best);
+		m_jobsQueueCount--;
+	}
 	m_jobsQueueMutex.unlock();
+	return job;
+}
 
-	if (job)
+//--------------------------------------------------------------------
+void JobSystem::RecordQueueWait(Job* job)
+{
+	double waitMicroseconds = (GetCurrentTimeSeconds() - job->m_readyTime) * 1000000.0;
+	int bucket = 0;
+	while (bucket < JOB_WAIT_HISTOGRAM_BUCKETS - 1 && waitMicroseconds >= (double)(1 << bucket))
 	{
-		m_jobsExecutingMutex.lock();
-		job->m_state = JobState::PROCESSING;
-		m_jobsExecuting.push_back(job);
-		m_jobsExecutingMutex.unlock();
+		bucket++;
 	}
+	m_queueWaitHistogram[(int)job->m_priority][bucket]++;
+}
 
-	return job;
+//--------------------------------------------------------------------
+void JobSystem::ExecuteJob(Job* job, int workerID)
+{
+	if (m_isTracing.load(std::memory_order_acquire)) // pairs with StartTrace, the rings it allocated are visible
+	{
+		double beginTime = GetCurrentTimeSeconds();
+		job->Execute();
+		RecordJobTrace(job, workerID, beginTime, GetCurrentTimeSeconds()); // before completion, the job may be freed after
+	}
+	else
+	{
+		job->Execute();
+	}
+	MoveToCompletedList(job);
+}
+
+//--------------------------------------------------------------------
+void JobSystem::RecordJobTrace(Job* job, int workerID, double beginTime, double endTime)
+{
+	if (m_traceBuffers.empty())
+	{
+		return;
+	}
+	JobTraceEvent event;
+	event.m_beginTime = beginTime;
+	event.m_endTime = endTime;
+	event.m_readyTime = job->m_readyTime;
+	event.m_jobType = job->m_jobType;
+	event.m_priority = (int)job->m_priority;
+	if (workerID >= 0 && workerID < (int)m_traceBuffers.size() - 1)
+	{
+		m_traceBuffers[workerID]->Record(event);
+	}
+	else
+	{
+		m_sharedTraceMutex.lock();
+		m_traceBuffers.back()->Record(event);
+		m_sharedTraceMutex.unlock();
+	}
 }
 
 //--------------------------------------------------------------------
@@ -132,38 +520,378 @@ void JobSystem::MoveToCompletedList(Job* job)
 	{
 		return;
 	}
-	m_jobsExecutingMutex.lock();
-	for (auto index = m_jobsExecuting.begin(); index < m_jobsExecuting.end(); index++)
+
+	// release continuations before publishing, the main thread may delete the job once it is retired
+	JobContinuation* continuation = job->FinishExecution();
+	while (continuation)
 	{
-		if (*index == job)
+		JobContinuation* next = continuation->m_next;
+		if (continuation->m_job->ReleaseDependency())
 		{
-			m_jobsExecuting.erase(index);
-			break;
+			ScheduleJob(continuation->m_job);
 		}
+		delete continuation;
+		continuation = next;
 	}
-	m_jobsExecutingMutex.unlock();
 
-	m_jobsCompletedMutex.lock();
-	job->m_state = JobState::COMPLETE;
-	m_jobsCompleted.push_back(job);
-	m_jobsCompletedMutex.unlock();
+	if (job->m_deleteWhenComplete)
+	{
+		delete job;
+	}
+	else
+	{
+		job->m_state = JobState::COMPLETE; // before the push, the retiring thread may delete it right after
+		m_completedJobs.Push(job);
+	}
+
+	if (--m_jobsInFlight == 0 && m_isDraining)
+	{
+		m_drainMutex.lock();
+		m_drainMutex.unlock();
+		m_drainCondition.notify_all();
+	}
 }
 
 //--------------------------------------------------------------------
 Job* JobSystem::RetrieveCompletedJob()
 {
+	CollectCompletedJobs();
 	Job* job = nullptr;
-	// safely remove job from queue
-	m_jobsCompletedMutex.lock();
-	if (m_jobsCompleted.size())
+	if (m_jobsCompletedHead < (int)m_jobsCompleted.size())
 	{
-		job = m_jobsCompleted.front();
-		m_jobsCompleted.pop_front();
+		job = m_jobsCompleted[m_jobsCompletedHead++];
 		job->m_state = JobState::RETIRED;
 	}
-	m_jobsCompletedMutex.unlock();
+	if (m_jobsCompletedHead == (int)m_jobsCompleted.size())
+	{
+		m_jobsCompleted.clear(); // keeps its capacity
+		m_jobsCompletedHead = 0;
+	}
 	return job;
 }
 
 //--------------------------------------------------------------------
+// jobs of other types keep their place for a later call
+int JobSystem::RetrieveCompletedJobs(std::vector<Job*>& out_jobs, int jobTypes)
+{
+	CollectCompletedJobs();
+	int retired = 0;
+	int kept = 0;
+	for (int index = m_jobsCompletedHead; index < (int)m_jobsCompleted.size(); index++)
+	{
+		Job* job = m_jobsCompleted[index];
+		if (job->m_jobType & jobTypes)
+		{
+			job->m_state = JobState::RETIRED;
+			out_jobs.push_back(job);
+			retired++;
+		}
+		else
+		{
+			m_jobsCompleted[kept++] = job;
+		}
+	}
+	m_jobsCompleted.resize(kept);
+	m_jobsCompletedHead = 0;
+	return retired;
+}
 
+//--------------------------------------------------------------------
+void JobSystem::CollectCompletedJobs()
+{
+	for (Job* job = m_completedJobs.PopAll(); job; job = job->m_nextCompleted)
+	{
+		PushBackCountingGrowth(m_jobsCompleted, job);
+	}
+}
+
+//--------------------------------------------------------------------
+int JobSystem::GetQueuedJobCount() const
+{
+	return m_jobsQueuedTotal;
+}
+
+//--------------------------------------------------------------------
+void JobSystem::WaitForJob(JobHandle const& handle, int helpJobTypes)
+{
+	if (helpJobTypes == 0)
+	{
+		handle.Wait();
+		return;
+	}
+	// help drain the queues instead of blocking, so a worker can wait on its own children safely
+	while (!handle.IsComplete())
+	{
+		Job* job = RetrieveJobToExecute(helpJobTypes);
+		if (job)
+		{
+			ExecuteJob(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+//--------------------------------------------------------------------
+void JobSystem::EnterWorkerThread()
+{
+	t_workerJobSystem = this;
+}
+
+//--------------------------------------------------------------------
+bool JobSystem::IsWorkerThread() const
+{
+	return t_workerJobSystem == this;
+}
+
+//--------------------------------------------------------------------
+// the caller always works on its own batches, so a ParallelFor never waits on a helper that has not started
+void JobSystem::RunParallelBatches(int batchCount, ParallelBatchFunction function, void* context)
+{
+	// a worker runs nested batches itself, the other workers are busy with jobs of their own and queueing critical
+	// helpers behind them only makes this one wait
+	int helperCount = IsWorkerThread() ? 0 : (int)m_threads.size();
+	helperCount = helperCount < batchCount - 1 ? helperCount : batchCount - 1;
+	if (helperCount <= 0)
+	{
+		for (int batchIndex = 0; batchIndex < batchCount; batchIndex++)
+		{
+			function(context, batchIndex);
+		}
+		return;
+	}
+
+	ParallelBatchState* state = new ParallelBatchState();
+	state->m_function = function;
+	state->m_context = context;
+	state->m_batchCount = batchCount;
+	for (int index = 0; index < helperCount; index++)
+	{
+		QueueJob(new ParallelBatchJob(state));
+	}
+
+	state->RunBatches();
+	// remaining batches are already running on workers
+	while (state->m_completedBatches < batchCount)
+	{
+		std::this_thread::yield();
+	}
+	state->Release();
+}
+
+//--------------------------------------------------------------------
+// only the queueing thread changes a job's lane, so the heap it names is the one holding the job until it is popped
+bool JobSystem::Reprioritize(Job* job, JobPriority priority, double deadline)
+{
+	int lane = (int)job->m_priority;
+	int bit = GetDeadlineTypeBit(job->m_jobType);
+	deadline = deadline > 0.0 ? deadline : DBL_MAX; // dropping the deadline sorts it last in its lane
+	DeadlineJobHeap& heap = m_deadlineJobs[lane][bit];
+	heap.m_mutex.lock();
+	if (job->m_deadlineSlot < 0)
+	{
+		heap.m_mutex.unlock();
+		return false;
+	}
+	if (priority == job->m_priority)
+	{
+		job->m_deadline = deadline;
+		heap.Update(job);
+		heap.m_mutex.unlock();
+		return true;
+	}
+	heap.Remove(job);
+	if (heap.IsEmpty())
+	{
+		m_deadlineJobBits[lane] &= ~(1u << bit);
+	}
+	heap.m_mutex.unlock();
+
+	job->m_priority = priority;
+	job->m_deadline = deadline;
+	PushDeadlineJob(job);
+	return true;
+}
+
+//--------------------------------------------------------------------
+double JobSystem::GetQueueWaitPercentile(JobPriority priority, double fraction) const
+{
+	int firstLane = priority == JobPriority::COUNT ? 0 : (int)priority;
+	int lastLane = priority == JobPriority::COUNT ? (int)JobPriority::COUNT - 1 : (int)priority;
+	int histogram[JOB_WAIT_HISTOGRAM_BUCKETS] = {};
+	int total = 0;
+	for (int lane = firstLane; lane <= lastLane; lane++)
+	{
+		for (int bucket = 0; bucket < JOB_WAIT_HISTOGRAM_BUCKETS; bucket++)
+		{
+			histogram[bucket] += m_queueWaitHistogram[lane][bucket];
+			total += m_queueWaitHistogram[lane][bucket];
+		}
+	}
+	if (total == 0)
+	{
+		return 0.0;
+	}
+
+	int target = (int)(fraction * (double)(total - 1));
+	int seen = 0;
+	for (int bucket = 0; bucket < JOB_WAIT_HISTOGRAM_BUCKETS; bucket++)
+	{
+		seen += histogram[bucket];
+		if (seen > target)
+		{
+			return (double)(1 << bucket);
+		}
+	}
+	return (double)(1 << (JOB_WAIT_HISTOGRAM_BUCKETS - 1));
+}
+
+//--------------------------------------------------------------------
+void JobSystem::ReportQueueWaitHistograms() const
+{
+	static char const* laneNames[(int)JobPriority::COUNT] = { "critical", "high", "normal", "low" };
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, "queue wait      jobs   p50(us)   p90(us)   p99(us)");
+	for (int lane = 0; lane < (int)JobPriority::COUNT; lane++)
+	{
+		int total = 0;
+		for (int bucket = 0; bucket < JOB_WAIT_HISTOGRAM_BUCKETS; bucket++)
+		{
+			total += m_queueWaitHistogram[lane][bucket];
+		}
+		JobPriority priority = (JobPriority)lane;
+		std::string line = Stringf("%-10s %9i %9.0f %9.0f %9.0f", laneNames[lane], total, GetQueueWaitPercentile(priority, 0.5),
+			GetQueueWaitPercentile(priority, 0.9), GetQueueWaitPercentile(priority, 0.99));
+		g_theConsole->AddLine(DevConsole::TINT_INFO_MINOR, line);
+		DebuggerPrintf("jobwaits %s\n", line.c_str());
+	}
+}
+
+//--------------------------------------------------------------------
+void JobSystem::ResetQueueWaitHistograms()
+{
+	for (int lane = 0; lane < (int)JobPriority::COUNT; lane++)
+	{
+		for (int bucket = 0; bucket < JOB_WAIT_HISTOGRAM_BUCKETS; bucket++)
+		{
+			m_queueWaitHistogram[lane][bucket] = 0;
+		}
+	}
+}
+
+//--------------------------------------------------------------------
+void JobSystem::ReportWorkerIdleStats() const
+{
+	double wallMicroseconds = (GetCurrentTimeSeconds() - m_idleStatsStartTime) * 1000000.0;
+	if (wallMicroseconds <= 0.0)
+	{
+		return;
+	}
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, "worker   types   busy%   spin%  parked%    parks     jobs");
+	double spinningMicroseconds = 0.0;
+	for (int index = 0; index < (int)m_threads.size(); index++)
+	{
+		JobWorkerThread const* worker = m_threads[index];
+		spinningMicroseconds += (double)worker->m_spinningMicroseconds;
+		std::string line = Stringf("%6i  0x%04x %7.1f %7.1f %8.1f %8i %8i", index, worker->m_jobType & 0xffff,
+			100.0 * (double)worker->m_busyMicroseconds / wallMicroseconds, 100.0 * (double)worker->m_spinningMicroseconds / wallMicroseconds,
+			100.0 * (double)worker->m_parkedMicroseconds / wallMicroseconds, (int)worker->m_parkCount, (int)worker->m_jobsExecuted);
+		g_theConsole->AddLine(DevConsole::TINT_INFO_MINOR, line);
+		DebuggerPrintf("jobidle %s\n", line.c_str());
+	}
+	// spinning is the cpu an idle pool burns, parked workers cost nothing until they are woken
+	std::string summary = Stringf("idle cpu %.3f cores over %.1fs, queue to start p50 %.0fus p99 %.0fus", spinningMicroseconds / wallMicroseconds,
+		wallMicroseconds / 1000000.0, GetQueueWaitPercentile(JobPriority::COUNT, 0.5), GetQueueWaitPercentile(JobPriority::COUNT, 0.99));
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, summary);
+	DebuggerPrintf("jobidle %s\n", summary.c_str());
+}
+
+//--------------------------------------------------------------------
+void JobSystem::ResetWorkerIdleStats()
+{
+	for (int index = 0; index < (int)m_threads.size(); index++)
+	{
+		m_threads[index]->ResetIdleStats();
+	}
+	m_idleStatsStartTime = GetCurrentTimeSeconds();
+}
+
+//--------------------------------------------------------------------
+void JobSystem::ReportJobPools() const
+{
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, "job pool                                 size     live capacity    heap");
+	for (JobPool const* pool = JobPool::GetFirstPool(); pool; pool = pool->GetNextPool())
+	{
+		std::string line = Stringf("%-38s %6i %8i %8i %7i", pool->GetName(), (int)pool->GetObjectSize(), pool->GetLiveCount(),
+			pool->GetCapacity(), pool->GetHeapAllocations());
+		g_theConsole->AddLine(DevConsole::TINT_INFO_MINOR, line);
+		DebuggerPrintf("jobpool %s\n", line.c_str());
+	}
+	std::string containers = Stringf("%-38s %6s %8s %8s %7i", "queues, lists and reduce partials", "", "", "", JobPool::GetUnpooledHeapAllocations());
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MINOR, containers);
+	DebuggerPrintf("jobpool %s\n", containers.c_str());
+	std::string summary = Stringf("job path heap allocations last frame %i, frames without one %i", m_frameHeapAllocations, m_framesWithoutHeapAllocation);
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, summary);
+	DebuggerPrintf("jobpool %s\n", summary.c_str());
+}
+
+//--------------------------------------------------------------------
+// the rings are allocated by the first trace and kept for later ones, so a game that never traces never pays for them
+// and recording never allocates, workers only look at them once m_isTracing is set after they exist
+// the write counts belong to the workers, a job that passed the flag before the last StopTrace can still be recording,
+// so each ring only marks where this capture starts and FormatChromeTrace drops an event that began before it
+void JobSystem::StartTrace(double seconds, std::string const& filename)
+{
+	if (m_traceBuffers.empty())
+	{
+		for (int index = 0; index <= (int)m_threads.size(); index++)
+		{
+			std::string threadName = index < (int)m_threads.size() ? Stringf("worker %i", index) : "other threads";
+			m_traceBuffers.push_back(new JobTraceBuffer(m_config.m_traceEventsPerThread, threadName));
+		}
+	}
+	m_traceFilename = filename;
+	m_traceStartTime = GetCurrentTimeSeconds();
+	for (int index = 0; index < (int)m_traceBuffers.size(); index++)
+	{
+		m_traceBuffers[index]->MarkStart();
+	}
+	m_traceStopTime = seconds > 0.0 ? m_traceStartTime + seconds : 0.0;
+	m_isTracing = true;
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, Stringf("job trace started, writing %s %s", filename.c_str(),
+		seconds > 0.0 ? Stringf("in %.1fs", seconds).c_str() : "on the next jobtrace"));
+}
+
+//--------------------------------------------------------------------
+// a worker that checked the flag just before it dropped can still finish one event, CopyEvents skips that slot
+void JobSystem::StopTrace()
+{
+	m_isTracing = false;
+	std::string json = FormatChromeTrace(m_traceBuffers, m_traceStartTime, m_jobTypeNames);
+	std::vector<uint8_t> buffer(json.begin(), json.end());
+	FileWriteBinaryBuffer(buffer, m_traceFilename);
+	std::string line = Stringf("job trace of %.1fs written to %s (%i bytes)", GetCurrentTimeSeconds() - m_traceStartTime, m_traceFilename.c_str(), (int)buffer.size());
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, line);
+	DebuggerPrintf("%s\n", line.c_str());
+}
+
+//--------------------------------------------------------------------
+bool JobSystem::IsTracing() const
+{
+	return m_isTracing;
+}
+
+//--------------------------------------------------------------------
+void JobSystem::SetJobTypeName(int jobType, char const* name)
+{
+	for (int bit = 0; bit < 32; bit++)
+	{
+		if (jobType & (1 << bit))
+		{
+			m_jobTypeNames[bit] = name;
+		}
+	}
+}
+
+//--------------------------------------------------------------------
@@ -3,14 +3,32 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
-#include <deque>
+#include <condition_variable>
 #include "Job.hpp"
 #include "JobWorkerThread.hpp"
+#include "CompletedJobQueue.hpp"
+#include "DeadlineJobHeap.hpp"
+#include "JobPool.hpp"
+#include "JobTrace.hpp"
 #include <vector>
 
+constexpr int JOB_TYPE_PARALLEL_FOR = 0x8000; // every worker accepts the batch helpers queued by ParallelFor
+constexpr int PARALLEL_REDUCE_INLINE_BATCHES = 64; // a ParallelReduce with up to this many batches keeps its partials on the stack
+
+// called once per batch, context points at the caller's lambda
+typedef void (*ParallelBatchFunction)(void* context, int batchIndex);
+
+constexpr int JOB_WAIT_HISTOGRAM_BUCKETS = 24; // bucket n counts queue waits under 2^n microseconds, the last one everything longer
+
 struct JobSystemConfig
 {
 	int m_workerThreads = 12;
+	int m_jobQueueCapacity = 4096;		// per worker and lane, rounded up to a power of two
+	bool m_limitToHardwareThreads = true;	// benchmarks turn this off to oversubscribe the cores
+	int m_defaultWorkerJobTypes = ~0;		// type mask for workers past the end of m_workerJobTypes
+	std::vector<int> m_workerJobTypes;		// type mask per worker, e.g. { LOAD | SAVE } keeps disc access on worker 0
+	double m_maxIdleSpinMicroseconds = 50.0;	// an idle worker spins at most this long before it parks
+	int m_traceEventsPerThread = 16384;		// ring size per worker for jobtrace, the newest events win
 };
 
 class JobSystem
@@ -19,24 +37,179 @@ public:
 	~JobSystem();
 	JobSystem(JobSystemConfig& config);
 	void Startup();
-	void Shutdown();
+	void Shutdown(); // runs every queued job (and the continuations they release) before joining the workers
 	void BeginFrame();
 	void EndFrame();
 
-	void QueueJob(Job* job);
-	Job* RetrieveJobToExecute(int jobType);
+	void QueueJob(Job* job); // jobs with unfinished prerequisites wait here until the last one completes
+	Job* RetrieveJobToExecute(int jobType, int workerID = -1);
 	void MoveToCompletedList(Job* job);
+	// completed jobs are retired by one thread (the one that owns them, usually the main thread)
 	Job* RetrieveCompletedJob(); // dynamic_cast<> to ChunkGenerateJob* to determine if it is
+	int RetrieveCompletedJobs(std::vector<Job*>& out_jobs, int jobTypes = ~0); // appends every finished job of these types, oldest first
+	int GetQueuedJobCount() const;
+	void WaitForJob(JobHandle const& handle, int helpJobTypes = 0); // optionally run matching jobs while waiting
+	// only jobs still queued with a deadline can be moved, returns false once the job has started (or has no deadline),
+	// a job staying in its lane moves inside its heap, only a change of lane takes it to another heap
+	bool Reprioritize(Job* job, JobPriority priority, double deadline);
+
+	void ReportQueueWaitHistograms() const; // one line per lane to the dev console
+	void ResetQueueWaitHistograms();
+	double GetQueueWaitPercentile(JobPriority priority, double fraction) const; // microseconds, upper edge of the bucket, COUNT for all lanes
+	void ReportWorkerIdleStats() const; // busy, spinning and parked time per worker to the dev console
+	void ResetWorkerIdleStats();
+	void ReportJobPools() const; // pool occupancy and the heap allocation counters updated in EndFrame
+
+	// tracing costs one load per job while it is off, so it stays compiled into release builds, its rings are allocated
+	// by the first StartTrace
+	void StartTrace(double seconds, std::string const& filename); // seconds <= 0 records until StopTrace
+	void StopTrace(); // writes the Chrome trace-event JSON
+	bool IsTracing() const;
+	void SetJobTypeName(int jobType, char const* name); // labels the trace, one name per type bit
+	void ExecuteJob(Job* job, int workerID = -1); // runs a retrieved job, traces it if a capture is running, then completes it
+
+	void EnterWorkerThread(); // called by each worker as it starts
+	bool IsWorkerThread() const; // true on this system's workers, where ParallelFor and ParallelReduce run serially
+
+	// split [begin, end) into batches of grainSize and run them on the calling thread plus any free workers,
+	// only a thread outside the workers fans out, a job already running on a worker runs every batch itself
+	// function(index) is called once per index, ParallelFor returns when every batch has run
+	template <typename Function>
+	void ParallelFor(int begin, int end, int grainSize, Function const& function);
+	// function(index, accumulator) folds one index into its batch's partial result,
+	// partials are combined in batch order so the result does not depend on scheduling
+	template <typename T, typename Function, typename Combine>
+	T ParallelReduce(int begin, int end, int grainSize, T identity, Function const& function, Combine const& combine);
+	void RunParallelBatches(int batchCount, ParallelBatchFunction function, void* context);
 
-	std::deque<Job*> m_jobsQueue;
+private:
+	void ScheduleJob(Job* job);
+	void PushDeadlineJob(Job* job);
+	Job* RetrieveDeadlineJob(int jobTypes, int lane);
+	Job* StealJob(int jobTypes, int thiefID, int lane);
+	Job* RetrieveOverflowJob(int jobTypes);
+	Job* RetrieveDrainJob(int orphanJobTypes);
+	void MarkRetrieved(Job* job); // the job leaves the queues and starts processing
+	void RecordQueueWait(Job* job);
+	void WakeWorkerFor(Job* job, JobWorkerThread* owner); // owner is the worker whose ring took the job, null if it is shared
+	void CollectCompletedJobs();
+	void RecordJobTrace(Job* job, int workerID, double beginTime, double endTime);
+
+public:
+	// overflow for jobs no worker accepts yet (queued before Startup) or when a worker's ring is full
+	std::vector<Job*> m_jobsQueue;
 	std::mutex m_jobsQueueMutex;
-	std::deque<Job*> m_jobsExecuting;
-	std::mutex m_jobsExecutingMutex;
-	std::deque<Job*> m_jobsCompleted;
-	std::mutex m_jobsCompletedMutex;
+	std::atomic<int> m_jobsQueueCount = 0;
+	// jobs with a deadline wait in a heap per lane and job type bit (the lowest bit of the job's type), earliest deadline runs
+	// first, so a worker only locks the heaps of types it runs and a job can be reordered after it is queued without a search
+	DeadlineJobHeap m_deadlineJobs[(int)JobPriority::COUNT][32];
+	std::atomic<unsigned int> m_deadlineJobBits[(int)JobPriority::COUNT] = {};	// type bits whose heap in the lane holds jobs
+	CompletedJobQueue m_completedJobs;	// workers push here without a lock
+	std::vector<Job*> m_jobsCompleted;	// collected from m_completedJobs but not retired yet, only the retiring thread touches it
+	int m_jobsCompletedHead = 0;		// next one RetrieveCompletedJob hands out
 
+	std::atomic<int> m_jobsQueuedTotal = 0;		// jobs submitted but not yet started
+	std::atomic<int> m_jobsInFlight = 0;		// jobs submitted but not yet finished, Shutdown drains this to zero
+	std::atomic<bool> m_isDraining = false;
+	std::mutex m_drainMutex;
+	std::condition_variable m_drainCondition;
+	std::atomic<int> m_parkedWorkerCount = 0;	// lets the queueing thread skip looking for a worker to wake when none sleep
+	double m_idleStatsStartTime = 0.0;
+	int m_lastHeapAllocations = 0;
+	int m_frameHeapAllocations = 0;			// heap allocations on the job path during the last frame, see EndFrame
+	int m_framesWithoutHeapAllocation = 0;
+
+	std::atomic<bool> m_isTracing = false;
+	std::vector<JobTraceBuffer*> m_traceBuffers;	// one per worker, the last is shared by every other thread, empty until traced
+	std::mutex m_sharedTraceMutex;
+	double m_traceStartTime = 0.0;
+	double m_traceStopTime = 0.0;		// 0 while the capture has no time limit
+	std::string m_traceFilename;
+	char const* m_jobTypeNames[32] = {};
+	std::atomic<unsigned int> m_nextWorker = 0;	// round robin start for routing new jobs
+	std::atomic<int> m_queueWaitHistogram[(int)JobPriority::COUNT][JOB_WAIT_HISTOGRAM_BUCKETS] = {};
 	int m_workerThreads = 12;
 	std::vector<JobWorkerThread*> m_threads = {};
 	JobSystemConfig m_config = {};
 };
 
+//--------------------------------------------------------------------
+template <typename Function>
+void JobSystem::ParallelFor(int begin, int end, int grainSize, Function const& function)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+	grainSize = grainSize < 1 ? 1 : grainSize;
+	int batchCount = (end - begin + grainSize - 1) / grainSize;
+	auto runBatch = [&](int batchIndex)
+	{
+		int batchBegin = begin + batchIndex * grainSize;
+		int batchEnd = batchBegin + grainSize < end ? batchBegin + grainSize : end;
+		for (int index = batchBegin; index < batchEnd; index++)
+		{
+			function(index);
+		}
+	};
+	RunParallelBatches(batchCount, [](void* context, int batchIndex) { (*static_cast<decltype(runBatch)*>(context))(batchIndex); }, &runBatch);
+}
+
+//--------------------------------------------------------------------
+template <typename T, typename Function, typename Combine>
+T JobSystem::ParallelReduce(int begin, int end, int grainSize, T identity, Function const& function, Combine const& combine)
+{
+	if (end <= begin)
+	{
+		return identity;
+	}
+	grainSize = grainSize < 1 ? 1 : grainSize;
+	int batchCount = (end - begin + grainSize - 1) / grainSize;
+	// one cache line per partial so batches on different workers never share a line (and never a vector<bool> word)
+	// the partials live on the stack up to PARALLEL_REDUCE_INLINE_BATCHES, only a wider reduce allocates (and is counted)
+	struct alignas(64) Partial
+	{
+		T m_value;
+	};
+	alignas(64) unsigned char inlineStorage[PARALLEL_REDUCE_INLINE_BATCHES * sizeof(Partial)];
+	std::vector<Partial> heapPartials;
+	Partial* partials = reinterpret_cast<Partial*>(inlineStorage);
+	if (batchCount > PARALLEL_REDUCE_INLINE_BATCHES)
+	{
+		JobPool::CountHeapAllocation();
+		heapPartials.resize(batchCount, Partial{ identity });
+		partials = heapPartials.data();
+	}
+	else
+	{
+		for (int batchIndex = 0; batchIndex < batchCount; batchIndex++)
+		{
+			new (&partials[batchIndex]) Partial{ identity };
+		}
+	}
+	auto runBatch = [&](int batchIndex)
+	{
+		int batchBegin = begin + batchIndex * grainSize;
+		int batchEnd = batchBegin + grainSize < end ? batchBegin + grainSize : end;
+		T& accumulator = partials[batchIndex].m_value;
+		for (int index = batchBegin; index < batchEnd; index++)
+		{
+			function(index, accumulator);
+		}
+	};
+	RunParallelBatches(batchCount, [](void* context, int batchIndex) { (*static_cast<decltype(runBatch)*>(context))(batchIndex); }, &runBatch);
+
+	T result = identity;
+	for (int batchIndex = 0; batchIndex < batchCount; batchIndex++)
+	{
+		result = combine(result, partials[batchIndex].m_value);
+	}
+	if (heapPartials.empty())
+	{
+		for (int batchIndex = 0; batchIndex < batchCount; batchIndex++)
+		{
+			partials[batchIndex].~Partial();
+		}
+	}
+	return result;
+}
@@ -0,0 +1,152 @@
+#include "Engine/Core/JobSystemBenchmark.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "ThirdParty/Squirrel/RawNoise.hpp"
+#include <algorithm>
+
+constexpr int JOB_BENCHMARK_TYPE = 0xFFFF; // wild card so every worker accepts the jobs
+
+class BenchmarkJob : public Job
+{
+public:
+	BenchmarkJob()
+		: Job(JOB_BENCHMARK_TYPE)
+	{
+	}
+
+	virtual void Execute() override
+	{
+		m_startTime = GetCurrentTimeSeconds();
+		unsigned int hash = 0;
+		for (int index = 0; index < m_work; index++)
+		{
+			hash += Get1dNoiseUint(index, hash);
+		}
+		m_result = hash;
+	}
+
+	int m_work = 0;
+	unsigned int m_result = 0;
+	double m_queuedTime = 0.0;
+	double m_startTime = 0.0;
+};
+
+//--------------------------------------------------------------------
+static double GetPercentile(std::vector<double> const& sorted, double fraction)
+{
+	if (sorted.empty())
+	{
+		return 0.0;
+	}
+	int index = (int)(fraction * (double)(sorted.size() - 1));
+	return sorted[index];
+}
+
+//--------------------------------------------------------------------
+JobBenchmarkResult RunJobSystemBenchmark(int workerThreads, int jobCount, int workPerJob)
+{
+	JobBenchmarkResult result;
+	result.m_workerThreads = workerThreads;
+	result.m_jobCount = jobCount;
+
+	JobSystemConfig config;
+	config.m_workerThreads = workerThreads;
+	config.m_limitToHardwareThreads = false;
+	JobSystem jobSystem(config);
+	jobSystem.Startup();
+
+	// allocate up front so only the scheduler is measured
+	std::vector<BenchmarkJob> jobs(jobCount);
+	for (int index = 0; index < jobCount; index++)
+	{
+		jobs[index].m_work = workPerJob;
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int index = 0; index < jobCount; index++)
+	{
+		jobs[index].m_queuedTime = GetCurrentTimeSeconds();
+		jobSystem.QueueJob(&jobs[index]);
+	}
+	int retired = 0;
+	while (retired < jobCount)
+	{
+		if (jobSystem.RetrieveCompletedJob())
+		{
+			retired++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	double elapsed = GetCurrentTimeSeconds() - startTime;
+	jobSystem.Shutdown();
+
+	std::vector<double> latencies;
+	latencies.reserve(jobCount);
+	for (int index = 0; index < jobCount; index++)
+	{
+		latencies.push_back((jobs[index].m_startTime - jobs[index].m_queuedTime) * 1000000.0);
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	result.m_jobsPerSecond = elapsed > 0.0 ? (double)jobCount / elapsed : 0.0;
+	result.m_latencyP50 = GetPercentile(latencies, 0.5);
+	result.m_latencyP99 = GetPercentile(latencies, 0.99);
+	result.m_latencyP999 = GetPercentile(latencies, 0.999);
+	result.m_latencyMax = latencies.empty() ? 0.0 : latencies.back();
+	return result;
+}
+
+//--------------------------------------------------------------------
+bool Command_JobBenchmark(EventArgs& args)
+{
+	int maxWorkers = args.GetValue("workers", 64);
+	int jobCount = args.GetValue("jobs", 20000);
+	int work = args.GetValue("work", 256);
+
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, Stringf("JobSystem benchmark: %i jobs, %i hashes per job", jobCount, work));
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, "workers     jobs/sec   p50(us)   p99(us) p99.9(us)   max(us)");
+	for (int workers = 1; workers <= maxWorkers; workers *= 2)
+	{
+		JobBenchmarkResult result = RunJobSystemBenchmark(workers, jobCount, work);
+		std::string line = Stringf("%7i %12.0f %9.1f %9.1f %9.1f %9.1f", result.m_workerThreads, result.m_jobsPerSecond,
+			result.m_latencyP50, result.m_latencyP99, result.m_latencyP999, result.m_latencyMax);
+		g_theConsole->AddLine(DevConsole::TINT_INFO_MINOR, line);
+		DebuggerPrintf("jobbench %s\n", line.c_str());
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------
+void RunParallelScalingBenchmark(char const* name, int maxWorkers, int repeats, std::function<void(JobSystem&)> const& kernel)
+{
+	repeats = repeats < 1 ? 1 : repeats;
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, Stringf("%s: best of %i runs", name, repeats));
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, "workers      ms   speedup");
+	double serialSeconds = 0.0;
+	for (int workers = 0; workers <= maxWorkers; workers = workers ? workers * 2 : 1)
+	{
+		JobSystemConfig config;
+		config.m_workerThreads = workers;
+		config.m_limitToHardwareThreads = false;
+		JobSystem jobSystem(config);
+		jobSystem.Startup();
+
+		double bestSeconds = 0.0;
+		for (int run = 0; run < repeats; run++)
+		{
+			double startTime = GetCurrentTimeSeconds();
+			kernel(jobSystem);
+			double seconds = GetCurrentTimeSeconds() - startTime;
+			bestSeconds = (run == 0 || seconds < bestSeconds) ? seconds : bestSeconds;
+		}
+		jobSystem.Shutdown();
+
+		serialSeconds = workers == 0 ? bestSeconds : serialSeconds;
+		std::string line = Stringf("%7i %8.3f %8.2fx", workers, bestSeconds * 1000.0, bestSeconds > 0.0 ? serialSeconds / bestSeconds : 0.0);
+		g_theConsole->AddLine(DevConsole::TINT_INFO_MINOR, line);
+		DebuggerPrintf("%s %s\n", name, line.c_str());
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include <functional>
+
+class JobSystem;
+
+// microbenchmark of JobSystem scheduling overhead: throughput and queue-to-start latency
+struct JobBenchmarkResult
+{
+	int m_workerThreads = 0;
+	int m_jobCount = 0;
+	double m_jobsPerSecond = 0.0;
+	double m_latencyP50 = 0.0;		// microseconds from QueueJob to Execute
+	double m_latencyP99 = 0.0;
+	double m_latencyP999 = 0.0;
+	double m_latencyMax = 0.0;
+};
+
+JobBenchmarkResult RunJobSystemBenchmark(int workerThreads, int jobCount, int workPerJob);
+
+// console command: jobbench workers=<max> jobs=<count> work=<iterations>
+// runs 1, 2, 4 ... workers up to the max (64 by default) and prints one line per run
+bool Command_JobBenchmark(EventArgs& args);
+
+// scaling of a real ParallelFor kernel: kernel(jobSystem) is timed on a private JobSystem with 0 (serial), 1, 2, 4 ...
+// workers up to maxWorkers, best of repeats, and one line per run is printed with the speedup over serial
+void RunParallelScalingBenchmark(char const* name, int maxWorkers, int repeats, std::function<void(JobSystem&)> const& kernel);
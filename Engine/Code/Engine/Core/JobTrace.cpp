@@ -0,0 +1,89 @@
+#include "Engine/Core/JobTrace.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+//--------------------------------------------------------------------
+JobTraceBuffer::JobTraceBuffer(int capacity, std::string const& threadName)
+	: m_threadName(threadName)
+{
+	// power of two so the ring index is a mask
+	unsigned int size = 2;
+	while (size < (unsigned int)capacity)
+	{
+		size <<= 1;
+	}
+	m_events.resize(size);
+	m_mask = size - 1;
+}
+
+//--------------------------------------------------------------------
+void JobTraceBuffer::Record(JobTraceEvent const& event)
+{
+	unsigned int count = m_writeCount.load(std::memory_order_relaxed);
+	m_events[count & m_mask] = event;
+	m_writeCount.store(count + 1, std::memory_order_release);
+}
+
+//--------------------------------------------------------------------
+void JobTraceBuffer::MarkStart()
+{
+	m_startCount = m_writeCount.load(std::memory_order_acquire);
+}
+
+//--------------------------------------------------------------------
+int JobTraceBuffer::CopyEvents(std::vector<JobTraceEvent>& out_events) const
+{
+	unsigned int count = m_writeCount.load(std::memory_order_acquire);
+	unsigned int capacity = m_mask + 1;
+	// differences so the counts may wrap
+	unsigned int first = count - m_startCount >= capacity ? count - capacity + 1 : m_startCount;
+	for (unsigned int index = first; index != count; index++)
+	{
+		out_events.push_back(m_events[index & m_mask]);
+	}
+	return (int)(count - first);
+}
+
+//--------------------------------------------------------------------
+std::string FormatChromeTrace(std::vector<JobTraceBuffer*> const& buffers, double startTime, char const* const* jobTypeNames)
+{
+	static char const* priorityNames[] = { "critical", "high", "normal", "low" };
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	std::vector<JobTraceEvent> events;
+	bool isFirst = true;
+	for (int threadIndex = 0; threadIndex < (int)buffers.size(); threadIndex++)
+	{
+		JobTraceBuffer const* buffer = buffers[threadIndex];
+		json += Stringf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%i,\"args\":{\"name\":\"%s\"}}", isFirst ? "" : ",\n",
+			threadIndex, buffer->m_threadName.c_str());
+		isFirst = false;
+
+		events.clear();
+		buffer->CopyEvents(events);
+		for (int index = 0; index < (int)events.size(); index++)
+		{
+			JobTraceEvent const& event = events[index];
+			if (event.m_beginTime < startTime)
+			{
+				continue;
+			}
+			// name by the lowest type bit that has a name
+			std::string name = Stringf("0x%04x", event.m_jobType);
+			for (int bit = 0; bit < 32; bit++)
+			{
+				if ((event.m_jobType & (1 << bit)) && jobTypeNames[bit])
+				{
+					name = jobTypeNames[bit];
+					break;
+				}
+			}
+			double beginMicroseconds = (event.m_beginTime - startTime) * 1000000.0;
+			double durationMicroseconds = (event.m_endTime - event.m_beginTime) * 1000000.0;
+			double waitMicroseconds = (event.m_beginTime - event.m_readyTime) * 1000000.0;
+			json += Stringf(",\n{\"name\":\"%s\",\"cat\":\"job\",\"ph\":\"X\",\"pid\":0,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f,"
+				"\"args\":{\"type\":\"0x%04x\",\"priority\":\"%s\",\"queueWaitUs\":%.3f}}", name.c_str(), threadIndex, beginMicroseconds,
+				durationMicroseconds, event.m_jobType, priorityNames[event.m_priority & 3], waitMicroseconds);
+		}
+	}
+	json += "\n]}\n";
+	return json;
+}
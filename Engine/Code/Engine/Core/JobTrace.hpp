@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <string>
+
+// one executed job, as recorded by the thread that ran it
+struct JobTraceEvent
+{
+	double m_beginTime = 0.0;	// GetCurrentTimeSeconds()
+	double m_endTime = 0.0;
+	double m_readyTime = 0.0;	// when it became runnable, begin - ready is its queue wait
+	int m_jobType = 0;
+	int m_priority = 0;
+};
+
+// fixed ring of the most recent events for one thread, only the owning thread writes (or a writer holding a lock for
+// the shared buffer), readers take the published count and skip the oldest slot that a late writer could still be filling
+// the write count is never reset, a capture remembers where it started so a writer from the last capture cannot rewind it
+class JobTraceBuffer
+{
+public:
+	JobTraceBuffer(int capacity, std::string const& threadName);
+	JobTraceBuffer(const JobTraceBuffer& copy) = delete;
+
+	void Record(JobTraceEvent const& event);
+	void MarkStart(); // called by the thread running the capture, later copies only return events recorded after it
+	int CopyEvents(std::vector<JobTraceEvent>& out_events) const; // oldest first since MarkStart, returns how many were appended
+
+	std::string m_threadName;
+
+private:
+	std::vector<JobTraceEvent> m_events;
+	unsigned int m_mask = 0;
+	std::atomic<unsigned int> m_writeCount = 0;
+	unsigned int m_startCount = 0;	// m_writeCount at MarkStart, only the capturing thread touches it
+};
+
+// Chrome trace-event JSON (chrome://tracing, Perfetto): one complete event per job on a row per thread
+// jobTypeNames has an entry per job type bit, null entries are printed as the hex type, events that began before startTime
+// (a job that passed the tracing check before the last capture stopped) are left out
+std::string FormatChromeTrace(std::vector<JobTraceBuffer*> const& buffers, double startTime, char const* const* jobTypeNames);
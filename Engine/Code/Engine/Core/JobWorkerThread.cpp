@@ -1,11 +1,33 @@
 #include "Engine/Core/JobWorkerThread.hpp"
 #include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/StringUtils.hpp"
 #include "Job.hpp"
 #include <thread>
 #include <chrono>
 
-JobWorkerThread::JobWorkerThread(int id, JobSystem* jobSystem, int jobType)
-	: m_threadID(id), m_jobSystem(jobSystem), m_jobType(jobType)
+JobWorkerThread::~JobWorkerThread()
+{
+	for (int lane = 0; lane < (int)JobPriority::COUNT; lane++)
+	{
+		delete m_jobs[lane];
+		m_jobs[lane] = nullptr;
+	}
+}
+
+JobWorkerThread::JobWorkerThread(int id, JobSystem* jobSystem, int jobType, int queueCapacity)
+	: m_threadID(id), m_jobType(jobType), m_jobSystem(jobSystem)
+{
+	m_spinMicroseconds = jobSystem->m_config.m_maxIdleSpinMicroseconds;
+	for (int lane = 0; lane < (int)JobPriority::COUNT; lane++)
+	{
+		m_jobs[lane] = new JobQueue(queueCapacity);
+	}
+}
+
+// threads are started only after every worker (and its queue) exists, since workers steal from each other
+void JobWorkerThread::Start()
 {
 	m_thread = std::thread(&JobWorkerThread::JobWorkerMain, m_threadID, this);
 }
@@ -17,27 +39,109 @@ void JobWorkerThread::JobWorkerMain(int threadID, JobWorkerThread* worker)
 		return;
 	}
 
+	Profiler::SetThreadName(Stringf("worker %i", threadID));
+	worker->m_jobSystem->EnterWorkerThread();
 	worker->Main();
 }
 
 void JobWorkerThread::Main()
 {
-	Job* job;
-	while (!m_isQuitting)
+	double maxSpinMicroseconds = m_jobSystem->m_config.m_maxIdleSpinMicroseconds;
+	double phaseStart = GetCurrentTimeSeconds();
+	double spinStart = phaseStart;
+	Job* job = nullptr;
+	while (!m_isQuitting || job) // never drop a job Park() already took off the queues
 	{
-		job = m_jobSystem->RetrieveJobToExecute(m_jobType); // nominally a create job
+		if (job == nullptr)
+		{
+			job = m_jobSystem->RetrieveJobToExecute(m_jobType, m_threadID); // own queue first, then steal
+		}
 		if (job)
 		{
-			job->Execute();
-			m_jobSystem->MoveToCompletedList(job);
+			AddElapsed(m_spinningMicroseconds, phaseStart);
+			m_jobSystem->ExecuteJob(job, m_threadID);
+			AddElapsed(m_busyMicroseconds, phaseStart);
+			m_jobsExecuted++;
+			job = nullptr;
+			spinStart = phaseStart;
+			continue;
+		}
+
+		if ((GetCurrentTimeSeconds() - spinStart) * 1000000.0 < m_spinMicroseconds)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		AddElapsed(m_spinningMicroseconds, phaseStart);
+		job = Park();
+		double parkedMicroseconds = AddElapsed(m_parkedMicroseconds, phaseStart) * 1000000.0;
+		// a short park means a little more spinning would have caught the job without paying for the sleep and wake
+		if (parkedMicroseconds < maxSpinMicroseconds)
+		{
+			m_spinMicroseconds = m_spinMicroseconds * 2.0 + 1.0 < maxSpinMicroseconds ? m_spinMicroseconds * 2.0 + 1.0 : maxSpinMicroseconds;
 		}
 		else
 		{
-			std::this_thread::sleep_for(std::chrono::microseconds(10));
+			m_spinMicroseconds *= 0.5;
 		}
+		spinStart = phaseStart;
 	}
 }
 
+// the parked flag is published before the queues are checked one last time, and JobSystem checks the flag after it
+// has queued a job, so with a full fence on both sides at least one of them sees the other and no wake is lost
+Job* JobWorkerThread::Park()
+{
+	m_jobSystem->m_parkedWorkerCount++;
+	m_isParked = true;
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	Job* job = m_jobSystem->RetrieveJobToExecute(m_jobType, m_threadID);
+	if (job == nullptr && !m_isQuitting)
+	{
+		std::unique_lock<std::mutex> lock(m_parkMutex);
+		m_parkCondition.wait(lock, [this]() { return m_wakeSignal; });
+		m_wakeSignal = false;
+		m_parkCount++;
+	}
+	// if a waker claimed us in the meantime its signal is left over and the next park returns straight away, which is harmless
+	m_isParked = false;
+	m_jobSystem->m_parkedWorkerCount--;
+	return job;
+}
+
+bool JobWorkerThread::Wake()
+{
+	bool isParked = true;
+	if (!m_isParked.compare_exchange_strong(isParked, false))
+	{
+		return false;
+	}
+	m_parkMutex.lock();
+	m_wakeSignal = true;
+	m_parkMutex.unlock();
+	m_parkCondition.notify_one();
+	return true;
+}
+
+double JobWorkerThread::AddElapsed(std::atomic<long long>& counter, double& phaseStart)
+{
+	double now = GetCurrentTimeSeconds();
+	double elapsed = now - phaseStart;
+	counter += (long long)(elapsed * 1000000.0);
+	phaseStart = now;
+	return elapsed;
+}
+
+void JobWorkerThread::ResetIdleStats()
+{
+	m_busyMicroseconds = 0;
+	m_spinningMicroseconds = 0;
+	m_parkedMicroseconds = 0;
+	m_parkCount = 0;
+	m_jobsExecuted = 0;
+}
+
 void JobWorkerThread::join()
 {
 	m_thread.join();
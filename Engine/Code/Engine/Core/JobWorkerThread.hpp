@@ -1,6 +1,10 @@
 #pragma once
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "Engine/Core/JobQueue.hpp"
+#include "Engine/Core/Job.hpp"
 
 class JobSystem;
 class Job;
@@ -8,14 +12,38 @@ class Job;
 class JobWorkerThread
 {
 public:
-	JobWorkerThread(int id, JobSystem* jobSystem, int jobType);
+	virtual ~JobWorkerThread();
+	JobWorkerThread(int id, JobSystem* jobSystem, int jobType, int queueCapacity);
 	static void JobWorkerMain(int threadID, JobWorkerThread* worker);
+	void Start();
 	virtual void Main();
 	void join();
+	bool Wake(); // claims a parked worker and signals it, false if it was not parked (someone else already woke it)
+	void ResetIdleStats();
 
+private:
+	Job* Park(); // sleeps until woken, returns a job if one showed up before it could fall asleep
+	double AddElapsed(std::atomic<long long>& counter, double& phaseStart); // seconds since phaseStart, which moves to now
+
+public:
 	int m_threadID = -1;
 	int m_jobType = 0;
 	std::thread m_thread;
-	std::atomic<bool> m_isQuitting;
+	std::atomic<bool> m_isQuitting = false;
 	JobSystem* m_jobSystem = nullptr;
+	JobQueue* m_jobs[(int)JobPriority::COUNT] = {}; // this worker's own queue per lane, other workers steal from them when idle
+
+	// idle strategy: spin (retrying the queues) for up to m_spinMicroseconds, then park on the condition variable
+	std::atomic<bool> m_isParked = false;
+	std::mutex m_parkMutex;
+	std::condition_variable m_parkCondition;
+	bool m_wakeSignal = false;		// guarded by m_parkMutex
+	double m_spinMicroseconds = 0.0;	// adapted per worker, grows when parks are short and shrinks when they are long
+
+	// idle stats in microseconds since startup or the last reset, written by this worker only
+	std::atomic<long long> m_busyMicroseconds = 0;
+	std::atomic<long long> m_spinningMicroseconds = 0;
+	std::atomic<long long> m_parkedMicroseconds = 0;
+	std::atomic<int> m_parkCount = 0;
+	std::atomic<int> m_jobsExecuted = 0;
 };
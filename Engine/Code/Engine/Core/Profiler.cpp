@@ -0,0 +1,374 @@
+#include "Engine/Core/Profiler.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <cstring>
+
+// Every thread that opens a scope gets a ProfilerThread with a fixed array of nodes, one per distinct scope path.
+// Only the owning thread adds nodes or walks the child/sibling links. It publishes the node count with a release store
+// and adds to a node's frame totals with relaxed atomics. EndFrame reads nodes below the published count and swaps
+// the totals out, so the hot path takes no lock.
+
+namespace
+{
+	struct ProfileNode
+	{
+		char const* m_name = nullptr;
+		int m_parent = -1;
+		int m_firstChild = -1;		// owner thread only
+		int m_nextSibling = -1;		// owner thread only
+		std::atomic<long long> m_frameNanoseconds = 0;
+		std::atomic<int> m_frameCalls = 0;
+	};
+
+	struct ProfileHistory
+	{
+		float m_milliseconds[PROFILER_HISTORY_FRAMES] = {};
+		int m_calls[PROFILER_HISTORY_FRAMES] = {};
+	};
+
+	struct ProfilerThread
+	{
+		std::string m_name;
+		ProfileNode m_nodes[PROFILER_MAX_NODES_PER_THREAD];
+		std::atomic<int> m_nodeCount = 0;
+		std::atomic<bool> m_hasExited = false;
+		int m_currentNode = -1;		// innermost open scope, owner thread only
+		int m_firstRoot = -1;		// owner thread only
+		std::vector<ProfileHistory> m_history; // EndFrame only
+	};
+
+	std::mutex s_threadsMutex;
+	std::vector<ProfilerThread*> s_threads;
+	int s_frameCount = 0;
+
+	// flags the thread's tree when the thread ends, EndFrame frees it since it may be reading it right now
+	struct ProfilerThreadOwner
+	{
+		ProfilerThread* m_thread = nullptr;
+		~ProfilerThreadOwner()
+		{
+			if (m_thread)
+			{
+				m_thread->m_hasExited = true;
+			}
+		}
+	};
+	thread_local ProfilerThreadOwner t_profilerThread;
+
+	ProfilerThread* GetProfilerThread()
+	{
+		if (t_profilerThread.m_thread == nullptr)
+		{
+			ProfilerThread* thread = new ProfilerThread();
+			s_threadsMutex.lock();
+			thread->m_name = Stringf("thread %i", (int)s_threads.size());
+			s_threads.push_back(thread);
+			s_threadsMutex.unlock();
+			t_profilerThread.m_thread = thread;
+		}
+		return t_profilerThread.m_thread;
+	}
+
+	int FindOrAddNode(ProfilerThread* thread, char const* name)
+	{
+		int parent = thread->m_currentNode;
+		int first = parent >= 0 ? thread->m_nodes[parent].m_firstChild : thread->m_firstRoot;
+		int last = -1;
+		for (int index = first; index >= 0; index = thread->m_nodes[index].m_nextSibling)
+		{
+			ProfileNode const& node = thread->m_nodes[index];
+			if (node.m_name == name || strcmp(node.m_name, name) == 0)
+			{
+				return index;
+			}
+			last = index;
+		}
+
+		int count = thread->m_nodeCount.load(std::memory_order_relaxed);
+		if (count >= PROFILER_MAX_NODES_PER_THREAD)
+		{
+			return -1;
+		}
+		ProfileNode& node = thread->m_nodes[count];
+		node.m_name = name;
+		node.m_parent = parent;
+		if (last >= 0)
+		{
+			thread->m_nodes[last].m_nextSibling = count;
+		}
+		else if (parent >= 0)
+		{
+			thread->m_nodes[parent].m_firstChild = count;
+		}
+		else
+		{
+			thread->m_firstRoot = count;
+		}
+		thread->m_nodeCount.store(count + 1, std::memory_order_release);
+		return count;
+	}
+
+	// the history slots written so far, oldest first does not matter for these stats
+	int GetHistoryFrames()
+	{
+		return s_frameCount < PROFILER_HISTORY_FRAMES ? s_frameCount : PROFILER_HISTORY_FRAMES;
+	}
+
+	void CalculateStats(std::vector<float>& milliseconds, int totalCalls, ProfileScopeStats& out_stats)
+	{
+		out_stats = ProfileScopeStats();
+		out_stats.m_frames = (int)milliseconds.size();
+		if (milliseconds.empty())
+		{
+			return;
+		}
+		std::sort(milliseconds.begin(), milliseconds.end());
+		double total = 0.0;
+		for (int index = 0; index < (int)milliseconds.size(); index++)
+		{
+			total += milliseconds[index];
+		}
+		int last = (int)milliseconds.size() - 1;
+		out_stats.m_callsPerFrame = (float)totalCalls / (float)milliseconds.size();
+		out_stats.m_averageMilliseconds = total / (double)milliseconds.size();
+		out_stats.m_minMilliseconds = milliseconds[0];
+		out_stats.m_maxMilliseconds = milliseconds[last];
+		out_stats.m_p50Milliseconds = milliseconds[(int)(0.50 * last)];
+		out_stats.m_p95Milliseconds = milliseconds[(int)(0.95 * last)];
+		out_stats.m_p99Milliseconds = milliseconds[(int)(0.99 * last)];
+	}
+
+	void GatherNodeFrames(ProfilerThread const* thread, int node, std::vector<float>& out_milliseconds, int& out_calls)
+	{
+		ProfileHistory const& history = thread->m_history[node];
+		for (int slot = 0; slot < GetHistoryFrames(); slot++)
+		{
+			if (history.m_calls[slot] > 0)
+			{
+				out_milliseconds.push_back(history.m_milliseconds[slot]);
+				out_calls += history.m_calls[slot];
+			}
+		}
+	}
+
+	std::string GetNodePath(ProfilerThread const* thread, int node)
+	{
+		std::string path = thread->m_nodes[node].m_name;
+		for (int parent = thread->m_nodes[node].m_parent; parent >= 0; parent = thread->m_nodes[parent].m_parent)
+		{
+			path = std::string(thread->m_nodes[parent].m_name) + "/" + path;
+		}
+		return path;
+	}
+
+	void AddReportLines(ProfilerThread const* thread, int parent, int depth, std::vector<std::string>& out_lines)
+	{
+		int count = (int)thread->m_history.size();
+		for (int node = 0; node < count; node++)
+		{
+			if (thread->m_nodes[node].m_parent != parent)
+			{
+				continue;
+			}
+			std::vector<float> milliseconds;
+			int calls = 0;
+			GatherNodeFrames(thread, node, milliseconds, calls);
+			ProfileScopeStats stats;
+			CalculateStats(milliseconds, calls, stats);
+			std::string name = std::string(depth * 2, ' ') + thread->m_nodes[node].m_name;
+			out_lines.push_back(Stringf("%-44s %7.1f %8.3f %8.3f %8.3f %8.3f %6i", name.c_str(), stats.m_callsPerFrame, stats.m_averageMilliseconds,
+				stats.m_minMilliseconds, stats.m_maxMilliseconds, stats.m_p95Milliseconds, stats.m_frames));
+			AddReportLines(thread, node, depth + 1, out_lines);
+		}
+	}
+}
+
+//--------------------------------------------------------------------
+ProfileScope::ProfileScope(char const* name)
+{
+	ProfilerThread* thread = GetProfilerThread();
+	m_node = FindOrAddNode(thread, name);
+	if (m_node >= 0)
+	{
+		thread->m_currentNode = m_node;
+		m_startTime = GetCurrentTimeSeconds();
+	}
+}
+
+//--------------------------------------------------------------------
+ProfileScope::~ProfileScope()
+{
+	if (m_node < 0)
+	{
+		return;
+	}
+	double elapsed = GetCurrentTimeSeconds() - m_startTime;
+	ProfilerThread* thread = t_profilerThread.m_thread;
+	ProfileNode& node = thread->m_nodes[m_node];
+	node.m_frameNanoseconds.fetch_add((long long)(elapsed * 1000000000.0), std::memory_order_relaxed);
+	node.m_frameCalls.fetch_add(1, std::memory_order_relaxed);
+	thread->m_currentNode = node.m_parent;
+}
+
+//--------------------------------------------------------------------
+void Profiler::EndFrame()
+{
+	s_threadsMutex.lock();
+	int slot = s_frameCount % PROFILER_HISTORY_FRAMES;
+	for (int threadIndex = 0; threadIndex < (int)s_threads.size(); threadIndex++)
+	{
+		ProfilerThread* thread = s_threads[threadIndex];
+		int count = thread->m_nodeCount.load(std::memory_order_acquire);
+		if ((int)thread->m_history.size() < count)
+		{
+			thread->m_history.resize(count); // new scopes start with an empty history
+		}
+		for (int node = 0; node < count; node++)
+		{
+			long long nanoseconds = thread->m_nodes[node].m_frameNanoseconds.exchange(0, std::memory_order_relaxed);
+			thread->m_history[node].m_milliseconds[slot] = (float)((double)nanoseconds / 1000000.0);
+			thread->m_history[node].m_calls[slot] = thread->m_nodes[node].m_frameCalls.exchange(0, std::memory_order_relaxed);
+		}
+	}
+	// threads that have ended (job systems restarted by benchmarks) are gone for good
+	for (int threadIndex = 0; threadIndex < (int)s_threads.size(); threadIndex++)
+	{
+		if (s_threads[threadIndex]->m_hasExited)
+		{
+			delete s_threads[threadIndex];
+			s_threads.erase(s_threads.begin() + threadIndex);
+			threadIndex--;
+		}
+	}
+	s_frameCount++;
+	s_threadsMutex.unlock();
+}
+
+//--------------------------------------------------------------------
+void Profiler::Reset()
+{
+	s_threadsMutex.lock();
+	for (int threadIndex = 0; threadIndex < (int)s_threads.size(); threadIndex++)
+	{
+		ProfilerThread* thread = s_threads[threadIndex];
+		for (int node = 0; node < (int)thread->m_history.size(); node++)
+		{
+			thread->m_history[node] = ProfileHistory();
+		}
+	}
+	s_frameCount = 0;
+	s_threadsMutex.unlock();
+}
+
+//--------------------------------------------------------------------
+void Profiler::SetThreadName(std::string const& name)
+{
+	ProfilerThread* thread = GetProfilerThread();
+	s_threadsMutex.lock();
+	thread->m_name = name;
+	s_threadsMutex.unlock();
+}
+
+//--------------------------------------------------------------------
+int Profiler::GetFrameCount()
+{
+	return s_frameCount;
+}
+
+//--------------------------------------------------------------------
+bool Profiler::GetScopeStats(std::string const& path, ProfileScopeStats& out_stats)
+{
+	float frameMilliseconds[PROFILER_HISTORY_FRAMES] = {};
+	int frameCalls[PROFILER_HISTORY_FRAMES] = {};
+	bool isFound = false;
+	s_threadsMutex.lock();
+	for (int threadIndex = 0; threadIndex < (int)s_threads.size(); threadIndex++)
+	{
+		ProfilerThread const* thread = s_threads[threadIndex];
+		for (int node = 0; node < (int)thread->m_history.size(); node++)
+		{
+			if (GetNodePath(thread, node) != path)
+			{
+				continue;
+			}
+			isFound = true;
+			for (int slot = 0; slot < GetHistoryFrames(); slot++)
+			{
+				frameMilliseconds[slot] += thread->m_history[node].m_milliseconds[slot];
+				frameCalls[slot] += thread->m_history[node].m_calls[slot];
+			}
+		}
+	}
+	int historyFrames = GetHistoryFrames();
+	s_threadsMutex.unlock();
+
+	std::vector<float> milliseconds;
+	int calls = 0;
+	for (int slot = 0; slot < historyFrames; slot++)
+	{
+		if (frameCalls[slot] > 0)
+		{
+			milliseconds.push_back(frameMilliseconds[slot]);
+			calls += frameCalls[slot];
+		}
+	}
+	CalculateStats(milliseconds, calls, out_stats);
+	return isFound;
+}
+
+//--------------------------------------------------------------------
+void Profiler::GetReportLines(std::vector<std::string>& out_lines)
+{
+	s_threadsMutex.lock();
+	out_lines.push_back(Stringf("profile over the last %i frames, times are milliseconds per frame the scope ran", GetHistoryFrames()));
+	for (int threadIndex = 0; threadIndex < (int)s_threads.size(); threadIndex++)
+	{
+		ProfilerThread const* thread = s_threads[threadIndex];
+		if (thread->m_history.empty())
+		{
+			continue;
+		}
+		out_lines.push_back(Stringf("%-44s %7s %8s %8s %8s %8s %6s", thread->m_name.c_str(), "calls", "avg", "min", "max", "p95", "frames"));
+		AddReportLines(thread, -1, 1, out_lines);
+	}
+	s_threadsMutex.unlock();
+}
+
+//--------------------------------------------------------------------
+void Profiler::WriteReport(std::string const& filename)
+{
+	std::vector<std::string> lines;
+	GetReportLines(lines);
+	std::string text;
+	for (int index = 0; index < (int)lines.size(); index++)
+	{
+		text += lines[index] + "\n";
+	}
+	std::vector<uint8_t> buffer(text.begin(), text.end());
+	FileWriteBinaryBuffer(buffer, filename);
+}
+
+//--------------------------------------------------------------------
+bool Command_Profile(EventArgs& args)
+{
+	std::vector<std::string> lines;
+	Profiler::GetReportLines(lines);
+	for (int index = 0; index < (int)lines.size(); index++)
+	{
+		g_theConsole->AddLine(index == 0 ? DevConsole::TINT_INFO_MAJOR : DevConsole::TINT_INFO_MINOR, lines[index]);
+	}
+	std::string filename = args.GetValue("file", "");
+	if (!filename.empty())
+	{
+		Profiler::WriteReport(filename);
+		g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, Stringf("profile written to %s", filename.c_str()));
+	}
+	if (args.GetValue("reset", false))
+	{
+		Profiler::Reset();
+	}
+	return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include <string>
+#include <vector>
+
+constexpr int PROFILER_MAX_NODES_PER_THREAD = 512;	// distinct scope paths per thread, deeper or wider trees are not recorded
+constexpr int PROFILER_HISTORY_FRAMES = 128;		// min/avg/max/percentiles are over this many frames
+
+// PROFILE_SCOPE("World::Update") times the rest of the enclosing block as a child of whatever scope is open on the same thread,
+// so each thread builds its own call tree. Profiler::EndFrame (main thread, once per frame) folds every thread's totals
+// into a rolling history. Nothing here needs a window or a console, so headless runs can query or write the results.
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+class ProfileScope
+{
+public:
+	explicit ProfileScope(char const* name); // name must outlive the program, normally a string literal
+	~ProfileScope();
+	ProfileScope(const ProfileScope& copy) = delete;
+
+private:
+	int m_node = -1;
+	double m_startTime = 0.0;
+};
+
+// per frame numbers over the frames in the history that ran the scope at least once
+struct ProfileScopeStats
+{
+	int m_frames = 0;
+	float m_callsPerFrame = 0.0f;
+	double m_averageMilliseconds = 0.0;
+	double m_minMilliseconds = 0.0;
+	double m_maxMilliseconds = 0.0;
+	double m_p50Milliseconds = 0.0;
+	double m_p95Milliseconds = 0.0;
+	double m_p99Milliseconds = 0.0;
+};
+
+class Profiler
+{
+public:
+	static void EndFrame();
+	static void Reset(); // clears the history, the scope trees stay
+	static void SetThreadName(std::string const& name); // names the calling thread in reports
+	static int GetFrameCount();
+
+	// path is the scope names from the root joined with '/', e.g. "World::Update/World::ProcessDirtyLighting",
+	// the same path on several threads is added up frame by frame
+	static bool GetScopeStats(std::string const& path, ProfileScopeStats& out_stats);
+	static void GetReportLines(std::vector<std::string>& out_lines);
+	static void WriteReport(std::string const& filename);
+};
+
+// console command: profile file=<path> reset=<true|false>
+// prints the per thread scope trees, optionally writes them to a file
+bool Command_Profile(EventArgs& args);
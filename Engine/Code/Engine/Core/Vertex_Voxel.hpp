@@ -0,0 +1,26 @@
+#pragma once
+#include "Engine/Core/Rgba8.hpp"
+#include <stdint.h>
+
+
+//------------------------------------------------------------------------------------------------
+// 8 byte vertex for block geometry, a third of a Vertex_PCU, positions are whole block corners relative to the
+// model matrix (up to 255) and the face index (+z, -y, +x, +y, -x, -z) lets the shader rebuild the texture coordinates
+// the Renderer uses this layout for shaders with "Voxel" in their name
+struct Vertex_Voxel
+{
+	Vertex_Voxel() = default;
+	Vertex_Voxel( uint8_t x, uint8_t y, uint8_t z, uint8_t face, Rgba8 const& color )
+		: m_x( x )
+		, m_y( y )
+		, m_z( z )
+		, m_face( face )
+		, m_color( color )
+	{}
+
+	uint8_t	m_x = 0;
+	uint8_t	m_y = 0;
+	uint8_t	m_z = 0;
+	uint8_t	m_face = 0;
+	Rgba8	m_color;	// meaning is up to the shader, the chunk shader takes outdoor and indoor light, sprite column and row
+};
@@ -0,0 +1,49 @@
+#include "Engine/Math/RandomSequence.hpp"
+#include "ThirdParty/Squirrel/RawNoise.hpp"
+#include <stdint.h>
+
+RandomSequence::RandomSequence(unsigned int seed, int position)
+	: m_seed(seed), m_position(position)
+{
+}
+
+unsigned int RandomSequence::GetUintAt(unsigned int seed, int position)
+{
+	return Get1dNoiseUint(position, seed);
+}
+
+unsigned int RandomSequence::MakeSeed(unsigned int baseSeed, int x, int y, int purpose)
+{
+	return Get3dNoiseUint(x, y, purpose, baseSeed);
+}
+
+unsigned int RandomSequence::RollRandomUint()
+{
+	return GetUintAt(m_seed, m_position++);
+}
+
+int RandomSequence::RollRandomIntLessThan(int maxNotInclusive)
+{
+	// scale the 32 bits into the range instead of taking a remainder, which favors the low values
+	return (int)(((uint64_t)RollRandomUint() * (uint64_t)maxNotInclusive) >> 32);
+}
+
+int RandomSequence::RollRandomIntInRange(int minInclusive, int maxInclusive)
+{
+	return minInclusive + RollRandomIntLessThan(maxInclusive + 1 - minInclusive); // one more to be inclusive
+}
+
+float RandomSequence::RollRandomFloatZeroToOne()
+{
+	return (float)(RollRandomUint() >> 8) * (1.0f / 16777216.0f);
+}
+
+float RandomSequence::RollRandomFloatInRange(float minInclusive, float maxInclusive)
+{
+	return minInclusive + RollRandomFloatZeroToOne() * (maxInclusive - minInclusive);
+}
+
+float RandomSequence::RollRandomFloatInRange(FloatRange range)
+{
+	return RollRandomFloatInRange(range.m_min, range.m_max);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "FloatRange.hpp"
+
+// counter-based random numbers: roll n of a sequence is the SquirrelNoise5 hash of (n, seed), so there is no shared
+// state to race on and any roll can be reproduced from its seed and position alone
+// derive one seed per owner and purpose (e.g. a block column and "ores") and give each thread its own sequences
+class RandomSequence
+{
+public:
+	explicit RandomSequence(unsigned int seed, int position = 0);
+
+	static unsigned int GetUintAt(unsigned int seed, int position);
+	static unsigned int MakeSeed(unsigned int baseSeed, int x, int y, int purpose); // one seed per 2D key and purpose
+
+	unsigned int RollRandomUint();
+	int RollRandomIntLessThan(int maxNotInclusive);
+	int RollRandomIntInRange(int minInclusive, int maxInclusive);
+	float RollRandomFloatZeroToOne(); // [0,1), 24 bits
+	float RollRandomFloatInRange(float minInclusive, float maxInclusive);
+	float RollRandomFloatInRange(FloatRange range);
+
+	unsigned int GetSeed() const { return m_seed; }
+	int GetPosition() const { return m_position; }
+	void SetPosition(int position) { m_position = position; }
+
+private:
+	unsigned int m_seed = 0;
+	int m_position = 0;
+};
@@ -599,6 +599,12 @@ Shader* Renderer::CreateShader(char const* shaderName, char const* shaderSource)
 		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 	};
 
+	D3D11_INPUT_ELEMENT_DESC inputElementVoxelDesc[] =
+	{
+		{ "POSITION", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	};
+
 	std::vector<unsigned char> vertexCode;
 	std::vector<unsigned char> pixelCode;
 
@@ -615,6 +621,10 @@ Shader* Renderer::CreateShader(char const* shaderName, char const* shaderSource)
 	{
 		hr = m_device->CreateInputLayout(inputElementLitDesc, 4, vertexCode.data(), vertexCode.size(), &inputLayout);
 	}
+	else if (strstr(shaderName, "Voxel"))
+	{
+		hr = m_device->CreateInputLayout(inputElementVoxelDesc, 2, vertexCode.data(), vertexCode.size(), &inputLayout);
+	}
 	else
 	{
 		hr = m_device->CreateInputLayout(inputElementDesc, 3, vertexCode.data(), vertexCode.size(), &inputLayout);
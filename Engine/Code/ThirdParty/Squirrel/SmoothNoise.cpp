@@ -1,6 +1,7 @@
 //-----------------------------------------------------------------------------------------------
 // SmoothNoise.cpp
 //
+#include "ThirdParty/Squirrel/SmoothNoise.hpp"
 #include "ThirdParty/Squirrel/RawNoise.hpp"			// for raw bit-noise base functions (SquirrelNoise4)
 #include "Engine/Math/MathUtils.hpp"		// for SmoothStep3(); see "SmoothStep" on Wikipedia
 #include "Engine/Math/Vec4.hpp"				// for Vec4( float x,y,z,w ) class/struct
@@ -8,6 +9,12 @@
 #include "Engine/Math/Vec2.hpp"				// for Vec2( float x,y ) class/struct
 #include <math.h>
 #include "Engine/Math/Easing.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#if defined(__AVX2__)
+#include <immintrin.h>			// 8 lane batched Perlin noise
+#else
+#include <emmintrin.h>			// 4 lane (SSE2) batched Perlin noise
+#endif
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -745,3 +752,516 @@ float Compute4dPerlinNoise( float posX, float posY, float posZ, float posT, floa
 	return totalNoise;
 }
 
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Batched 2D Perlin noise
+//
+// The kernel below is Compute2dPerlinNoise rewritten over SIMD lanes, operation for operation in
+//	the same order (including the de Casteljau steps inside SmoothStep3), so each lane rounds
+//	exactly like the scalar version.  Gradients are selected with bit logic instead of a table
+//	lookup: bit 0 ^ bit 1 of the hash picks which axis gets the long component and bits 1-2 pick
+//	the signs, which reproduces the 8 entries of the scalar gradient table.
+//
+// SSE2 (4 lanes) is always available on x64; building with /arch:AVX2 switches to 8 lanes.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+
+#if defined(__AVX2__)
+
+typedef __m256 NoiseFloats;
+typedef __m256i NoiseInts;
+constexpr int NOISE_LANES = 8;
+
+inline NoiseFloats SetFloats( float value )								{ return _mm256_set1_ps( value ); }
+inline NoiseInts SetInts( int value )									{ return _mm256_set1_epi32( value ); }
+inline NoiseInts LaneIndexes()											{ return _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ); }
+inline NoiseFloats LoadFloats( float const* source )					{ return _mm256_loadu_ps( source ); }
+inline NoiseInts LoadInts( int const* source )							{ return _mm256_loadu_si256( (__m256i const*) source ); }
+inline void StoreFloats( float* destination, NoiseFloats value )		{ _mm256_storeu_ps( destination, value ); }
+inline void StoreInts( unsigned int* destination, NoiseInts value )		{ _mm256_storeu_si256( (__m256i*) destination, value ); }
+inline NoiseFloats Add( NoiseFloats a, NoiseFloats b )					{ return _mm256_add_ps( a, b ); }
+inline NoiseFloats Subtract( NoiseFloats a, NoiseFloats b )				{ return _mm256_sub_ps( a, b ); }
+inline NoiseFloats Multiply( NoiseFloats a, NoiseFloats b )				{ return _mm256_mul_ps( a, b ); }
+inline NoiseFloats Divide( NoiseFloats a, NoiseFloats b )				{ return _mm256_div_ps( a, b ); }
+inline NoiseFloats Floor( NoiseFloats a )								{ return _mm256_round_ps( a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC ); }
+inline NoiseInts TruncateToInts( NoiseFloats a )						{ return _mm256_cvttps_epi32( a ); }
+inline NoiseFloats ToFloats( NoiseInts a )								{ return _mm256_cvtepi32_ps( a ); }
+inline NoiseFloats SelectFloats( NoiseInts mask, NoiseFloats ifSet, NoiseFloats ifClear ) { return _mm256_blendv_ps( ifClear, ifSet, _mm256_castsi256_ps( mask ) ); }
+inline NoiseFloats FlipSigns( NoiseFloats a, NoiseInts signBits )		{ return _mm256_xor_ps( a, _mm256_castsi256_ps( signBits ) ); }
+inline NoiseInts AddInts( NoiseInts a, NoiseInts b )					{ return _mm256_add_epi32( a, b ); }
+inline NoiseInts MultiplyInts( NoiseInts a, NoiseInts b )				{ return _mm256_mullo_epi32( a, b ); }
+inline NoiseInts XorInts( NoiseInts a, NoiseInts b )					{ return _mm256_xor_si256( a, b ); }
+inline NoiseInts AndInts( NoiseInts a, NoiseInts b )					{ return _mm256_and_si256( a, b ); }
+inline NoiseInts EqualInts( NoiseInts a, NoiseInts b )					{ return _mm256_cmpeq_epi32( a, b ); }
+inline NoiseInts GreaterFloats( NoiseFloats a, NoiseFloats b )			{ return _mm256_castps_si256( _mm256_cmp_ps( a, b, _CMP_GT_OQ ) ); }
+template <int BITS> inline NoiseInts ShiftRight( NoiseInts a )			{ return _mm256_srli_epi32( a, BITS ); }
+template <int BITS> inline NoiseInts ShiftLeft( NoiseInts a )			{ return _mm256_slli_epi32( a, BITS ); }
+
+#else
+
+typedef __m128 NoiseFloats;
+typedef __m128i NoiseInts;
+constexpr int NOISE_LANES = 4;
+
+inline NoiseFloats SetFloats( float value )								{ return _mm_set1_ps( value ); }
+inline NoiseInts SetInts( int value )									{ return _mm_set1_epi32( value ); }
+inline NoiseInts LaneIndexes()											{ return _mm_setr_epi32( 0, 1, 2, 3 ); }
+inline NoiseFloats LoadFloats( float const* source )					{ return _mm_loadu_ps( source ); }
+inline NoiseInts LoadInts( int const* source )							{ return _mm_loadu_si128( (__m128i const*) source ); }
+inline void StoreFloats( float* destination, NoiseFloats value )		{ _mm_storeu_ps( destination, value ); }
+inline void StoreInts( unsigned int* destination, NoiseInts value )		{ _mm_storeu_si128( (__m128i*) destination, value ); }
+inline NoiseFloats Add( NoiseFloats a, NoiseFloats b )					{ return _mm_add_ps( a, b ); }
+inline NoiseFloats Subtract( NoiseFloats a, NoiseFloats b )				{ return _mm_sub_ps( a, b ); }
+inline NoiseFloats Multiply( NoiseFloats a, NoiseFloats b )				{ return _mm_mul_ps( a, b ); }
+inline NoiseFloats Divide( NoiseFloats a, NoiseFloats b )				{ return _mm_div_ps( a, b ); }
+inline NoiseInts TruncateToInts( NoiseFloats a )						{ return _mm_cvttps_epi32( a ); }
+inline NoiseFloats ToFloats( NoiseInts a )								{ return _mm_cvtepi32_ps( a ); }
+inline NoiseFloats SelectFloats( NoiseInts mask, NoiseFloats ifSet, NoiseFloats ifClear ) { return _mm_or_ps( _mm_and_ps( _mm_castsi128_ps( mask ), ifSet ), _mm_andnot_ps( _mm_castsi128_ps( mask ), ifClear ) ); }
+inline NoiseFloats FlipSigns( NoiseFloats a, NoiseInts signBits )		{ return _mm_xor_ps( a, _mm_castsi128_ps( signBits ) ); }
+inline NoiseInts AddInts( NoiseInts a, NoiseInts b )					{ return _mm_add_epi32( a, b ); }
+inline NoiseInts XorInts( NoiseInts a, NoiseInts b )					{ return _mm_xor_si128( a, b ); }
+inline NoiseInts AndInts( NoiseInts a, NoiseInts b )					{ return _mm_and_si128( a, b ); }
+inline NoiseInts EqualInts( NoiseInts a, NoiseInts b )					{ return _mm_cmpeq_epi32( a, b ); }
+inline NoiseInts GreaterFloats( NoiseFloats a, NoiseFloats b )			{ return _mm_castps_si128( _mm_cmpgt_ps( a, b ) ); }
+template <int BITS> inline NoiseInts ShiftRight( NoiseInts a )			{ return _mm_srli_epi32( a, BITS ); }
+template <int BITS> inline NoiseInts ShiftLeft( NoiseInts a )			{ return _mm_slli_epi32( a, BITS ); }
+
+// SSE2 has no floor; truncate, then step down where truncation rounded a negative value up (exact for |a| < 2^31)
+inline NoiseFloats Floor( NoiseFloats a )
+{
+	NoiseFloats truncated = _mm_cvtepi32_ps( _mm_cvttps_epi32( a ) );
+	return _mm_sub_ps( truncated, _mm_and_ps( _mm_cmpgt_ps( truncated, a ), _mm_set1_ps( 1.f ) ) );
+}
+
+// SSE2 has no 32-bit low multiply; multiply the even and odd lanes as 64-bit products and keep the low halves
+inline NoiseInts MultiplyInts( NoiseInts a, NoiseInts b )
+{
+	NoiseInts evenProducts = _mm_mul_epu32( a, b );
+	NoiseInts oddProducts = _mm_mul_epu32( _mm_srli_si128( a, 4 ), _mm_srli_si128( b, 4 ) );
+	return _mm_unpacklo_epi32( _mm_shuffle_epi32( evenProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( oddProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+}
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// SquirrelNoise5 and Get2dNoiseUint (see RawNoise.hpp) across lanes
+//
+// Split at the seed so fused fields sharing a lattice corner can hash it once: the first half
+//	does not depend on the seed, the second half finishes SquirrelNoise5 for one seed.
+//
+inline NoiseInts Get2dNoiseUnseededLanes( NoiseInts indexX, NoiseInts indexY )
+{
+	NoiseInts mangledBits = AddInts( indexX, MultiplyInts( SetInts( 198491317 ), indexY ) );
+	return MultiplyInts( mangledBits, SetInts( (int) 0xd2a80a3f ) );
+}
+
+inline NoiseInts FinishNoiseUintLanes( NoiseInts unseededBits, unsigned int seed )
+{
+	NoiseInts mangledBits = AddInts( unseededBits, SetInts( (int) seed ) );
+	mangledBits = XorInts( mangledBits, ShiftRight<9>( mangledBits ) );
+	mangledBits = AddInts( mangledBits, SetInts( (int) 0xa884f197 ) );
+	mangledBits = XorInts( mangledBits, ShiftRight<11>( mangledBits ) );
+	mangledBits = MultiplyInts( mangledBits, SetInts( (int) 0x6C736F4B ) );
+	mangledBits = XorInts( mangledBits, ShiftRight<13>( mangledBits ) );
+	mangledBits = AddInts( mangledBits, SetInts( (int) 0xB79F3ABB ) );
+	mangledBits = XorInts( mangledBits, ShiftRight<15>( mangledBits ) );
+	mangledBits = MultiplyInts( mangledBits, SetInts( (int) 0x1b56c4f5 ) );
+	mangledBits = XorInts( mangledBits, ShiftRight<17>( mangledBits ) );
+	return mangledBits;
+}
+
+inline NoiseInts Get2dNoiseUintLanes( NoiseInts indexX, NoiseInts indexY, unsigned int seed )
+{
+	return FinishNoiseUintLanes( Get2dNoiseUnseededLanes( indexX, indexY ), seed );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Mirrors SmoothStep3() -> ComputeCubicBezier1D( 0, 0, 1, 1, t ) -> Interpolate() step by step
+//
+inline NoiseFloats SmoothStep3Lanes( NoiseFloats t )
+{
+	NoiseFloats zero = SetFloats( 0.f );
+	NoiseFloats one = SetFloats( 1.f );
+	NoiseFloats s = Subtract( one, t );
+	NoiseFloats AB = Add( Multiply( s, zero ), Multiply( t, zero ) );
+	NoiseFloats BC = Add( Multiply( s, zero ), Multiply( t, one ) );
+	NoiseFloats CD = Add( Multiply( s, one ), Multiply( t, one ) );
+	NoiseFloats ABC = Add( Multiply( s, AB ), Multiply( t, BC ) );
+	NoiseFloats BCD = Add( Multiply( s, BC ), Multiply( t, CD ) );
+	return Add( Multiply( s, ABC ), Multiply( t, BCD ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Dot product of the hash's gradient (one of 8 unit vectors, 22.5 + 45n degrees) with a displacement
+//
+inline NoiseFloats DotGradientLanes( NoiseInts noise, NoiseFloats displacementX, NoiseFloats displacementY )
+{
+	NoiseInts one = SetInts( 1 );
+	NoiseInts direction = AndInts( noise, SetInts( 7 ) );
+	NoiseInts isLongX = EqualInts( AndInts( XorInts( direction, ShiftRight<1>( direction ) ), one ), SetInts( 0 ) ); // directions 0, 3, 4, 7
+	NoiseFloats longSide = SetFloats( 0.923879533f );
+	NoiseFloats shortSide = SetFloats( 0.382683432f );
+	NoiseFloats gradientX = SelectFloats( isLongX, longSide, shortSide );
+	NoiseFloats gradientY = SelectFloats( isLongX, shortSide, longSide );
+	gradientX = FlipSigns( gradientX, ShiftLeft<31>( ShiftRight<2>( AddInts( direction, SetInts( 2 ) ) ) ) ); // west for directions 2-5
+	gradientY = FlipSigns( gradientY, ShiftLeft<31>( ShiftRight<2>( direction ) ) ); // south for directions 4-7
+	return Add( Multiply( gradientX, displacementX ), Multiply( gradientY, displacementY ) );
+}
+
+
+//-----------------------------------------------------------------------------------------------
+inline NoiseFloats Compute2dPerlinNoiseLanes( NoiseFloats posX, NoiseFloats posY, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+{
+	const float OCTAVE_OFFSET = 0.636764989593174f; // Translation/bias to add to each octave
+	NoiseFloats one = SetFloats( 1.f );
+
+	NoiseFloats totalNoise = SetFloats( 0.f );
+	float totalAmplitude = 0.f;
+	float currentAmplitude = 1.f;
+	float invScale = (1.f / scale);
+	NoiseFloats currentX = Multiply( posX, SetFloats( invScale ) );
+	NoiseFloats currentY = Multiply( posY, SetFloats( invScale ) );
+
+	for( unsigned int octaveNum = 0; octaveNum < numOctaves; ++ octaveNum )
+	{
+		NoiseFloats cellMinsX = Floor( currentX );
+		NoiseFloats cellMinsY = Floor( currentY );
+		NoiseFloats cellMaxsX = Add( cellMinsX, one );
+		NoiseFloats cellMaxsY = Add( cellMinsY, one );
+		NoiseInts indexWestX = TruncateToInts( cellMinsX );
+		NoiseInts indexSouthY = TruncateToInts( cellMinsY );
+		NoiseInts indexEastX = AddInts( indexWestX, SetInts( 1 ) );
+		NoiseInts indexNorthY = AddInts( indexSouthY, SetInts( 1 ) );
+
+		NoiseInts noiseSW = Get2dNoiseUintLanes( indexWestX, indexSouthY, seed );
+		NoiseInts noiseSE = Get2dNoiseUintLanes( indexEastX, indexSouthY, seed );
+		NoiseInts noiseNW = Get2dNoiseUintLanes( indexWestX, indexNorthY, seed );
+		NoiseInts noiseNE = Get2dNoiseUintLanes( indexEastX, indexNorthY, seed );
+
+		NoiseFloats displacementWest = Subtract( currentX, cellMinsX );
+		NoiseFloats displacementEast = Subtract( currentX, cellMaxsX );
+		NoiseFloats displacementSouth = Subtract( currentY, cellMinsY );
+		NoiseFloats displacementNorth = Subtract( currentY, cellMaxsY );
+
+		NoiseFloats dotSouthWest = DotGradientLanes( noiseSW, displacementWest, displacementSouth );
+		NoiseFloats dotSouthEast = DotGradientLanes( noiseSE, displacementEast, displacementSouth );
+		NoiseFloats dotNorthWest = DotGradientLanes( noiseNW, displacementWest, displacementNorth );
+		NoiseFloats dotNorthEast = DotGradientLanes( noiseNE, displacementEast, displacementNorth );
+
+		NoiseFloats weightEast = SmoothStep3Lanes( displacementWest );
+		NoiseFloats weightNorth = SmoothStep3Lanes( displacementSouth );
+		NoiseFloats weightWest = Subtract( one, weightEast );
+		NoiseFloats weightSouth = Subtract( one, weightNorth );
+
+		NoiseFloats blendSouth = Add( Multiply( weightEast, dotSouthEast ), Multiply( weightWest, dotSouthWest ) );
+		NoiseFloats blendNorth = Add( Multiply( weightEast, dotNorthEast ), Multiply( weightWest, dotNorthWest ) );
+		NoiseFloats blendTotal = Add( Multiply( weightSouth, blendSouth ), Multiply( weightNorth, blendNorth ) );
+		NoiseFloats noiseThisOctave = Multiply( blendTotal, SetFloats( 1.f / 0.662578106f ) );
+
+		totalNoise = Add( totalNoise, Multiply( noiseThisOctave, SetFloats( currentAmplitude ) ) );
+		totalAmplitude += currentAmplitude;
+		currentAmplitude *= octavePersistence;
+		currentX = Add( Multiply( currentX, SetFloats( octaveScale ) ), SetFloats( OCTAVE_OFFSET ) );
+		currentY = Add( Multiply( currentY, SetFloats( octaveScale ) ), SetFloats( OCTAVE_OFFSET ) );
+		++ seed;
+	}
+
+	if( renormalize && totalAmplitude > 0.f )
+	{
+		totalNoise = Divide( totalNoise, SetFloats( totalAmplitude ) );
+		totalNoise = Add( Multiply( totalNoise, SetFloats( 0.5f ) ), SetFloats( 0.5f ) );
+		totalNoise = SmoothStep3Lanes( totalNoise );
+		totalNoise = Subtract( Multiply( totalNoise, SetFloats( 2.0f ) ), one );
+	}
+
+	return totalNoise;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Fields of a bundle with the same scale and octaveScale land on the same lattice every octave
+//
+struct NoiseBundleGroup
+{
+	float			m_scale = 1.f;
+	float			m_octaveScale = 2.f;
+	unsigned int	m_maxOctaves = 0;
+	int				m_fieldCount = 0;
+	int				m_fields[ NOISE_BUNDLE_MAX_FIELDS ];
+};
+
+
+//-----------------------------------------------------------------------------------------------
+// A partial group of lanes repeats its last valid value in the unused lanes
+//
+inline NoiseFloats LoadPartialFloats( float const* source, int validLanes )
+{
+	if( validLanes == NOISE_LANES )
+		return LoadFloats( source );
+
+	float lanes[ NOISE_LANES ];
+	for( int lane = 0; lane < NOISE_LANES; ++ lane )
+	{
+		lanes[ lane ] = source[ (lane < validLanes) ? lane : validLanes - 1 ];
+	}
+	return LoadFloats( lanes );
+}
+
+inline void StorePartialFloats( float* destination, NoiseFloats value, int validLanes )
+{
+	if( validLanes == NOISE_LANES )
+	{
+		StoreFloats( destination, value );
+		return;
+	}
+
+	float lanes[ NOISE_LANES ];
+	StoreFloats( lanes, value );
+	for( int lane = 0; lane < validLanes; ++ lane )
+	{
+		destination[ lane ] = lanes[ lane ];
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Compute2dPerlinNoiseLanes() for every field of a group at once; amplitudes are kept per lane
+//	so a field's persistence can come from another field's output
+//
+inline void Compute2dPerlinNoiseGroupLanes( NoiseBundleField const* fields, NoiseBundleGroup const& group, NoiseFloats posX, NoiseFloats posY, int outputIndex, int validLanes )
+{
+	const float OCTAVE_OFFSET = 0.636764989593174f; // Translation/bias to add to each octave
+	NoiseFloats zero = SetFloats( 0.f );
+	NoiseFloats one = SetFloats( 1.f );
+
+	NoiseFloats totalNoise[ NOISE_BUNDLE_MAX_FIELDS ];
+	NoiseFloats totalAmplitude[ NOISE_BUNDLE_MAX_FIELDS ];
+	NoiseFloats currentAmplitude[ NOISE_BUNDLE_MAX_FIELDS ];
+	NoiseFloats octavePersistence[ NOISE_BUNDLE_MAX_FIELDS ];
+	for( int member = 0; member < group.m_fieldCount; ++ member )
+	{
+		NoiseBundleField const& field = fields[ group.m_fields[ member ] ];
+		totalNoise[ member ] = zero;
+		totalAmplitude[ member ] = zero;
+		currentAmplitude[ member ] = one;
+		if( field.m_persistenceField >= 0 )
+			octavePersistence[ member ] = LoadPartialFloats( fields[ field.m_persistenceField ].m_output + outputIndex, validLanes );
+		else
+			octavePersistence[ member ] = SetFloats( field.m_octavePersistence );
+	}
+
+	float invScale = (1.f / group.m_scale);
+	NoiseFloats currentX = Multiply( posX, SetFloats( invScale ) );
+	NoiseFloats currentY = Multiply( posY, SetFloats( invScale ) );
+
+	for( unsigned int octaveNum = 0; octaveNum < group.m_maxOctaves; ++ octaveNum )
+	{
+		NoiseFloats cellMinsX = Floor( currentX );
+		NoiseFloats cellMinsY = Floor( currentY );
+		NoiseFloats cellMaxsX = Add( cellMinsX, one );
+		NoiseFloats cellMaxsY = Add( cellMinsY, one );
+		NoiseInts indexWestX = TruncateToInts( cellMinsX );
+		NoiseInts indexSouthY = TruncateToInts( cellMinsY );
+		NoiseInts indexEastX = AddInts( indexWestX, SetInts( 1 ) );
+		NoiseInts indexNorthY = AddInts( indexSouthY, SetInts( 1 ) );
+
+		NoiseInts unseededSW = Get2dNoiseUnseededLanes( indexWestX, indexSouthY );
+		NoiseInts unseededSE = Get2dNoiseUnseededLanes( indexEastX, indexSouthY );
+		NoiseInts unseededNW = Get2dNoiseUnseededLanes( indexWestX, indexNorthY );
+		NoiseInts unseededNE = Get2dNoiseUnseededLanes( indexEastX, indexNorthY );
+
+		NoiseFloats displacementWest = Subtract( currentX, cellMinsX );
+		NoiseFloats displacementEast = Subtract( currentX, cellMaxsX );
+		NoiseFloats displacementSouth = Subtract( currentY, cellMinsY );
+		NoiseFloats displacementNorth = Subtract( currentY, cellMaxsY );
+
+		NoiseFloats weightEast = SmoothStep3Lanes( displacementWest );
+		NoiseFloats weightNorth = SmoothStep3Lanes( displacementSouth );
+		NoiseFloats weightWest = Subtract( one, weightEast );
+		NoiseFloats weightSouth = Subtract( one, weightNorth );
+
+		for( int member = 0; member < group.m_fieldCount; ++ member )
+		{
+			NoiseBundleField const& field = fields[ group.m_fields[ member ] ];
+			if( octaveNum >= field.m_numOctaves )
+				continue;
+
+			unsigned int seed = field.m_seed + octaveNum;
+			NoiseFloats dotSouthWest = DotGradientLanes( FinishNoiseUintLanes( unseededSW, seed ), displacementWest, displacementSouth );
+			NoiseFloats dotSouthEast = DotGradientLanes( FinishNoiseUintLanes( unseededSE, seed ), displacementEast, displacementSouth );
+			NoiseFloats dotNorthWest = DotGradientLanes( FinishNoiseUintLanes( unseededNW, seed ), displacementWest, displacementNorth );
+			NoiseFloats dotNorthEast = DotGradientLanes( FinishNoiseUintLanes( unseededNE, seed ), displacementEast, displacementNorth );
+
+			NoiseFloats blendSouth = Add( Multiply( weightEast, dotSouthEast ), Multiply( weightWest, dotSouthWest ) );
+			NoiseFloats blendNorth = Add( Multiply( weightEast, dotNorthEast ), Multiply( weightWest, dotNorthWest ) );
+			NoiseFloats blendTotal = Add( Multiply( weightSouth, blendSouth ), Multiply( weightNorth, blendNorth ) );
+			NoiseFloats noiseThisOctave = Multiply( blendTotal, SetFloats( 1.f / 0.662578106f ) );
+
+			totalNoise[ member ] = Add( totalNoise[ member ], Multiply( noiseThisOctave, currentAmplitude[ member ] ) );
+			totalAmplitude[ member ] = Add( totalAmplitude[ member ], currentAmplitude[ member ] );
+			currentAmplitude[ member ] = Multiply( currentAmplitude[ member ], octavePersistence[ member ] );
+		}
+
+		currentX = Add( Multiply( currentX, SetFloats( group.m_octaveScale ) ), SetFloats( OCTAVE_OFFSET ) );
+		currentY = Add( Multiply( currentY, SetFloats( group.m_octaveScale ) ), SetFloats( OCTAVE_OFFSET ) );
+	}
+
+	for( int member = 0; member < group.m_fieldCount; ++ member )
+	{
+		NoiseBundleField const& field = fields[ group.m_fields[ member ] ];
+		NoiseFloats noise = totalNoise[ member ];
+		if( field.m_renormalize )
+		{
+			NoiseFloats renormalized = Divide( noise, totalAmplitude[ member ] );
+			renormalized = Add( Multiply( renormalized, SetFloats( 0.5f ) ), SetFloats( 0.5f ) );
+			renormalized = SmoothStep3Lanes( renormalized );
+			renormalized = Subtract( Multiply( renormalized, SetFloats( 2.0f ) ), one );
+			noise = SelectFloats( GreaterFloats( totalAmplitude[ member ], zero ), renormalized, noise );
+		}
+		noise = Add( SetFloats( field.m_outputBias ), Multiply( SetFloats( field.m_outputMultiplier ), noise ) );
+		StorePartialFloats( field.m_output + outputIndex, noise, validLanes );
+	}
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------------------------
+int GetNoiseBatchLanes()
+{
+	return NOISE_LANES;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Get2dNoiseUintBatch( unsigned int* out_noise, int const* indexX, int const* indexY, int count, unsigned int seed )
+{
+	int index = 0;
+	for( ; index + NOISE_LANES <= count; index += NOISE_LANES )
+	{
+		StoreInts( out_noise + index, Get2dNoiseUintLanes( LoadInts( indexX + index ), LoadInts( indexY + index ), seed ) );
+	}
+	for( ; index < count; ++ index )
+	{
+		out_noise[ index ] = Get2dNoiseUint( indexX[ index ], indexY[ index ], seed );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The last partial group repeats its final sample in the unused lanes and copies out only the valid ones
+//
+void Compute2dPerlinNoiseBatch( float* out_noise, float const* posX, float const* posY, int count, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+{
+	int index = 0;
+	for( ; index + NOISE_LANES <= count; index += NOISE_LANES )
+	{
+		StoreFloats( out_noise + index, Compute2dPerlinNoiseLanes( LoadFloats( posX + index ), LoadFloats( posY + index ), scale, numOctaves, octavePersistence, octaveScale, renormalize, seed ) );
+	}
+	if( index < count )
+	{
+		float tailX[ NOISE_LANES ];
+		float tailY[ NOISE_LANES ];
+		float tailNoise[ NOISE_LANES ];
+		for( int lane = 0; lane < NOISE_LANES; ++ lane )
+		{
+			int source = (index + lane < count) ? index + lane : count - 1;
+			tailX[ lane ] = posX[ source ];
+			tailY[ lane ] = posY[ source ];
+		}
+		StoreFloats( tailNoise, Compute2dPerlinNoiseLanes( LoadFloats( tailX ), LoadFloats( tailY ), scale, numOctaves, octavePersistence, octaveScale, renormalize, seed ) );
+		for( int lane = 0; index + lane < count; ++ lane )
+		{
+			out_noise[ index + lane ] = tailNoise[ lane ];
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Compute2dPerlinNoiseRow( float* out_noise, int count, float startX, float posY, float stepX, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+{
+	NoiseFloats rowY = SetFloats( posY );
+	int index = 0;
+	for( ; index + NOISE_LANES <= count; index += NOISE_LANES )
+	{
+		NoiseFloats laneX = Add( SetFloats( startX ), Multiply( ToFloats( AddInts( LaneIndexes(), SetInts( index ) ) ), SetFloats( stepX ) ) );
+		StoreFloats( out_noise + index, Compute2dPerlinNoiseLanes( laneX, rowY, scale, numOctaves, octavePersistence, octaveScale, renormalize, seed ) );
+	}
+	if( index < count )
+	{
+		float tailX[ NOISE_LANES ];
+		float tailY[ NOISE_LANES ];
+		for( int lane = 0; lane < NOISE_LANES; ++ lane )
+		{
+			int source = (index + lane < count) ? index + lane : count - 1;
+			tailX[ lane ] = startX + (float) source * stepX;
+			tailY[ lane ] = posY;
+		}
+		Compute2dPerlinNoiseBatch( out_noise + index, tailX, tailY, count - index, scale, numOctaves, octavePersistence, octaveScale, renormalize, seed );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Compute2dPerlinNoiseGrid( float* out_noise, int countX, int countY, float startX, float startY, float step, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+{
+	for( int y = 0; y < countY; ++ y )
+	{
+		Compute2dPerlinNoiseRow( out_noise + y * countX, countX, startX, startY + (float) y * step, step, scale, numOctaves, octavePersistence, octaveScale, renormalize, seed );
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Fields join the first matching group that comes after their persistence source's group, so
+//	walking the groups in order always fills a source's lanes before they are read
+//
+void Compute2dPerlinNoiseBundle( NoiseBundleField const* fields, int fieldCount, int countX, int countY, float startX, float startY, float step )
+{
+	GUARANTEE_OR_DIE( fieldCount <= NOISE_BUNDLE_MAX_FIELDS, "Compute2dPerlinNoiseBundle: too many fields" );
+
+	NoiseBundleGroup groups[ NOISE_BUNDLE_MAX_FIELDS ];
+	int fieldGroups[ NOISE_BUNDLE_MAX_FIELDS ];
+	int groupCount = 0;
+	for( int fieldIndex = 0; fieldIndex < fieldCount; ++ fieldIndex )
+	{
+		NoiseBundleField const& field = fields[ fieldIndex ];
+		GUARANTEE_OR_DIE( field.m_persistenceField < fieldIndex, "Compute2dPerlinNoiseBundle: persistence must come from an earlier field" );
+
+		int groupIndex = (field.m_persistenceField >= 0) ? fieldGroups[ field.m_persistenceField ] + 1 : 0;
+		while( groupIndex < groupCount && (groups[ groupIndex ].m_scale != field.m_scale || groups[ groupIndex ].m_octaveScale != field.m_octaveScale) )
+		{
+			++ groupIndex;
+		}
+		NoiseBundleGroup& group = groups[ groupIndex ];
+		if( groupIndex == groupCount )
+		{
+			group.m_scale = field.m_scale;
+			group.m_octaveScale = field.m_octaveScale;
+			++ groupCount;
+		}
+		group.m_fields[ group.m_fieldCount ++ ] = fieldIndex;
+		if( field.m_numOctaves > group.m_maxOctaves )
+			group.m_maxOctaves = field.m_numOctaves;
+		fieldGroups[ fieldIndex ] = groupIndex;
+	}
+
+	for( int y = 0; y < countY; ++ y )
+	{
+		NoiseFloats rowY = SetFloats( startY + (float) y * step );
+		for( int x = 0; x < countX; x += NOISE_LANES )
+		{
+			NoiseFloats laneX = Add( SetFloats( startX ), Multiply( ToFloats( AddInts( LaneIndexes(), SetInts( x ) ) ), SetFloats( step ) ) );
+			int validLanes = (countX - x < NOISE_LANES) ? countX - x : NOISE_LANES;
+			for( int groupIndex = 0; groupIndex < groupCount; ++ groupIndex )
+			{
+				Compute2dPerlinNoiseGroupLanes( fields, groups[ groupIndex ], laneX, rowY, y * countX + x, validLanes );
+			}
+		}
+	}
+}
@@ -76,6 +76,54 @@ float Compute3dPerlinNoise( float posX, float posY, float posZ, float scale=1.f,
 float Compute4dPerlinNoise( float posX, float posY, float posZ, float posT, float scale=1.f, unsigned int numOctaves=1, float octavePersistence=0.5f, float octaveScale=2.f, bool renormalize=true, unsigned int seed=0 );
 
 
+//-----------------------------------------------------------------------------------------------
+// Batched 2D Perlin noise (SIMD, 4 lanes with SSE2 or 8 when built with /arch:AVX2)
+//
+// Each output equals Compute2dPerlinNoise() at the same position and parameters.  The lanes run
+//	the scalar operations in the same order, so results are bit-identical as long as the compiler
+//	does not contract the scalar path into fused multiply-adds (possible with /arch:AVX2); even
+//	then they stay within 1e-6 of it.  Positions are accurate where floorf() fits an int.
+//
+// <Batch>	out_noise[i] at (posX[i], posY[i])
+// <Row>	out_noise[i] at (startX + float(i) * stepX, posY)
+// <Grid>	out_noise[y * countX + x] at (startX + float(x) * step, startY + float(y) * step)
+//
+int GetNoiseBatchLanes();
+void Get2dNoiseUintBatch( unsigned int* out_noise, int const* indexX, int const* indexY, int count, unsigned int seed=0 );
+void Compute2dPerlinNoiseBatch( float* out_noise, float const* posX, float const* posY, int count, float scale=1.f, unsigned int numOctaves=1, float octavePersistence=0.5f, float octaveScale=2.f, bool renormalize=true, unsigned int seed=0 );
+void Compute2dPerlinNoiseRow( float* out_noise, int count, float startX, float posY, float stepX, float scale=1.f, unsigned int numOctaves=1, float octavePersistence=0.5f, float octaveScale=2.f, bool renormalize=true, unsigned int seed=0 );
+void Compute2dPerlinNoiseGrid( float* out_noise, int countX, int countY, float startX, float startY, float step, float scale=1.f, unsigned int numOctaves=1, float octavePersistence=0.5f, float octaveScale=2.f, bool renormalize=true, unsigned int seed=0 );
+
+
+//-----------------------------------------------------------------------------------------------
+// Fused multi-field 2D Perlin noise over one shared <Grid>
+//
+// Every field writes its own countX * countY output array (structure of arrays), holding
+//	outputBias + outputMultiplier * Compute2dPerlinNoise( ... ) at each grid position.  Sample
+//	positions are computed once for all fields, and fields with the same scale and octaveScale
+//	also share each octave's cell, displacements, fade weights and the seed-independent half of
+//	the corner hashes.  A field may take its per-sample persistence from the output of an earlier
+//	field in the array (<persistenceField>), e.g. forest persistence driven by tree density.
+//
+constexpr int NOISE_BUNDLE_MAX_FIELDS = 16;
+
+struct NoiseBundleField
+{
+	float*			m_output = nullptr;
+	float			m_scale = 1.f;
+	unsigned int	m_numOctaves = 1;
+	float			m_octavePersistence = 0.5f;
+	float			m_octaveScale = 2.f;
+	bool			m_renormalize = true;
+	unsigned int	m_seed = 0;
+	float			m_outputBias = 0.f;
+	float			m_outputMultiplier = 1.f;
+	int				m_persistenceField = -1;	// index of an earlier field whose output replaces m_octavePersistence, or -1
+};
+
+void Compute2dPerlinNoiseBundle( NoiseBundleField const* fields, int fieldCount, int countX, int countY, float startX, float startY, float step );
+
+
 //-----------------------------------------------------------------------------------------------
 // Simplex noise functions (random-access / deterministic)
 //
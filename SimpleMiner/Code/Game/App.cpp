@@ -5,6 +5,7 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Profiler.hpp"
 
 Renderer* g_theRenderer = nullptr; // created and owned by the App
 BitmapFont* g_testFont = nullptr;
@@ -88,7 +89,13 @@ void App::Startup()
 
 	JobSystemConfig jobSystemConfig;
 	jobSystemConfig.m_workerThreads = 12;
+	jobSystemConfig.m_workerJobTypes.push_back(JobType::JOB_LOAD | JobType::JOB_SAVE); // disc access stays on worker 0
+	jobSystemConfig.m_defaultWorkerJobTypes = JobType::JOB_CREATE | JobType::JOB_MESH;
 	g_theJobSystem = new JobSystem(jobSystemConfig);
+	g_theJobSystem->SetJobTypeName(JobType::JOB_CREATE, "chunk create");
+	g_theJobSystem->SetJobTypeName(JobType::JOB_LOAD, "chunk load");
+	g_theJobSystem->SetJobTypeName(JobType::JOB_SAVE, "chunk save");
+	g_theJobSystem->SetJobTypeName(JobType::JOB_MESH, "chunk mesh");
 
 	g_theEventSystem->Startup();
 	g_theInput->Startup();
@@ -97,6 +104,7 @@ void App::Startup()
 	g_theConsole->Startup();
 	g_theAudio->Startup();
 	g_theJobSystem->Startup();
+	Profiler::SetThreadName("main");
 
 	g_theGame = new Game(); // create an instance that will handle different modes soon
 	g_theGame->Startup(); // start up the game when there is a renderer
@@ -170,6 +178,7 @@ void App::Render() const
 void App::EndFrame()
 {
 	g_theJobSystem->EndFrame();
+	Profiler::EndFrame();
 	g_theAudio->EndFrame();
 	g_theConsole->EndFrame();
 	g_theRenderer->EndFrame();
@@ -23,9 +23,12 @@ bool BlockDefinition::LoadFromXmlElement(const XmlElement& element)
 	m_topSprite = ParseXmlAttribute(element, "topSprite", IntVec2(1, 1));
 	m_sideSprite = ParseXmlAttribute(element, "sideSprite", IntVec2::ZERO);
 	m_bottomSprite = ParseXmlAttribute(element, "bottomSprite", IntVec2::ZERO);
-	m_top_uvs = s_spriteSheet->GetSpriteUVs(m_topSprite);
-	m_side_uvs = s_spriteSheet->GetSpriteUVs(m_sideSprite);
-	m_bottom_uvs = s_spriteSheet->GetSpriteUVs(m_bottomSprite);
+	if (s_spriteSheet) // headless runs (terrain benchmark) have no textures
+	{
+		m_top_uvs = s_spriteSheet->GetSpriteUVs(m_topSprite);
+		m_side_uvs = s_spriteSheet->GetSpriteUVs(m_sideSprite);
+		m_bottom_uvs = s_spriteSheet->GetSpriteUVs(m_bottomSprite);
+	}
 	return true;
 }
 
@@ -1,6 +1,7 @@
 #include "Game\BlockIterator.hpp"
 #include "Chunk.hpp"
 #include "Game/Game.hpp"
+#include <algorithm>
 
 BlockIterator::BlockIterator()
 {
@@ -28,13 +29,55 @@ BlockIterator::BlockIterator(Vec3 position)
 	m_z = (m_blockIndex >> (BITS_X + BITS_Y)) & MASK_Z;
 }
 
-Block* BlockIterator::GetBlock()
+bool BlockIterator::IsValid() const
 {
-	if (m_chunk == nullptr)
-	{
-		return nullptr;
-	}
-	return m_chunk->GetBlockPtr(m_blockIndex);
+	return m_chunk != nullptr;
+}
+
+// block accessors, only for a valid iterator
+uint8_t BlockIterator::GetType() const
+{
+	return m_chunk->m_blocks.GetType(m_blockIndex);
+}
+
+bool BlockIterator::IsOpaque() const
+{
+	return m_chunk->m_blocks.IsOpaque(m_blockIndex);
+}
+
+bool BlockIterator::IsSolid() const
+{
+	return m_chunk->m_blocks.IsSolid(m_blockIndex);
+}
+
+uint8_t BlockIterator::GetLightEmitted() const
+{
+	return m_chunk->m_blocks.GetLightEmitted(m_blockIndex);
+}
+
+uint8_t BlockIterator::GetIndoorLight() const
+{
+	return m_chunk->m_blocks.GetIndoorLight(m_blockIndex);
+}
+
+uint8_t BlockIterator::GetOutdoorLight() const
+{
+	return m_chunk->m_blocks.GetOutdoorLight(m_blockIndex);
+}
+
+void BlockIterator::SetIndoorLight(uint8_t indoor)
+{
+	m_chunk->m_blocks.SetIndoorLight(m_blockIndex, indoor);
+}
+
+void BlockIterator::SetOutdoorLight(uint8_t outdoor)
+{
+	m_chunk->m_blocks.SetOutdoorLight(m_blockIndex, outdoor);
+}
+
+bool BlockIterator::IsSky() const
+{
+	return m_chunk->m_blocks.IsSky(m_blockIndex);
 }
 
 Vec3 BlockIterator::GetWorldCenter()
@@ -148,14 +191,37 @@ int BlockIterator::IntCoord(float point) const
 
 bool BlockIterator::IsTileSolid(BlockIterator blockIterator) const
 {
-// 	if (m_chunk && m_chunk->GetBlockPtr(m_blockIndex)->IsSolid())
-	if (blockIterator.GetBlock() && blockIterator.GetBlock()->IsSolid())
+	if (blockIterator.IsValid() && blockIterator.IsSolid())
 	{
 		return true;
 	}
 	return false;
 }
 
+//--------------------------------------------------------------------------------
+// distance to the crossing after stepsLeft more along one axis
+static float GetDistanceAfterCrossings(float fwdDistAtNextCrossing, float fwdDistPerCrossing, int stepsLeft)
+{
+	for (int step = 0; step < stepsLeft; step++)
+	{
+		fwdDistAtNextCrossing += fwdDistPerCrossing;
+	}
+	return fwdDistAtNextCrossing;
+}
+
+//--------------------------------------------------------------------------------
+// takes the crossings along one axis short of sectionExit, summed the same way as one block at a time, returns how many
+static int TakeCrossingsBefore(float sectionExit, float fwdDistPerCrossing, int stepsLeft, float& fwdDistAtNextCrossing)
+{
+	int crossings = 0;
+	while (crossings < stepsLeft && fwdDistAtNextCrossing < sectionExit)
+	{
+		fwdDistAtNextCrossing += fwdDistPerCrossing;
+		crossings++;
+	}
+	return crossings;
+}
+
 struct RaycastHit BlockIterator::RaycastVsBlocksFlawless(Vec3 startPosition, Vec3 forwardNormal, float maxDist) const
 {
 	struct RaycastHit hit;
@@ -207,8 +273,41 @@ struct RaycastHit BlockIterator::RaycastVsBlocksFlawless(Vec3 startPosition, Vec
 		return hit;
 	}
 
+	// in a section of a single type that is not solid, every crossing short of the one out of the section is taken at once,
+	// those are the crossings stepping a block at a time takes first and none of them hits, unless they go past maxDist
+	auto skipUniformSection = [&]()
+	{
+		uint8_t sectionType = AIR;
+		if (!blockIterator.IsValid() || !blockIterator.m_chunk->m_blocks.IsUniformSection(blockIterator.m_z >> BITS_SECTION_Z, sectionType)
+			|| BlockDefinition::s_definitions[sectionType].m_solid)
+		{
+			return;
+		}
+
+		int sectionZ = blockIterator.m_z & (SECTION_LAYERS - 1);
+		int stepsLeftX = tileStepDirectionX < 0 ? blockIterator.m_x : MASK_X - blockIterator.m_x;
+		int stepsLeftY = tileStepDirectionY < 0 ? blockIterator.m_y : MASK_Y - blockIterator.m_y;
+		int stepsLeftZ = tileStepDirectionZ < 0 ? sectionZ : SECTION_LAYERS - 1 - sectionZ;
+		float sectionExit = GetDistanceAfterCrossings(fwdDistAtNextXCrossing, fwdDistPerXCrossing, stepsLeftX);
+		sectionExit = std::min(sectionExit, GetDistanceAfterCrossings(fwdDistAtNextYCrossing, fwdDistPerYCrossing, stepsLeftY));
+		sectionExit = std::min(sectionExit, GetDistanceAfterCrossings(fwdDistAtNextZCrossing, fwdDistPerZCrossing, stepsLeftZ));
+		if (sectionExit > maxDist)
+		{
+			return;
+		}
+
+		int crossingsX = TakeCrossingsBefore(sectionExit, fwdDistPerXCrossing, stepsLeftX, fwdDistAtNextXCrossing) * tileStepDirectionX;
+		int crossingsY = TakeCrossingsBefore(sectionExit, fwdDistPerYCrossing, stepsLeftY, fwdDistAtNextYCrossing) * tileStepDirectionY;
+		int crossingsZ = TakeCrossingsBefore(sectionExit, fwdDistPerZCrossing, stepsLeftZ, fwdDistAtNextZCrossing) * tileStepDirectionZ;
+		tileX += crossingsX;
+		tileY += crossingsY;
+		tileZ += crossingsZ;
+		blockIterator = BlockIterator(blockIterator.m_chunk, blockIterator.GetIndex(blockIterator.m_x + crossingsX, blockIterator.m_y + crossingsY, blockIterator.m_z + crossingsZ));
+	};
+
 	for (;;)
 	{
+		skipUniformSection();
 		if (fwdDistAtNextZCrossing < fwdDistAtNextXCrossing && fwdDistAtNextZCrossing < fwdDistAtNextYCrossing)
 		{
 			if (fwdDistAtNextZCrossing > maxDist)
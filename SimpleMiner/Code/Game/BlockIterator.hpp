@@ -2,7 +2,6 @@
 #include "Game/GameCommon.hpp"
 
 class Chunk;
-class Block;
 
 class BlockIterator
 {
@@ -17,7 +16,16 @@ public:
 	int m_y = 0;
 	int m_z = 0;
 
-	Block* GetBlock();
+	bool IsValid() const; // false past the top or bottom of the world and in chunks that are not loaded
+	uint8_t GetType() const;
+	bool IsOpaque() const;
+	bool IsSolid() const;
+	uint8_t GetLightEmitted() const;
+	uint8_t GetIndoorLight() const;
+	uint8_t GetOutdoorLight() const;
+	void SetIndoorLight(uint8_t indoor);
+	void SetOutdoorLight(uint8_t outdoor);
+	bool IsSky() const;
 	Vec3 GetWorldCenter();
 	int GetIndex(int x, int y, int z);
 	BlockIterator GetEastNeighbor();
@@ -12,16 +12,16 @@
 #include "Engine/Renderer/DebugRenderMode.hpp"
 #include "BuildingTemplate.hpp"
 #include "ThirdParty/Squirrel/RawNoise.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Game/NoiseTileCache.hpp"
+#include "Engine/Math/RandomSequence.hpp"
 
 bool indexedDraw = true; // TEST DEBUG
+bool Chunk::s_greedyMeshing = false;
+bool Chunk::s_packedVertexes = false;
 
 Chunk::~Chunk()
 {
-	if (m_block)
-	{
-		delete[] m_block;
-	}
-
 	if (m_immediateVBO_PCU)
 	{
 		delete m_immediateVBO_PCU;
@@ -37,50 +37,59 @@ Chunk::~Chunk()
 
 Chunk::Chunk()
 {
-	m_vertexes.reserve(BLOCKSPERCHUNK * 4 * 4);
-	m_indexes.reserve(BLOCKSPERCHUNK * 6 * 4);
-	m_block = new Block[BLOCKSPERCHUNK];
 	m_worldSeed = g_gameConfigBlackboard.GetValue("WORLD_SEED", WORLD_SEED);
 }
 
 //--------------------------------------------------------------------------------
 bool Chunk::Create()
 {
+	NoiseTileCache* cache = (g_theGame && g_theGame->m_world) ? &g_theGame->m_world->m_noiseCache : nullptr;
+	return Create(*g_theJobSystem, nullptr, cache);
+}
+
+//--------------------------------------------------------------------------------
+bool Chunk::Create(JobSystem& jobSystem, ChunkGenerationTimes* out_times, NoiseTileCache* cache)
+{
+	PROFILE_SCOPE("Chunk::Create");
 	m_status = ChunkState::CHUNK_GENERATING;
+	m_blocks.Expand();
 	// generate world coords of block 0
 	int baseX = m_chunkCoords.x << BITS_X;
 	int baseY = m_chunkCoords.y << BITS_X;
 
 	// generate arrays of Perlin noise for each type we need
-	for (int y = 0; y < NOISE_DIM; y++)
-	{
-		for (int x = 0; x < NOISE_DIM; x++)
-		{
-			int index = y * NOISE_DIM + x;
-			float dx = float(baseX + x - TREE_DIAMETER);
-			float dy = float(baseY + y - TREE_DIAMETER);
-			// need global index values - buffer as floats
-			m_humidity[index] = 0.5f + 0.5f * Compute2dPerlinNoise( dx, dy, HUMIDITY_SCALE, 6, 0.5f, 2.0f, true, m_worldSeed + 1 );
-			m_temperature[index] = 0.5f + 0.5f * Compute2dPerlinNoise( dx, dy, TEMP_SCALE, 8, 0.6f, 2.0f, true, m_worldSeed + 2 );
-			m_hilliness[index] = 0.5f + 0.5f * Compute2dPerlinNoise( dx, dy, HILL_SCALE, 5, 0.6f, 2.0f, true, m_worldSeed + 3 );
-			m_ocean[index] = Compute2dPerlinNoise( dx, dy, OCEAN_SCALE, 5, 0.5f, 2.0f, true, m_worldSeed + 4 );
-			m_treeDensity[index] = 0.5f + 0.5f * Compute2dPerlinNoise(dx, dy, 200.0f, 10, 0.6f, 2.0f, true, m_worldSeed + 6);
-			m_forest[index] = 0.5f + 0.5f * Compute2dPerlinNoise( dx, dy, 400.0f, 9, m_treeDensity[index], 2.0f, true, m_worldSeed + 5 );
-		}
-	}
+	double startTime = GetCurrentTimeSeconds();
+	GenerateNoise(jobSystem, cache);
+	double noiseTime = GetCurrentTimeSeconds();
+
+	// create terrain
+	FillColumns(baseX, baseY);
+	double columnTime = GetCurrentTimeSeconds();
 
-	for (int y = 0; y < NOISE_DIM; y++)
+	// create trees
+	CreateTrees(baseX, baseY);
+	double treeTime = GetCurrentTimeSeconds();
+	CreateVillage(m_chunkCoords.x, m_chunkCoords.y);
+	double villageTime = GetCurrentTimeSeconds();
+	m_blocks.Compact();
+
+	if (out_times)
 	{
-		for (int x = 0; x < NOISE_DIM; x++)
-		{
-			int index = y * NOISE_DIM + x;
-			float dx = float(m_chunkCoords.x + x - ((VILLAGE_RANGE + VILLAGE_DIAMETER) >> 1));
-			float dy = float(m_chunkCoords.y + y - ((VILLAGE_RANGE + VILLAGE_DIAMETER) >> 1));
-			m_town[index] = 0.5f + 0.5f * Compute2dPerlinNoise(dx, dy, 200.0f, 9, 0.5f, 2.0f, true, m_worldSeed + 7);
-		}
+		out_times->m_noiseSeconds += noiseTime - startTime;
+		out_times->m_columnSeconds += columnTime - noiseTime;
+		out_times->m_treeSeconds += treeTime - columnTime;
+		out_times->m_villageSeconds += villageTime - treeTime;
 	}
 
-	// create terrain
+	m_status = ChunkState::CHUNK_COMPLETE;
+	return true;
+}
+
+//--------------------------------------------------------------------------------
+// surface block, a few blocks of dirt or sand, stone and ores down to the bottom, then water or ice up to sea level
+void Chunk::FillColumns(int baseX, int baseY)
+{
+	PROFILE_SCOPE("Chunk::FillColumns");
 	for (int y = 0; y < SIZE_Y; y++)
 	{
 		for (int x = 0; x < SIZE_X; x++)
@@ -93,9 +102,14 @@ bool Chunk::Create()
 			uint8_t block = DetermineSurfaceTerrain(offset, tx, ty, &terrainHeight);
 			SetBlock(x, y, terrainHeight, block);
 
+			// columns roll from their own sequences keyed by world position, so a chunk comes out the same
+			// whichever thread generates it and whenever it is regenerated
+			RandomSequence soilRandom(RandomSequence::MakeSeed(m_worldSeed, baseX + x, baseY + y, RANDOM_SOIL_DEPTH));
+			RandomSequence oreRandom(RandomSequence::MakeSeed(m_worldSeed, baseX + x, baseY + y, RANDOM_ORES));
+
 			// create terrain below surface block
 			float humid = m_humidity[offset];
-			for (int index = random.RollRandomIntInRange(3, 4); index > 0; index--)
+			for (int index = soilRandom.RollRandomIntInRange(3, 4); index > 0; index--)
 			{
 				terrainHeight--; // move down to next block to create
 				if (index > Interpolate(1, 10, humid))
@@ -112,7 +126,7 @@ bool Chunk::Create()
 			while (terrainHeight > 0)
 			{
 				terrainHeight--; // move down to next block to create
-				float type = random.RollRandomFloatZeroToOne();
+				float type = oreRandom.RollRandomFloatZeroToOne();
 				if (type < 0.001)
 				{
 					SetBlock(x, y, terrainHeight, DIAMOND);
@@ -159,13 +173,59 @@ bool Chunk::Create()
 			}
 		}
 	}
+}
 
-	// create trees
-	CreateTrees(baseX, baseY);
-	CreateVillage(m_chunkCoords.x, m_chunkCoords.y);
+//--------------------------------------------------------------------------------
+// rows of the noise arrays are independent, so they are split across the job system
+// with a cache, each band of rows within one tile row copies from (or fills) the same cached tiles
+void Chunk::GenerateNoise(JobSystem& jobSystem, NoiseTileCache* cache)
+{
+	PROFILE_SCOPE("Chunk::GenerateNoise");
+	int startX = (m_chunkCoords.x << BITS_X) - TREE_DIAMETER;
+	int startY = (m_chunkCoords.y << BITS_X) - TREE_DIAMETER;
+	float* fields[NUM_NOISE_FIELDS] = { m_treeDensity, m_humidity, m_temperature, m_hilliness, m_ocean, m_forest, m_town };
 
-	m_status = ChunkState::CHUNK_COMPLETE;
-	return true;
+	// the town grid is in chunk coordinates, one sample per chunk around this one
+	int townStartX = m_chunkCoords.x - ((VILLAGE_RANGE + VILLAGE_DIAMETER) >> 1);
+	int townStartY = m_chunkCoords.y - ((VILLAGE_RANGE + VILLAGE_DIAMETER) >> 1);
+
+	if (cache)
+	{
+		int firstTileY = startY >> NOISE_TILE_BITS;
+		int bandCount = ((startY + NOISE_DIM - 1) >> NOISE_TILE_BITS) - firstTileY + 1;
+		jobSystem.ParallelFor(0, bandCount, 1, [&](int band)
+		{
+			int firstRow = ((firstTileY + band) << NOISE_TILE_BITS) - startY;
+			int endRow = firstRow + NOISE_TILE_SIZE;
+			firstRow = firstRow < 0 ? 0 : firstRow;
+			endRow = endRow > NOISE_DIM ? NOISE_DIM : endRow;
+			for (int field = 0; field < NUM_TERRAIN_NOISE_FIELDS; field++)
+			{
+				cache->CopyRegion((NoiseField)field, m_worldSeed, startX, startY + firstRow, NOISE_DIM, endRow - firstRow, fields[field] + firstRow * NOISE_DIM, NOISE_DIM);
+			}
+		});
+		cache->CopyRegion(NOISE_FIELD_TOWN, m_worldSeed, townStartX, townStartY, NOISE_DIM, NOISE_DIM, m_town, NOISE_DIM);
+		return;
+	}
+
+	int batchCount = (NOISE_DIM + NOISE_ROWS_PER_BATCH - 1) / NOISE_ROWS_PER_BATCH;
+	jobSystem.ParallelFor(0, batchCount, 1, [&](int batch)
+	{
+		int firstRow = batch * NOISE_ROWS_PER_BATCH;
+		int rowCount = NOISE_DIM - firstRow;
+		if (rowCount > NOISE_ROWS_PER_BATCH)
+		{
+			rowCount = NOISE_ROWS_PER_BATCH;
+		}
+		float* batchFields[NUM_NOISE_FIELDS];
+		for (int field = 0; field < NUM_NOISE_FIELDS; field++)
+		{
+			batchFields[field] = fields[field] + firstRow * NOISE_DIM;
+		}
+		// need global index values - buffer as floats
+		ComputeTerrainNoise(batchFields, startX, startY + firstRow, NOISE_DIM, rowCount, m_worldSeed);
+		ComputeTownNoise(batchFields[NOISE_FIELD_TOWN], townStartX, townStartY + firstRow, NOISE_DIM, rowCount, m_worldSeed);
+	});
 }
 
 //--------------------------------------------------------------------------------
@@ -198,6 +258,7 @@ void Chunk::CopyTreeTemplateToWorld(BlockTemplate const* tree, int terrainHeight
 //--------------------------------------------------------------------------------
 void Chunk::CreateTrees(int baseX, int baseY)
 {
+	PROFILE_SCOPE("Chunk::CreateTrees");
 	for (int y = (TREE_DIAMETER >> 1); y < NOISE_DIM - (TREE_DIAMETER >> 1); y++) // 2..21 with 2 block buffer around square
 	{
 		for (int x = (TREE_DIAMETER >> 1); x < NOISE_DIM - (TREE_DIAMETER >> 1); x++)
@@ -278,6 +339,7 @@ void Chunk::CreateTrees(int baseX, int baseY)
 //--------------------------------------------------------------------------------
 void Chunk::CreateVillage(int chunkX, int chunkY)
 {
+	PROFILE_SCOPE("Chunk::CreateVillage");
 	for (int y = (VILLAGE_RANGE >> 1); y < (VILLAGE_RANGE >> 1) + VILLAGE_DIAMETER + 1; y++) // test VILLAGE_DIAMETER around chunk
 	{
 		for (int x = (VILLAGE_RANGE >> 1); x < (VILLAGE_RANGE >> 1) + VILLAGE_DIAMETER + 1; x++)
@@ -290,7 +352,7 @@ void Chunk::CreateVillage(int chunkX, int chunkY)
 				int worldy = chunkY << BITS_Y;
 				char msg[80];
 				sprintf_s(msg, "Found town: %4i %4i", worldx + 7, worldy + 7);
-				if (g_theGame->m_isDebug && chunkX == townChunk.x && chunkY == townChunk.y)
+				if (g_theGame && g_theGame->m_isDebug && chunkX == townChunk.x && chunkY == townChunk.y)
 					DebugAddMessage(msg, 60.0f, Rgba8::RED, Rgba8::PURPLE);
 
 				m_townType = 0; // Get2dNoiseUint(chunkX, chunkY, m_worldSeed + 8);
@@ -566,12 +628,7 @@ uint8_t Chunk::GetBlock(int x, int y, int z)
 
 uint8_t Chunk::GetBlock(int index)
 {
-	return m_block[index].GetBlockDefinition();
-}
-
-Block* Chunk::GetBlockPtr(int index)
-{
-	return &m_block[index];
+	return m_blocks.GetType(index);
 }
 
 void Chunk::SetBlock(IntVec3 position, uint8_t value)
@@ -588,13 +645,13 @@ void Chunk::SetBlock(int index, uint8_t value)
 {
 	if (index >= 0 && index < BLOCKSPERCHUNK)
 	{
-		m_block[index].SetBlockDefinition(value);
-		m_block[index].InitializeFlags();
+		m_blocks.SetType(index, value);
 	}
 }
 
 void Chunk::CreateBuffers()
 {
+	PROFILE_SCOPE("Chunk::CreateBuffers");
 	if (!indexedDraw || m_indexCount == 0) // don't create an index buffer if there are no vertices to draw
 	{
 		return;
@@ -611,80 +668,224 @@ void Chunk::CreateBuffers()
 	}
 
 	m_indexBuffer = g_theRenderer->CreateIndexBuffer(m_indexes.data(), m_indexCount * sizeof(unsigned int)); // multiply by  to get total count?
-	m_immediateVBO_PCU = g_theRenderer->CreateVertexBuffer(sizeof(Vertex_PCU), sizeof(Vertex_PCU));
-
-	g_theRenderer->CopyCPUToGPU(m_vertexes.data(), static_cast<size_t>(m_vertexes.size()) * m_immediateVBO_PCU->GetStride(), m_immediateVBO_PCU);
+	if (m_isPackedMesh)
+	{
+		m_immediateVBO_PCU = g_theRenderer->CreateVertexBuffer(sizeof(Vertex_Voxel), sizeof(Vertex_Voxel));
+		g_theRenderer->CopyCPUToGPU(m_packedVertexes.data(), m_packedVertexes.size() * m_immediateVBO_PCU->GetStride(), m_immediateVBO_PCU);
+	}
+	else
+	{
+		m_immediateVBO_PCU = g_theRenderer->CreateVertexBuffer(sizeof(Vertex_PCU), sizeof(Vertex_PCU));
+		g_theRenderer->CopyCPUToGPU(m_vertexes.data(), static_cast<size_t>(m_vertexes.size()) * m_immediateVBO_PCU->GetStride(), m_immediateVBO_PCU);
+	}
 	g_theRenderer->CopyCPUToGPU(m_indexes.data(), static_cast<size_t>(m_indexes.size()) * m_indexBuffer->GetStride(), m_indexBuffer);
 }
 
-void Chunk::CreateGeometry()
+//--------------------------------------------------------------------------------
+// swaps in the batch meshes a snapshot of this chunk rebuilt, the snapshot keeps the old buffers' capacity for its next job
+void Chunk::TakeMesh(Chunk& meshed)
+{
+	for (int batch = 0; batch < GEOMETRY_BATCHES; batch++)
+	{
+		if ((meshed.m_sectionsNeedingMesh >> (batch / BATCHES_PER_SECTION)) & 1)
+		{
+			std::swap(m_batchMeshes[batch], meshed.m_batchMeshes[batch]);
+		}
+	}
+	m_isGreedyMesh = meshed.m_isGreedyMesh;
+	m_isPackedMesh = meshed.m_isPackedMesh;
+	AssembleMesh();
+}
+
+//--------------------------------------------------------------------------------
+// appends the batch meshes in order with their indexes rebased, so the result is identical to a serial build
+void Chunk::AssembleMesh()
 {
-	Rgba8 zColor = Rgba8::WHITE;
-	Rgba8 yColor = Rgba8(205, 205, 205);
-	Rgba8 xColor = Rgba8(230, 230, 230);
 	m_indexes.clear();
 	m_vertexes.clear();
+	m_packedVertexes.clear();
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (int batch = 0; batch < GEOMETRY_BATCHES; batch++)
+	{
+		vertexCount += m_isPackedMesh ? m_batchMeshes[batch].m_packedVertexes.size() : m_batchMeshes[batch].m_vertexes.size();
+		indexCount += m_batchMeshes[batch].m_indexes.size();
+	}
+	if (m_isPackedMesh)
+	{
+		m_packedVertexes.reserve(vertexCount);
+	}
+	else
+	{
+		m_vertexes.reserve(vertexCount);
+	}
+	m_indexes.reserve(indexCount);
+	for (int batch = 0; batch < GEOMETRY_BATCHES; batch++)
+	{
+		ChunkBatchMesh const& mesh = m_batchMeshes[batch];
+		unsigned int vertexBase = static_cast<unsigned int>(m_isPackedMesh ? m_packedVertexes.size() : m_vertexes.size());
+		m_vertexes.insert(m_vertexes.end(), mesh.m_vertexes.begin(), mesh.m_vertexes.end());
+		m_packedVertexes.insert(m_packedVertexes.end(), mesh.m_packedVertexes.begin(), mesh.m_packedVertexes.end());
+		for (unsigned int index : mesh.m_indexes)
+		{
+			m_indexes.push_back(vertexBase + index);
+		}
+	}
+	m_indexCount = static_cast<unsigned int>(m_indexes.size());
+}
 
-	if (indexedDraw)
+void Chunk::CreateGeometry()
+{
+	CreateGeometry(*g_theJobSystem, s_greedyMeshing, s_packedVertexes);
+}
+
+//--------------------------------------------------------------------------------
+// one bit per block whose definition is visible, a row along x for each y and z with the west and east neighbors' border
+// blocks in bits 0 and SIZE_X + 1, and padding rows past every side, empty below and above the chunk so those faces
+// show, full for a missing neighbor so faces against it stay hidden until it is loaded
+struct ChunkVisibilityBits
+{
+	uint32_t m_rows[SIZE_Z + 2][SIZE_Y + 2];
+
+	void Build(Chunk const& chunk, uint8_t sections);
+	uint32_t GetFaceBits(int y, int z, int face) const;
+};
+
+//--------------------------------------------------------------------------------
+static uint32_t IsBlockVisible(ChunkBlocks const& blocks, int index)
+{
+	return BlockDefinition::s_definitions[blocks.GetType(index)].m_visible ? 1u : 0u;
+}
+
+//--------------------------------------------------------------------------------
+// true when a batch is in a section of a single invisible type, which has no faces to mesh
+static bool IsBatchEmpty(ChunkBlocks const& blocks, int batch)
+{
+	uint8_t uniformType = AIR;
+	return blocks.IsUniformSection(batch / BATCHES_PER_SECTION, uniformType) && !BlockDefinition::s_definitions[uniformType].m_visible;
+}
+
+//--------------------------------------------------------------------------------
+// the batches of the sections in the mask, in order, returns how many
+static int GetSectionBatches(uint8_t sections, int* out_batches)
+{
+	int batchCount = 0;
+	for (int batch = 0; batch < GEOMETRY_BATCHES; batch++)
 	{
-		for (int index = 0; index < BLOCKSPERCHUNK; index++)
+		if ((sections >> (batch / BATCHES_PER_SECTION)) & 1)
 		{
-			AABB3 bounds = GetBlockBounds(index);
-			Vec3 c000(bounds.m_mins.x, bounds.m_mins.y, bounds.m_mins.z);
-			Vec3 c001(bounds.m_mins.x, bounds.m_mins.y, bounds.m_maxs.z);
-			Vec3 c010(bounds.m_mins.x, bounds.m_maxs.y, bounds.m_mins.z);
-			Vec3 c011(bounds.m_mins.x, bounds.m_maxs.y, bounds.m_maxs.z);
-			Vec3 c100(bounds.m_maxs.x, bounds.m_mins.y, bounds.m_mins.z);
-			Vec3 c101(bounds.m_maxs.x, bounds.m_mins.y, bounds.m_maxs.z);
-			Vec3 c110(bounds.m_maxs.x, bounds.m_maxs.y, bounds.m_mins.z);
-			Vec3 c111(bounds.m_maxs.x, bounds.m_maxs.y, bounds.m_maxs.z);
-
-			BlockIterator block(this, index);
-			if (BlockDefinition::s_definitions[GetBlock(index)].m_visible)
-			{
-				AABB2 UVs;
-				if (IsVisible(index, 0)) // top
-				{
-					UVs = BlockDefinition::s_definitions[GetBlock(index)].m_top_uvs;
-					zColor = BlockFaceLight(block, 0);
-					AddVertsForQuad3D(m_indexes, m_vertexes, c011, c001, c101, c111, zColor, UVs);
-				}
+			out_batches[batchCount++] = batch;
+		}
+	}
+	return batchCount;
+}
 
-				UVs = BlockDefinition::s_definitions[GetBlock(index)].m_side_uvs;
-				if (IsVisible(index, 1)) // south
-				{
-					xColor = BlockFaceLight(block, 1);
-					AddVertsForQuad3D(m_indexes, m_vertexes, c001, c000, c100, c101, xColor, UVs);
-				}
-				if (IsVisible(index, 2)) // east
-				{
-					yColor = BlockFaceLight(block, 2);
-					AddVertsForQuad3D(m_indexes, m_vertexes, c101, c100, c110, c111, yColor, UVs);
-				}
-				if (IsVisible(index, 3)) // north
-				{
-					xColor = BlockFaceLight(block, 3);
-					AddVertsForQuad3D(m_indexes, m_vertexes, c111, c110, c010, c011, xColor, UVs);
-				}
-				if (IsVisible(index, 4)) // west
-				{
-					yColor = BlockFaceLight(block, 4);
-					AddVertsForQuad3D(m_indexes, m_vertexes, c011, c010, c000, c001, yColor, UVs);
-				}
+//--------------------------------------------------------------------------------
+// reads the chunk once and only the border slab of each neighbor, which is all a ChunkMeshSnapshot holds of them
+// only the layers of the sections in the mask and the layer past either end of them are built, the other rows are never read
+// uniform sections fill their rows without reading a block
+void ChunkVisibilityBits::Build(Chunk const& chunk, uint8_t sections)
+{
+	uint32_t const fullRow = (1u << (SIZE_X + 2)) - 1u;
+	Chunk const* north = chunk.m_neighbors[NORTH];
+	Chunk const* east = chunk.m_neighbors[EAST];
+	Chunk const* south = chunk.m_neighbors[SOUTH];
+	Chunk const* west = chunk.m_neighbors[WEST];
+	for (int y = 0; y < SIZE_Y + 2; y++)
+	{
+		m_rows[0][y] = 0;
+		m_rows[SIZE_Z + 1][y] = 0;
+	}
 
-				if (IsVisible(index, 5)) // bottom
-				{
-					UVs = BlockDefinition::s_definitions[GetBlock(index)].m_bottom_uvs;
-					zColor = BlockFaceLight(block, 5);
-					AddVertsForQuad3D(m_indexes, m_vertexes, c000, c010, c110, c100, zColor, UVs);
-				}
+	for (int z = 0; z < SIZE_Z; z++)
+	{
+		int belowSection = (z > 0 ? z - 1 : z) >> BITS_SECTION_Z;
+		int aboveSection = (z < MASK_Z ? z + 1 : z) >> BITS_SECTION_Z;
+		if ((((sections >> (z >> BITS_SECTION_Z)) | (sections >> belowSection) | (sections >> aboveSection)) & 1) == 0)
+		{
+			continue;
+		}
+
+		int layerIndex = z << (BITS_X + BITS_Y);
+		uint8_t uniformType = AIR;
+		bool isUniform = chunk.m_blocks.IsUniformSection(z >> BITS_SECTION_Z, uniformType);
+		uint32_t uniformRow = BlockDefinition::s_definitions[uniformType].m_visible ? (1u << (SIZE_X + 1)) - 2u : 0u;
+		for (int y = 0; y < SIZE_Y; y++)
+		{
+			int rowIndex = layerIndex | (y << BITS_X);
+			uint32_t row = isUniform ? uniformRow : 0u;
+			for (int x = 0; x < SIZE_X && !isUniform; x++)
+			{
+				row |= IsBlockVisible(chunk.m_blocks, rowIndex + x) << (x + 1);
+			}
+			row |= west ? IsBlockVisible(west->m_blocks, rowIndex | MASK_X) : 1u;
+			row |= (east ? IsBlockVisible(east->m_blocks, rowIndex) : 1u) << (SIZE_X + 1);
+			m_rows[z + 1][y + 1] = row;
+		}
+
+		uint32_t southRow = fullRow;
+		uint32_t northRow = fullRow;
+		if (south)
+		{
+			southRow = 0;
+			int rowIndex = layerIndex | (MASK_Y << BITS_X);
+			for (int x = 0; x < SIZE_X; x++)
+			{
+				southRow |= IsBlockVisible(south->m_blocks, rowIndex + x) << (x + 1);
 			}
 		}
+		if (north)
+		{
+			northRow = 0;
+			for (int x = 0; x < SIZE_X; x++)
+			{
+				northRow |= IsBlockVisible(north->m_blocks, layerIndex + x) << (x + 1);
+			}
+		}
+		m_rows[z + 1][0] = southRow;
+		m_rows[z + 1][SIZE_Y + 1] = northRow;
+	}
+}
+
+//--------------------------------------------------------------------------------
+// bit x + 1 is set where block (x, y, z) is visible and face looks into a block that is not, the same test as IsVisible was
+uint32_t ChunkVisibilityBits::GetFaceBits(int y, int z, int face) const
+{
+	uint32_t row = m_rows[z + 1][y + 1];
+	uint32_t blocks = row & ((1u << (SIZE_X + 1)) - 2u);
+	switch (face)
+	{
+	case 0: return blocks & ~m_rows[z + 2][y + 1];	// top
+	case 1: return blocks & ~m_rows[z + 1][y];		// south
+	case 2: return blocks & ~(row >> 1);			// east
+	case 3: return blocks & ~m_rows[z + 1][y + 2];	// north
+	case 4: return blocks & ~(row << 1);			// west
+	case 5: return blocks & ~m_rows[z][y + 1];		// bottom
+	}
+	return 0;
+}
 
-		m_indexCount = static_cast<unsigned int>(m_indexes.size()); // could eliminate this
+//--------------------------------------------------------------------------------
+// rebuilds the sections that need a mesh and appends every batch's mesh, the caller clears m_sectionsNeedingMesh
+void Chunk::CreateGeometry(JobSystem& jobSystem, bool greedy, bool packed)
+{
+	if (indexedDraw)
+	{
+		CreateSectionGeometry(jobSystem, greedy, packed);
+		AssembleMesh();
 		return;
 	}
 
+	PROFILE_SCOPE("Chunk::CreateGeometry");
+	Rgba8 zColor = Rgba8::WHITE;
+	Rgba8 yColor = Rgba8(205, 205, 205);
+	Rgba8 xColor = Rgba8(230, 230, 230);
+	m_indexes.clear();
+	m_vertexes.clear();
+	m_packedVertexes.clear();
+	m_isGreedyMesh = false;
+	m_isPackedMesh = false;
+
 	// non-indexed buffer draw for testing
 	for (int index = 0; index < BLOCKSPERCHUNK; index++)
 	{
@@ -718,152 +919,384 @@ void Chunk::CreateGeometry()
 	}
 }
 
-Rgba8 Chunk::BlockFaceLight(BlockIterator block, int face)
+//--------------------------------------------------------------------------------
+// each batch of z layers in a section that needs a mesh is meshed into its own buffers, the other batches keep theirs,
+// every batch is rebuilt when the mesher changes, batches in a section of a single invisible type have no faces
+void Chunk::CreateSectionGeometry(JobSystem& jobSystem, bool greedy, bool packed)
 {
-	Rgba8 color = Rgba8(0, 0, 127);
-	switch (face)
+	if (greedy != m_isGreedyMesh || packed != m_isPackedMesh)
+	{
+		m_sectionsNeedingMesh = ALL_SECTIONS;
+	}
+	m_isGreedyMesh = greedy;
+	m_isPackedMesh = packed;
+	if (greedy || packed)
+	{
+		CreateMaskedGeometry(jobSystem, greedy, packed);
+		return;
+	}
+
+	PROFILE_SCOPE("Chunk::CreateSectionGeometry");
+	// rows without a visible face are skipped whole, so the cost follows the visible faces rather than the blocks
+	ChunkVisibilityBits visibility;
+	visibility.Build(*this, m_sectionsNeedingMesh);
+	int batches[GEOMETRY_BATCHES];
+	int batchCount = GetSectionBatches(m_sectionsNeedingMesh, batches);
+	jobSystem.ParallelFor(0, batchCount, 1, [&](int batchSlot)
 	{
-	case 0:
-		if (block.GetTopNeighbor().GetBlock())
+		int batch = batches[batchSlot];
+		std::vector<Vertex_PCU>& vertexes = m_batchMeshes[batch].m_vertexes;
+		std::vector<unsigned int>& indexes = m_batchMeshes[batch].m_indexes;
+		vertexes.clear();
+		m_batchMeshes[batch].m_packedVertexes.clear();
+		indexes.clear();
+		if (IsBatchEmpty(m_blocks, batch))
 		{
-			color.r = (uint8_t)RangeMap(block.GetTopNeighbor().GetBlock()->GetOutdoorLight(), 0, MAX_LIGHT, 0, 255);
-			color.g = (uint8_t)RangeMap(block.GetTopNeighbor().GetBlock()->GetIndoorLight(), 0, MAX_LIGHT, 0, 255);
+			return;
 		}
-		else
+
+		Rgba8 faceColor;
+		int lastZ = (batch + 1) * GEOMETRY_LAYERS_PER_BATCH;
+		for (int z = batch * GEOMETRY_LAYERS_PER_BATCH; z < lastZ; z++)
 		{
-			return Rgba8::GREEN;
+			for (int y = 0; y < SIZE_Y; y++)
+			{
+				uint32_t faceBits[6];
+				uint32_t anyFaceBits = 0;
+				for (int face = 0; face < 6; face++)
+				{
+					faceBits[face] = visibility.GetFaceBits(y, z, face);
+					anyFaceBits |= faceBits[face];
+				}
+
+				for (int x = 0; x < SIZE_X && (anyFaceBits >> (x + 1)) != 0; x++)
+				{
+					uint32_t bit = 1u << (x + 1);
+					if ((anyFaceBits & bit) == 0)
+					{
+						continue;
+					}
+					int index = x | (y << BITS_X) | (z << (BITS_X + BITS_Y));
+
+					AABB3 bounds = GetBlockBounds(index);
+					Vec3 c000(bounds.m_mins.x, bounds.m_mins.y, bounds.m_mins.z);
+					Vec3 c001(bounds.m_mins.x, bounds.m_mins.y, bounds.m_maxs.z);
+					Vec3 c010(bounds.m_mins.x, bounds.m_maxs.y, bounds.m_mins.z);
+					Vec3 c011(bounds.m_mins.x, bounds.m_maxs.y, bounds.m_maxs.z);
+					Vec3 c100(bounds.m_maxs.x, bounds.m_mins.y, bounds.m_mins.z);
+					Vec3 c101(bounds.m_maxs.x, bounds.m_mins.y, bounds.m_maxs.z);
+					Vec3 c110(bounds.m_maxs.x, bounds.m_maxs.y, bounds.m_mins.z);
+					Vec3 c111(bounds.m_maxs.x, bounds.m_maxs.y, bounds.m_maxs.z);
+
+					AABB2 UVs;
+					if (faceBits[0] & bit) // top
+					{
+						UVs = BlockDefinition::s_definitions[GetBlock(index)].m_top_uvs;
+						faceColor = GetFaceLight(index, 0);
+						AddVertsForQuad3D(indexes, vertexes, c011, c001, c101, c111, faceColor, UVs);
+					}
+
+					UVs = BlockDefinition::s_definitions[GetBlock(index)].m_side_uvs;
+					if (faceBits[1] & bit) // south
+					{
+						faceColor = GetFaceLight(index, 1);
+						AddVertsForQuad3D(indexes, vertexes, c001, c000, c100, c101, faceColor, UVs);
+					}
+					if (faceBits[2] & bit) // east
+					{
+						faceColor = GetFaceLight(index, 2);
+						AddVertsForQuad3D(indexes, vertexes, c101, c100, c110, c111, faceColor, UVs);
+					}
+					if (faceBits[3] & bit) // north
+					{
+						faceColor = GetFaceLight(index, 3);
+						AddVertsForQuad3D(indexes, vertexes, c111, c110, c010, c011, faceColor, UVs);
+					}
+					if (faceBits[4] & bit) // west
+					{
+						faceColor = GetFaceLight(index, 4);
+						AddVertsForQuad3D(indexes, vertexes, c011, c010, c000, c001, faceColor, UVs);
+					}
+
+					if (faceBits[5] & bit) // bottom
+					{
+						UVs = BlockDefinition::s_definitions[GetBlock(index)].m_bottom_uvs;
+						faceColor = GetFaceLight(index, 5);
+						AddVertsForQuad3D(indexes, vertexes, c000, c010, c110, c100, faceColor, UVs);
+					}
+				}
+			}
 		}
-		break;
-	case 1:
-		if (block.GetSouthNeighbor().GetBlock())
+	});
+}
+
+//--------------------------------------------------------------------------------
+// sweeps a sizeA x sizeB plane of face keys (0 for no face), growing each quad along a as far as the key repeats,
+// then along b while whole rows match, and clears what it covered, without merge every face is its own quad
+template <typename EmitQuad>
+static void MergeGreedyFaces(uint32_t* mask, int sizeA, int sizeB, bool merge, EmitQuad const& emitQuad)
+{
+	for (int b = 0; b < sizeB; b++)
+	{
+		for (int a = 0; a < sizeA;)
 		{
-			color.r = (uint8_t)RangeMap(block.GetSouthNeighbor().GetBlock()->GetOutdoorLight(), 0, MAX_LIGHT, 0, 255);
-			color.g = (uint8_t)RangeMap(block.GetSouthNeighbor().GetBlock()->GetIndoorLight(), 0, MAX_LIGHT, 0, 255);
+			uint32_t key = mask[b * sizeA + a];
+			if (key == 0)
+			{
+				a++;
+				continue;
+			}
+
+			int width = 1;
+			while (merge && a + width < sizeA && mask[b * sizeA + a + width] == key)
+			{
+				width++;
+			}
+			int height = 1;
+			for (; merge && b + height < sizeB; height++)
+			{
+				bool isRowMatching = true;
+				for (int step = 0; step < width && isRowMatching; step++)
+				{
+					isRowMatching = mask[(b + height) * sizeA + a + step] == key;
+				}
+				if (!isRowMatching)
+				{
+					break;
+				}
+			}
+
+			for (int row = 0; row < height; row++)
+			{
+				for (int step = 0; step < width; step++)
+				{
+					mask[(b + row) * sizeA + a + step] = 0;
+				}
+			}
+			emitQuad(a, b, width, height, key);
+			a += width;
 		}
-		else
+	}
+}
+
+//--------------------------------------------------------------------------------
+// faces merge when both the sprite and the face light match, so every pixel is lit exactly as a single block face
+// top and bottom faces span a whole z layer, side faces only the layers of one batch so the batches stay independent
+// packed meshes go to the batches' m_packedVertexes, the others to their m_vertexes, only for the sections that need a mesh
+void Chunk::CreateMaskedGeometry(JobSystem& jobSystem, bool greedy, bool packed)
+{
+	PROFILE_SCOPE("Chunk::CreateMaskedGeometry");
+	ChunkVisibilityBits visibility;
+	visibility.Build(*this, m_sectionsNeedingMesh);
+	int batches[GEOMETRY_BATCHES];
+	int batchCount = GetSectionBatches(m_sectionsNeedingMesh, batches);
+	jobSystem.ParallelFor(0, batchCount, 1, [&](int batchSlot)
+	{
+		int batch = batches[batchSlot];
+		std::vector<Vertex_PCU>& vertexes = m_batchMeshes[batch].m_vertexes;
+		std::vector<Vertex_Voxel>& packedVertexes = m_batchMeshes[batch].m_packedVertexes;
+		std::vector<unsigned int>& indexes = m_batchMeshes[batch].m_indexes;
+		vertexes.clear();
+		packedVertexes.clear();
+		indexes.clear();
+		if (IsBatchEmpty(m_blocks, batch))
 		{
-			return Rgba8::GREEN;
+			return;
 		}
-		break;
-	case 2:
-		if (block.GetEastNeighbor().GetBlock())
+
+		int firstZ = batch * GEOMETRY_LAYERS_PER_BATCH;
+		uint32_t mask[BLOCKSPERLAYER];
+		int face = 0;
+		int slice = 0;
+		int offsetB = 0; // side masks only hold this batch's layers
+		auto emitQuad = [&](int minA, int minB, int width, int height, uint32_t key)
 		{
-			color.r = (uint8_t)RangeMap(block.GetEastNeighbor().GetBlock()->GetOutdoorLight(), 0, MAX_LIGHT, 0, 255);
-			color.g = (uint8_t)RangeMap(block.GetEastNeighbor().GetBlock()->GetIndoorLight(), 0, MAX_LIGHT, 0, 255);
-		}
-		else
+			if (packed)
+			{
+				AddPackedQuad(indexes, packedVertexes, face, slice, minA, minB + offsetB, width, height, key);
+			}
+			else
+			{
+				AddGreedyQuad(indexes, vertexes, face, slice, minA, minB + offsetB, width, height, key);
+			}
+		};
+
+		// top (0) and bottom (5) in the x, y plane of each layer
+		for (slice = firstZ; slice < firstZ + GEOMETRY_LAYERS_PER_BATCH; slice++)
 		{
-			return Rgba8::GREEN;
+			for (face = 0; face <= 5; face += 5)
+			{
+				for (int y = 0; y < SIZE_Y; y++)
+				{
+					uint32_t faceBits = visibility.GetFaceBits(y, slice, face);
+					for (int x = 0; x < SIZE_X; x++)
+					{
+						int index = x + y * SIZE_X;
+						mask[index] = (faceBits >> (x + 1)) & 1u ? GetGreedyFaceKey(slice * BLOCKSPERLAYER + index, face) : 0;
+					}
+				}
+				MergeGreedyFaces(mask, SIZE_X, SIZE_Y, greedy, emitQuad);
+			}
 		}
-		break;
-	case 3:
-		if (block.GetNorthNeighbor().GetBlock())
+
+		// south (1) and north (3) in the x, z plane of each row
+		offsetB = firstZ;
+		for (slice = 0; slice < SIZE_Y; slice++)
 		{
-			color.r = (uint8_t)RangeMap(block.GetNorthNeighbor().GetBlock()->GetOutdoorLight(), 0, MAX_LIGHT, 0, 255);
-			color.g = (uint8_t)RangeMap(block.GetNorthNeighbor().GetBlock()->GetIndoorLight(), 0, MAX_LIGHT, 0, 255);
+			for (face = 1; face <= 3; face += 2)
+			{
+				for (int z = 0; z < GEOMETRY_LAYERS_PER_BATCH; z++)
+				{
+					uint32_t faceBits = visibility.GetFaceBits(slice, firstZ + z, face);
+					for (int x = 0; x < SIZE_X; x++)
+					{
+						mask[z * SIZE_X + x] = (faceBits >> (x + 1)) & 1u ? GetGreedyFaceKey(x + slice * SIZE_X + (firstZ + z) * BLOCKSPERLAYER, face) : 0;
+					}
+				}
+				MergeGreedyFaces(mask, SIZE_X, GEOMETRY_LAYERS_PER_BATCH, greedy, emitQuad);
+			}
 		}
-		else
+
+		// east (2) and west (4) in the y, z plane of each column
+		for (slice = 0; slice < SIZE_X; slice++)
 		{
-			return Rgba8::GREEN;
+			for (face = 2; face <= 4; face += 2)
+			{
+				for (int z = 0; z < GEOMETRY_LAYERS_PER_BATCH; z++)
+				{
+					for (int y = 0; y < SIZE_Y; y++)
+					{
+						uint32_t faceBits = visibility.GetFaceBits(y, firstZ + z, face);
+						mask[z * SIZE_Y + y] = (faceBits >> (slice + 1)) & 1u ? GetGreedyFaceKey(slice + y * SIZE_X + (firstZ + z) * BLOCKSPERLAYER, face) : 0;
+					}
+				}
+				MergeGreedyFaces(mask, SIZE_Y, GEOMETRY_LAYERS_PER_BATCH, greedy, emitQuad);
+			}
 		}
+	});
+}
+
+//--------------------------------------------------------------------------------
+// for a face the visibility bits show, a flag bit, the sprite's atlas row and column and the face light
+uint32_t Chunk::GetGreedyFaceKey(int index, int face)
+{
+	BlockDefinition const& definition = BlockDefinition::s_definitions[GetBlock(index)];
+	IntVec2 sprite = face == 0 ? definition.m_topSprite : (face == 5 ? definition.m_bottomSprite : definition.m_sideSprite);
+	Rgba8 light = GetFaceLight(index, face);
+	return 0x80000000u | ((uint32_t)(sprite.y & 63) << 22) | ((uint32_t)(sprite.x & 63) << 16) | ((uint32_t)light.r << 8) | (uint32_t)light.g;
+}
+
+//--------------------------------------------------------------------------------
+// chunk local corners of a width x height quad on a face of blocks in layer slice, in AddVertsForQuad3D order
+// (top left, bottom left, bottom right, top right) so each face keeps its texture orientation from CreateGeometry
+static void GetFaceQuadCorners(int face, int slice, int minA, int minB, int width, int height, Vec3* out_corners)
+{
+	Vec3 origin;
+	Vec3 axisA;
+	Vec3 axisB;
+	switch (face)
+	{
+	case 0: origin.z = (float)(slice + 1);	axisA = Vec3(1.0f, 0.0f, 0.0f); axisB = Vec3(0.0f, 1.0f, 0.0f); break;
+	case 5: origin.z = (float)slice;		axisA = Vec3(1.0f, 0.0f, 0.0f); axisB = Vec3(0.0f, 1.0f, 0.0f); break;
+	case 1: origin.y = (float)slice;		axisA = Vec3(1.0f, 0.0f, 0.0f); axisB = Vec3(0.0f, 0.0f, 1.0f); break;
+	case 3: origin.y = (float)(slice + 1);	axisA = Vec3(1.0f, 0.0f, 0.0f); axisB = Vec3(0.0f, 0.0f, 1.0f); break;
+	case 2: origin.x = (float)(slice + 1);	axisA = Vec3(0.0f, 1.0f, 0.0f); axisB = Vec3(0.0f, 0.0f, 1.0f); break;
+	case 4: origin.x = (float)slice;		axisA = Vec3(0.0f, 1.0f, 0.0f); axisB = Vec3(0.0f, 0.0f, 1.0f); break;
+	}
+	Vec3 minAminB = origin + axisA * (float)minA + axisB * (float)minB;
+	Vec3 minAmaxB = origin + axisA * (float)minA + axisB * (float)(minB + height);
+	Vec3 maxAminB = origin + axisA * (float)(minA + width) + axisB * (float)minB;
+	Vec3 maxAmaxB = origin + axisA * (float)(minA + width) + axisB * (float)(minB + height);
+
+	switch (face)
+	{
+	case 0: // top, u east, v north
+	case 1: // south, u east, v up
+	case 2: // east, u north, v up
+		out_corners[0] = minAmaxB; out_corners[1] = minAminB; out_corners[2] = maxAminB; out_corners[3] = maxAmaxB;
 		break;
-	case 4:
-		if (block.GetWestNeighbor().GetBlock())
-		{
-			color.r = (uint8_t)RangeMap(block.GetWestNeighbor().GetBlock()->GetOutdoorLight(), 0, MAX_LIGHT, 0, 255);
-			color.g = (uint8_t)RangeMap(block.GetWestNeighbor().GetBlock()->GetIndoorLight(), 0, MAX_LIGHT, 0, 255);
-		}
-		else
-		{
-			return Rgba8::GREEN;
-		}
+	case 3: // north, u west, v up
+	case 4: // west, u south, v up
+		out_corners[0] = maxAmaxB; out_corners[1] = maxAminB; out_corners[2] = minAminB; out_corners[3] = minAmaxB;
 		break;
-	case 5:
-		if (block.GetBottomNeighbor().GetBlock())
-		{
-			color.r = (uint8_t)RangeMap(block.GetBottomNeighbor().GetBlock()->GetOutdoorLight(), 0, MAX_LIGHT, 0, 255);
-			color.g = (uint8_t)RangeMap(block.GetBottomNeighbor().GetBlock()->GetIndoorLight(), 0, MAX_LIGHT, 0, 255);
-		}
-		else
-		{
-			return Rgba8::GREEN;
-		}
+	case 5: // bottom, u east, v south
+		out_corners[0] = minAminB; out_corners[1] = minAmaxB; out_corners[2] = maxAmaxB; out_corners[3] = maxAminB;
 		break;
 	}
-	return color; // to make compiler happy
 }
 
-bool Chunk::IsVisible(int index, int face)
+//--------------------------------------------------------------------------------
+// UVs count blocks across the quad and the vertex color carries the light in r, g and the sprite's atlas column, row
+// in b, a for the WorldGreedy shader to repeat
+void Chunk::AddGreedyQuad(std::vector<unsigned int>& indexes, std::vector<Vertex_PCU>& vertexes, int face, int slice, int minA, int minB, int width, int height, uint32_t key)
+{
+	Vec3 corners[4];
+	GetFaceQuadCorners(face, slice, minA, minB, width, height, corners);
+	Rgba8 color((uint8_t)(key >> 8), (uint8_t)key, (uint8_t)((key >> 16) & 63), (uint8_t)((key >> 22) & 63));
+	AddVertsForQuad3D(indexes, vertexes, m_worldBounds.m_mins + corners[0], m_worldBounds.m_mins + corners[1], m_worldBounds.m_mins + corners[2],
+		m_worldBounds.m_mins + corners[3], color, AABB2(0.0f, 0.0f, (float)width, (float)height));
+}
+
+//--------------------------------------------------------------------------------
+// chunk local corners and the face, the WorldVoxel shader offsets them by the model matrix and derives the UVs from them,
+// the color is the same as AddGreedyQuad's
+void Chunk::AddPackedQuad(std::vector<unsigned int>& indexes, std::vector<Vertex_Voxel>& vertexes, int face, int slice, int minA, int minB, int width, int height, uint32_t key)
+{
+	Vec3 corners[4];
+	GetFaceQuadCorners(face, slice, minA, minB, width, height, corners);
+	Rgba8 color((uint8_t)(key >> 8), (uint8_t)key, (uint8_t)((key >> 16) & 63), (uint8_t)((key >> 22) & 63));
+	unsigned int vertexBase = static_cast<unsigned int>(vertexes.size());
+	for (int corner = 0; corner < 4; corner++)
+	{
+		vertexes.push_back(Vertex_Voxel((uint8_t)corners[corner].x, (uint8_t)corners[corner].y, (uint8_t)corners[corner].z, (uint8_t)face, color));
+	}
+	indexes.push_back(vertexBase);
+	indexes.push_back(vertexBase + 1);
+	indexes.push_back(vertexBase + 2);
+	indexes.push_back(vertexBase);
+	indexes.push_back(vertexBase + 2);
+	indexes.push_back(vertexBase + 3);
+}
+
+//--------------------------------------------------------------------------------
+// light of the block a showing face looks into, read straight from the block arrays, green past the top and bottom
+// a side face on the border only shows when the neighbor is loaded, so its border slab is always there to read
+Rgba8 Chunk::GetFaceLight(int index, int face)
 {
-	bool visible = false;
 	int x = index & MASK_X;
 	int y = (index >> BITS_X) & MASK_Y;
 	int z = (index >> (BITS_X + BITS_Y)) & MASK_Z;
-
+	uint8_t light = 0; // of the neighbor the face looks into
 	switch (face)
 	{
 	case 0:  // top
 		if (z == MASK_Z)
 		{
-			visible = true;
-		}
-		else
-		{
-			visible = !BlockDefinition::s_definitions[GetBlock(x, y, z + 1)].m_visible;
+			return Rgba8::GREEN;
 		}
+		light = m_blocks.m_light[index + BLOCKSPERLAYER];
 		break;
 	case 1:  // south
-		if (y == 0)
-		{
-			visible = m_neighbors[SOUTH] && !BlockDefinition::s_definitions[m_neighbors[SOUTH]->GetBlock(x, MASK_Y, z)].m_visible;
-		}
-		else
-		{
-			visible = !BlockDefinition::s_definitions[GetBlock(x, y - 1, z)].m_visible;
-		}
+		light = y == 0 ? m_neighbors[SOUTH]->m_blocks.m_light[index | (MASK_Y << BITS_X)] : m_blocks.m_light[index - SIZE_X];
 		break;
 	case 2:  // east
-		if (x == MASK_X)
-		{
-			visible = m_neighbors[EAST] && !BlockDefinition::s_definitions[m_neighbors[EAST]->GetBlock(0, y, z)].m_visible;
-		}
-		else
-		{
-			visible = !BlockDefinition::s_definitions[GetBlock(x + 1, y, z)].m_visible;
-		}		
+		light = x == MASK_X ? m_neighbors[EAST]->m_blocks.m_light[index & ~MASK_X] : m_blocks.m_light[index + 1];
 		break;
 	case 3:  // north
-		if (y == MASK_Y)
-		{
-			visible = m_neighbors[NORTH] && !BlockDefinition::s_definitions[m_neighbors[NORTH]->GetBlock(x, 0, z)].m_visible;
-		}
-		else
-		{
-			visible = !BlockDefinition::s_definitions[GetBlock(x, y + 1, z)].m_visible;
-		}		
+		light = y == MASK_Y ? m_neighbors[NORTH]->m_blocks.m_light[index & ~(MASK_Y << BITS_X)] : m_blocks.m_light[index + SIZE_X];
 		break;
 	case 4:  // west
-		if (x == 0)
-		{
-			visible = m_neighbors[WEST] && !BlockDefinition::s_definitions[m_neighbors[WEST]->GetBlock(MASK_X, y, z)].m_visible;
-		}
-		else
-		{
-			visible = !BlockDefinition::s_definitions[GetBlock(x - 1, y, z)].m_visible;
-		}
+		light = x == 0 ? m_neighbors[WEST]->m_blocks.m_light[index | MASK_X] : m_blocks.m_light[index - 1];
 		break;
-	case 5:  // bottom
+	default: // bottom
 		if (z == 0)
 		{
-			visible = true;
-		}
-		else
-		{
-			visible = !BlockDefinition::s_definitions[GetBlock(x, y, z - 1)].m_visible;
+			return Rgba8::GREEN;
 		}
+		light = m_blocks.m_light[index - BLOCKSPERLAYER];
 		break;
 	}
-	return visible;
+	return Rgba8((uint8_t)RangeMap((light >> 4) & 0x0F, 0, MAX_LIGHT, 0, 255), (uint8_t)RangeMap(light & 0x0F, 0, MAX_LIGHT, 0, 255), 127);
 }
 
 AABB3 Chunk::GetBlockBounds(int index)
@@ -903,8 +1336,16 @@ void Chunk::Render()
 
 	Texture* terrainTexture = g_theRenderer->CreateOrGetTextureFromFile((char const*)"Data/Images/BasicSprites_64x64.png");
 	g_theRenderer->BindTexture(terrainTexture);
-	g_theRenderer->SetModelMatrix(Mat44());
-	g_theRenderer->BindShaderByName("Data/Shaders/World");
+	if (m_isPackedMesh)
+	{
+		g_theRenderer->SetModelMatrix(Mat44::CreateTranslation3D(m_worldBounds.m_mins));
+		g_theRenderer->BindShaderByName("Data/Shaders/WorldVoxel");
+	}
+	else
+	{
+		g_theRenderer->SetModelMatrix(Mat44());
+		g_theRenderer->BindShaderByName(m_isGreedyMesh ? "Data/Shaders/WorldGreedy" : "Data/Shaders/World");
+	}
 
 	if (indexedDraw)
 	{
@@ -934,11 +1375,11 @@ void Chunk::WriteChunkToDisc()
 	outBuffer.push_back(7);
 
 	// Concatenate RLE runs
-	uint8_t blocktype = m_block[0].GetBlockDefinition();
+	uint8_t blocktype = GetBlock(0);
 	uint8_t count = 1;
 	for (int index = 1; index < BLOCKSPERCHUNK; index++)
 	{
-		if (m_block[index].GetBlockDefinition() == blocktype)
+		if (GetBlock(index) == blocktype)
 		{
 			count++;
 			if (count == 255)
@@ -955,7 +1396,7 @@ void Chunk::WriteChunkToDisc()
 				outBuffer.push_back(blocktype);
 				outBuffer.push_back(count);
 			}
-			blocktype = m_block[index].GetBlockDefinition();
+			blocktype = GetBlock(index);
 			count = 1;
 		}
 	}
@@ -998,17 +1439,18 @@ void Chunk::ReadChunkFromDisc(const char* filename)
 	int index = 0;
 	uint8_t blockType = AIR;
 	uint8_t count = 0;
+	m_blocks.Expand();
 	for (int offset = 8; offset < (int)outBuffer.size(); offset += 2)
 	{
 		blockType = outBuffer[offset];
 		count = outBuffer[offset + 1];
 		for (int i = 0; i < count; i++)
 		{
-			m_block[index].SetBlockDefinition(blockType);
-			m_block[index].InitializeFlags();
+			SetBlock(index, blockType);
 			index++;
 		}
 	}
+	m_blocks.Compact();
 	if (index != BLOCKSPERCHUNK)
 	{
 	DebuggerPrintf("Error decoding chunk data [%f, %f] index = %i\n", m_chunkCoords.x, m_chunkCoords.y, index);
@@ -1024,13 +1466,13 @@ void Chunk::LinkNeighbors(World const& world)
 	{
 		neighbor->m_neighbors[SOUTH] = this;
 		m_neighbors[NORTH] = neighbor;
-		neighbor->m_needsMesh = true;
-		m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
+		MarkNeedsMesh();
 	}
 	else
 	{
 		m_neighbors[NORTH] = nullptr;
-		m_needsMesh = true;
+		MarkNeedsMesh();
 	}
 
 	neighbor = world.GetMappedValue(m_chunkCoords.x + 1, m_chunkCoords.y);
@@ -1038,13 +1480,13 @@ void Chunk::LinkNeighbors(World const& world)
 	{
 		neighbor->m_neighbors[WEST] = this;
 		m_neighbors[EAST] = neighbor;
-		neighbor->m_needsMesh = true;
-		m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
+		MarkNeedsMesh();
 	}
 	else
 	{
 		m_neighbors[EAST] = nullptr;
-		m_needsMesh = true;
+		MarkNeedsMesh();
 	}
 
 	neighbor = world.GetMappedValue(m_chunkCoords.x, m_chunkCoords.y - 1);
@@ -1052,13 +1494,13 @@ void Chunk::LinkNeighbors(World const& world)
 	{
 		neighbor->m_neighbors[NORTH] = this;
 		m_neighbors[SOUTH] = neighbor;
-		neighbor->m_needsMesh = true;
-		m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
+		MarkNeedsMesh();
 	}
 	else
 	{
 		m_neighbors[SOUTH] = nullptr;
-		m_needsMesh = true;
+		MarkNeedsMesh();
 	}
 
 	neighbor = world.GetMappedValue(m_chunkCoords.x - 1, m_chunkCoords.y);
@@ -1066,13 +1508,13 @@ void Chunk::LinkNeighbors(World const& world)
 	{
 		neighbor->m_neighbors[EAST] = this;
 		m_neighbors[WEST] = neighbor;
-		neighbor->m_needsMesh = true;
-		m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
+		MarkNeedsMesh();
 	}
 	else
 	{
 		m_neighbors[WEST] = nullptr;
-		m_needsMesh = true;
+		MarkNeedsMesh();
 	}
 }
 
@@ -1091,119 +1533,93 @@ void Chunk::Activate(World & world)
 	{
 	// create basic rendering stuff for now
 	// m_dirty = false;
-	m_needsMesh = true; // starts dirty to force mesh generation
+	MarkNeedsMesh(); // starts dirty to force mesh generation
 	LinkNeighbors(world);
+	InitializeLighting(world.m_lighting);
+}
 
-	// set block lighting
-	int index = 0;
-	for (int y = 0; y < SIZE_Y; y++)
+//--------------------------------------------------------------------------------
+// full outdoor light above each column's top opaque block and light sources at their own light, then only the light that
+// reaches further queued to spread: the sky beside a column with a higher top, here or in a linked neighbor, light sources,
+// and the border light of linked neighbors brighter than the open block across from it
+void Chunk::InitializeLighting(ChunkLighting& lighting)
+{
+	m_blocks.ComputeSkyHeights();
+	for (int column = 0; column < BLOCKSPERLAYER; column++)
 	{
-		for (int x = 0; x < SIZE_X; x++)
+		for (int z = m_blocks.GetSkyHeight(column); z < SIZE_Z; z++)
 		{
-			int z = MASK_Z;
-			while (z >= 0 && GetBlock(x, y, z) == AIR)
-			{
-				index = z << (BITS_X + BITS_Y) | y << BITS_X | x;
-				m_block[index].SetSky(true);
-				z--;
-			}
-			// mark all non-opaque edge blocks as light dirty (including sky blocks)
-			if ((x == 0 && m_neighbors[WEST]) || (x == MASK_X && m_neighbors[EAST]) || (y == 0 && m_neighbors[SOUTH]) || (y == MASK_Y && m_neighbors[NORTH]))
-			{
-				for (z = MASK_Z; z >= 0; z--)
-				{
-					index = z << (BITS_X + BITS_Y) | y << BITS_X | x;
-					if (m_block[index].IsOpaque() == false)
-					{
-						world.MarkLightingDirty(this, index);
-					}
-				}
-			}
+			m_blocks.SetOutdoorLight(z << (BITS_X + BITS_Y) | column, MAX_LIGHT);
 		}
 	}
 
+	uint8_t sectionType = AIR;
 	for (int y = 0; y < SIZE_Y; y++)
 	{
 		for (int x = 0; x < SIZE_X; x++)
 		{
-			int z = MASK_Z;
-			// mark sky blocks as maximum light intensity
-			while (z >= 0 && GetBlock(x, y, z) == AIR)
+			int column = y << BITS_X | x;
+			int skyHeight = m_blocks.GetSkyHeight(column);
+			int sideHeight = 0;
+			int const sideHeights[4] = {
+				y < MASK_Y ? m_blocks.GetSkyHeight(column + SIZE_X) : (m_neighbors[NORTH] ? m_neighbors[NORTH]->m_blocks.GetSkyHeight(x) : 0),
+				x < MASK_X ? m_blocks.GetSkyHeight(column + 1) : (m_neighbors[EAST] ? m_neighbors[EAST]->m_blocks.GetSkyHeight(y << BITS_X) : 0),
+				y > 0 ? m_blocks.GetSkyHeight(column - SIZE_X) : (m_neighbors[SOUTH] ? m_neighbors[SOUTH]->m_blocks.GetSkyHeight(MASK_Y << BITS_X | x) : 0),
+				x > 0 ? m_blocks.GetSkyHeight(column - 1) : (m_neighbors[WEST] ? m_neighbors[WEST]->m_blocks.GetSkyHeight(y << BITS_X | MASK_X) : 0) };
+			for (int direction = 0; direction < 4; direction++)
 			{
-				index = z << (BITS_X + BITS_Y) | y << BITS_X | x;
-				m_block[index].SetOutdoorLight(MAX_LIGHT);
-				// mark neighbors dirty
-				if (x == 0)
-				{
-					if (m_neighbors[WEST])
-					{
-						index = z << (BITS_X + BITS_Y) | y << BITS_X | MASK_X;
-						world.MarkLightingDirty(m_neighbors[WEST], index);
-					}
-				}
-				else
-				{
-					index = z << (BITS_X + BITS_Y) | y << BITS_X | (x - 1);
-					world.MarkLightingDirty(this, index);
-				}
+				sideHeight = sideHeights[direction] > sideHeight ? sideHeights[direction] : sideHeight;
+			}
+			for (int z = skyHeight; z < sideHeight; z++)
+			{
+				lighting.QueueSpread(this, z << (BITS_X + BITS_Y) | column, LIGHT_OUTDOOR);
+			}
 
-				if (x == MASK_X)
+			// light-emitting blocks, skipping sections of a single type that emits none
+			for (int z = skyHeight - 1; z >= 0; z--)
+			{
+				if (m_blocks.IsUniformSection(z >> BITS_SECTION_Z, sectionType) && BlockDefinition::s_definitions[sectionType].m_light == 0)
 				{
-					if (m_neighbors[EAST])
-					{
-						index = z << (BITS_X + BITS_Y) | y << BITS_X | 0;
-						world.MarkLightingDirty(m_neighbors[EAST], index);
-					}
+					z &= ~(SECTION_LAYERS - 1);
+					continue;
 				}
-				else
+				int index = z << (BITS_X + BITS_Y) | column;
+				if (m_blocks.GetLightEmitted(index) > 0)
 				{
-					index = z << (BITS_X + BITS_Y) | y << BITS_X | (x + 1);
-					world.MarkLightingDirty(this, index);
+					m_blocks.SetIndoorLight(index, m_blocks.GetLightEmitted(index));
+					lighting.QueueSpread(this, index, LIGHT_INDOOR);
 				}
+			}
+		}
+	}
 
-				if (y == 0)
-				{
-					if (m_neighbors[SOUTH])
-					{
-						index = z << (BITS_X + BITS_Y) | MASK_X << BITS_X | x;
-						world.MarkLightingDirty(m_neighbors[SOUTH], index);
-					}
-				}
-				else
+	// the neighbors' light coming in across each border
+	for (int direction = 0; direction < 4; direction++)
+	{
+		Chunk* neighbor = m_neighbors[direction];
+		for (int edge = 0; neighbor && edge < SIZE_X; edge++)
+		{
+			int column = direction == NORTH ? MASK_Y << BITS_X | edge : (direction == EAST ? edge << BITS_X | MASK_X : (direction == SOUTH ? edge : edge << BITS_X));
+			int neighborColumn = direction == NORTH ? edge : (direction == EAST ? edge << BITS_X : (direction == SOUTH ? MASK_Y << BITS_X | edge : edge << BITS_X | MASK_X));
+			for (int z = 0; z < SIZE_Z; z++)
+			{
+				int index = z << (BITS_X + BITS_Y) | column;
+				int neighborIndex = z << (BITS_X + BITS_Y) | neighborColumn;
+				if (m_blocks.IsOpaque(index))
 				{
-					index = z << (BITS_X + BITS_Y) | (y - 1) << BITS_Y | x;
-					world.MarkLightingDirty(this, index);
+					continue;
 				}
-
-				if (y == MASK_Y)
+				if (neighbor->m_blocks.GetIndoorLight(neighborIndex) > m_blocks.GetIndoorLight(index) + 1)
 				{
-					if (m_neighbors[NORTH])
-					{
-						index = z << (BITS_X + BITS_Y) | 0 << BITS_Y | x;
-						world.MarkLightingDirty(m_neighbors[NORTH], index);
-					}
+					lighting.QueueSpread(neighbor, neighborIndex, LIGHT_INDOOR);
 				}
-				else
+				if (neighbor->m_blocks.GetOutdoorLight(neighborIndex) > m_blocks.GetOutdoorLight(index) + 1)
 				{
-					index = z << (BITS_X + BITS_Y) | (y + 1) << BITS_Y | x;
-					world.MarkLightingDirty(this, index);
+					lighting.QueueSpread(neighbor, neighborIndex, LIGHT_OUTDOOR);
 				}
-
-				z--;
 			}
-
-			// mark light-emitting blocks dirty
-			for (; z >= 0; z--)
-			{
-				index = z << (BITS_X + BITS_Y) | y << BITS_X | x;
-				if (m_block[index].GetLightEmitted() > 0)
-				{
-					world.MarkLightingDirty(this, index);
-				}
- 			}
 		}
 	}
-
 }
 
 void Chunk::Deactivate()
@@ -1240,26 +1656,57 @@ AABB2 Chunk::GetChunkWorldBounds(int x, int y)
 	return bounds;
 }
 
-void Chunk::TestNeighborNeedsMesh(int x, int y)
+// only the neighbor's section at z shows faces against the edited block
+void Chunk::TestNeighborNeedsMesh(int x, int y, int z)
 {
+	uint8_t section = (uint8_t)(1 << (z >> BITS_SECTION_Z));
 	if (x == 0 && m_neighbors[WEST])
 	{
-		m_neighbors[WEST]->m_needsMesh = true;
+		m_neighbors[WEST]->m_sectionsNeedingMesh |= section;
 	}
 	if (x == MASK_X && m_neighbors[EAST])
 	{
-		m_neighbors[EAST]->m_needsMesh = true;
+		m_neighbors[EAST]->m_sectionsNeedingMesh |= section;
 	}
 	if (y == 0 && m_neighbors[SOUTH])
 	{
-		m_neighbors[SOUTH]->m_needsMesh = true;
+		m_neighbors[SOUTH]->m_sectionsNeedingMesh |= section;
 	}
 	if (y == MASK_Y && m_neighbors[NORTH])
 	{
-		m_neighbors[NORTH]->m_needsMesh = true;
+		m_neighbors[NORTH]->m_sectionsNeedingMesh |= section;
+	}
+}
+
+void Chunk::MarkNeedsMesh()
+{
+	m_sectionsNeedingMesh = ALL_SECTIONS;
+}
+
+//--------------------------------------------------------------------------------
+// the block's section, and the section next to it when the block is on its top or bottom layer, since the faces there
+// look into the block
+void Chunk::MarkBlockNeedsMesh(int index)
+{
+	int z = index >> (BITS_X + BITS_Y);
+	int section = z >> BITS_SECTION_Z;
+	int sectionZ = z & (SECTION_LAYERS - 1);
+	m_sectionsNeedingMesh |= (uint8_t)(1 << section);
+	if (sectionZ == 0 && section > 0)
+	{
+		m_sectionsNeedingMesh |= (uint8_t)(1 << (section - 1));
+	}
+	if (sectionZ == SECTION_LAYERS - 1 && section < SECTIONSPERCHUNK - 1)
+	{
+		m_sectionsNeedingMesh |= (uint8_t)(1 << (section + 1));
 	}
 }
 
+bool Chunk::NeedsMesh() const
+{
+	return m_sectionsNeedingMesh != 0;
+}
+
 uint8_t Chunk::ConvertToBlock(BuildingBlock variableBlock)
 {
 	// setting up arrays for larger number of choices would be good some day
@@ -1,6 +1,8 @@
 #pragma once
 #include "Game/GameCommon.hpp"
-#include "Game/Block.hpp"
+#include "Game/ChunkBlocks.hpp"
+#include "Game/ChunkLighting.hpp"
+#include "Engine/Core/Vertex_Voxel.hpp"
 #include <vector>
 #include "BlockIterator.hpp"
 #include <atomic>
@@ -8,6 +10,7 @@
 
 class World;
 class BlockTemplate;
+class NoiseTileCache;
 struct BlockPosition;
 
 enum ChunkState
@@ -27,15 +30,41 @@ enum JobType
 	JOB_CREATE = 1,
 	JOB_LOAD = 2,
 	JOB_SAVE = 4,
+	JOB_MESH = 8,
 	JOB_TEST = 0xFFFF,		// this is job wild card
 };
 
+// seconds spent in each phase of Chunk::Create, added to when the caller passes one in (terrain benchmark)
+struct ChunkGenerationTimes
+{
+	double m_noiseSeconds = 0.0;
+	double m_columnSeconds = 0.0;
+	double m_treeSeconds = 0.0;
+	double m_villageSeconds = 0.0;
+};
+
+// the mesh of one batch of GEOMETRY_LAYERS_PER_BATCH layers, kept so a remesh only rebuilds the sections that changed
+struct ChunkBatchMesh
+{
+	std::vector<Vertex_PCU> m_vertexes;
+	std::vector<Vertex_Voxel> m_packedVertexes;
+	std::vector<unsigned int> m_indexes;
+};
+
+constexpr int BATCHES_PER_SECTION = SECTION_LAYERS / GEOMETRY_LAYERS_PER_BATCH;
+constexpr uint8_t ALL_SECTIONS = (uint8_t)((1 << SECTIONSPERCHUNK) - 1);
+static_assert(SECTIONSPERCHUNK <= 8, "m_sectionsNeedingMesh holds a bit per section");
+static_assert(SECTION_LAYERS % GEOMETRY_LAYERS_PER_BATCH == 0, "a section is meshed as whole batches");
+
 class Chunk
 {
 public:
 	virtual ~Chunk();
 	Chunk();
 	bool Create();
+	bool Create(JobSystem& jobSystem, ChunkGenerationTimes* out_times = nullptr, NoiseTileCache* cache = nullptr);
+	void GenerateNoise(JobSystem& jobSystem, NoiseTileCache* cache = nullptr);
+	void FillColumns(int baseX, int baseY);
 	void CopyTreeTemplateToWorld(BlockTemplate const* tree, int terrainHeight, int dx, int dy);
 	void CreateTrees(int baseX, int baseY);
 	void CreateVillage(int baseX, int baseY);
@@ -44,14 +73,20 @@ public:
 	bool TestVillageForChunk(int x, int y);
 	uint8_t GetBlock(int x, int y, int z);
 	uint8_t GetBlock(int index);
-	Block* GetBlockPtr(int index);
 	void SetBlock(int x, int y, int z, uint8_t value);
 	void SetBlock(int index, uint8_t value);
 	void SetBlock(IntVec3 position, uint8_t value);
 	void CreateBuffers();
 	void CreateGeometry();
-	Rgba8 BlockFaceLight(BlockIterator block, int face);
-	bool IsVisible(int blockIndex, int face);
+	void CreateGeometry(JobSystem& jobSystem, bool greedy = false, bool packed = false);
+	void CreateSectionGeometry(JobSystem& jobSystem, bool greedy, bool packed);
+	void CreateMaskedGeometry(JobSystem& jobSystem, bool greedy, bool packed);
+	void AssembleMesh();
+	uint32_t GetGreedyFaceKey(int index, int face);
+	void AddGreedyQuad(std::vector<unsigned int>& indexes, std::vector<Vertex_PCU>& vertexes, int face, int slice, int minA, int minB, int width, int height, uint32_t key);
+	void TakeMesh(Chunk& meshed);
+	void AddPackedQuad(std::vector<unsigned int>& indexes, std::vector<Vertex_Voxel>& vertexes, int face, int slice, int minA, int minB, int width, int height, uint32_t key);
+	Rgba8 GetFaceLight(int blockIndex, int face);
 	AABB3 GetBlockBounds(int index);
 	AABB3 GetBlockBounds(int x, int y, int z);
 
@@ -62,22 +97,35 @@ public:
 	void LinkNeighbors(World const& world);
 	void Initialize(IntVec2 worldChunkCoords);
 	void Activate(World& world);
+	void InitializeLighting(ChunkLighting& lighting);
 	void Deactivate();
 
 	static IntVec2 GetChunkForWorldPosition(Vec3 position);
 	static int GetBlockForPosition(Vec3 position);
 	static AABB2 GetChunkWorldBounds(int x, int y);
-	void TestNeighborNeedsMesh(int x, int y);
+	void TestNeighborNeedsMesh(int x, int y, int z);
+	void MarkNeedsMesh();
+	void MarkBlockNeedsMesh(int index);
+	bool NeedsMesh() const;
 	uint8_t ConvertToBlock(BuildingBlock variableBlock);
 
+	static bool s_greedyMeshing; // merge coplanar faces with the same sprite and light into larger quads, drawn with the WorldGreedy shader
+	static bool s_packedVertexes; // mesh into 8 byte Vertex_Voxel instead of Vertex_PCU, drawn with the WorldVoxel shader
+
 	bool m_dirty = false;
-	bool m_needsMesh = true;
+	uint8_t m_sectionsNeedingMesh = ALL_SECTIONS; // a bit per section whose batch meshes are stale, cleared by whoever meshes the chunk
+	bool m_isGreedyMesh = false; // the current vertexes are merged quads
+	bool m_isPackedMesh = false; // the current mesh is in m_packedVertexes
+	Job* m_meshJob = nullptr; // a ChunkMeshJob is building from a snapshot of this chunk, only the main thread touches this
 //	std::atomic<int> m_status;
 	std::atomic<ChunkState> m_status = CHUNK_INITIALIZING;
 	std::vector<Vertex_PCU> m_vertexes;
+	std::vector<Vertex_Voxel> m_packedVertexes;
 	std::vector<unsigned int> m_indexes;
 	int m_indexCount = 0;
-	Block* m_block = nullptr;
+	ChunkBatchMesh m_batchMeshes[GEOMETRY_BATCHES]; // appended in order into the vectors above
+	ChunkBlocks m_blocks;
+	ChunkLightQueue m_lightQueue; // only ChunkLighting touches it
 	IntVec2 m_chunkCoords = IntVec2::ZERO;
 	AABB3 m_worldBounds = AABB3::ZERO_TO_ONE;
 	Chunk* m_neighbors[4] = { 0 };
@@ -0,0 +1,398 @@
+#include "Game/ChunkBlocks.hpp"
+#include "Game/Chunk.hpp"
+#include "Game/Game.hpp"
+#include "Game/World.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include <string.h>
+
+bool ChunkBlocks::s_paletteSections = true;
+
+//--------------------------------------------------------------------
+void ChunkBlockMemory::Add(ChunkBlockMemory const& add)
+{
+	m_chunkCount += add.m_chunkCount;
+	m_typeBytes += add.m_typeBytes;
+	m_lightBytes += add.m_lightBytes;
+	m_flagBytes += add.m_flagBytes;
+	for (int encoding = 0; encoding < 5; encoding++)
+	{
+		m_sectionCounts[encoding] += add.m_sectionCounts[encoding];
+	}
+}
+
+//--------------------------------------------------------------------
+size_t ChunkBlockMemory::GetTotalBytes() const
+{
+	return m_typeBytes + m_lightBytes + m_flagBytes;
+}
+
+//--------------------------------------------------------------------
+// all air and unlit, as a default constructed Block was, with no sky until the chunk is lit
+ChunkBlocks::ChunkBlocks()
+{
+	memset(m_light, 0, sizeof(m_light));
+	memset(m_skyHeights, SIZE_Z, sizeof(m_skyHeights));
+}
+
+//--------------------------------------------------------------------
+uint8_t ChunkBlocks::GetType(int index) const
+{
+	if (!m_expandedTypes.empty())
+	{
+		return m_expandedTypes[index];
+	}
+	Section const& section = m_sections[index >> BITS_SECTION];
+	if (section.m_bits == 0)
+	{
+		return section.m_uniformType;
+	}
+	int bit = (index & (BLOCKSPERSECTION - 1)) * section.m_bits;
+	uint8_t value = (uint8_t)((section.m_words[bit >> 6] >> (bit & 63)) & ((1u << section.m_bits) - 1u));
+	return section.m_bits == 8 ? value : section.m_palette[value];
+}
+
+//--------------------------------------------------------------------
+// a type the section cannot index yet re-encodes it, at most four times per section between compactions
+void ChunkBlocks::SetType(int index, uint8_t type)
+{
+	if (!m_expandedTypes.empty())
+	{
+		m_expandedTypes[index] = type;
+		return;
+	}
+	Section& section = m_sections[index >> BITS_SECTION];
+	int value = -1;
+	if (section.m_bits == 0)
+	{
+		if (section.m_uniformType == type)
+		{
+			return;
+		}
+	}
+	else if (section.m_bits == 8)
+	{
+		value = type;
+	}
+	else
+	{
+		for (int paletteIndex = 0; paletteIndex < (int)section.m_palette.size(); paletteIndex++)
+		{
+			if (section.m_palette[paletteIndex] == type)
+			{
+				value = paletteIndex;
+				break;
+			}
+		}
+		if (value < 0 && (int)section.m_palette.size() < (1 << section.m_bits))
+		{
+			value = (int)section.m_palette.size();
+			section.m_palette.push_back(type);
+		}
+	}
+
+	int localIndex = index & (BLOCKSPERSECTION - 1);
+	if (value < 0)
+	{
+		uint8_t types[BLOCKSPERSECTION];
+		DecodeSection(section, types);
+		types[localIndex] = type;
+		EncodeSection(section, types, s_paletteSections);
+		return;
+	}
+
+	int bit = localIndex * section.m_bits;
+	uint64_t mask = (uint64_t)((1u << section.m_bits) - 1u) << (bit & 63);
+	uint64_t& word = section.m_words[bit >> 6];
+	word = (word & ~mask) | ((uint64_t)value << (bit & 63));
+}
+
+//--------------------------------------------------------------------
+bool ChunkBlocks::IsUniformSection(int section, uint8_t& out_type) const
+{
+	out_type = m_sections[section].m_uniformType;
+	return m_sections[section].m_bits == 0 && m_expandedTypes.empty();
+}
+
+//--------------------------------------------------------------------
+void ChunkBlocks::Expand()
+{
+	if (!m_expandedTypes.empty())
+	{
+		return;
+	}
+	m_expandedTypes.resize(BLOCKSPERCHUNK);
+	for (int section = 0; section < SECTIONSPERCHUNK; section++)
+	{
+		DecodeSection(m_sections[section], &m_expandedTypes[section * BLOCKSPERSECTION]);
+	}
+}
+
+//--------------------------------------------------------------------
+void ChunkBlocks::Compact()
+{
+	uint8_t types[BLOCKSPERSECTION];
+	for (int section = 0; section < SECTIONSPERCHUNK; section++)
+	{
+		if (m_expandedTypes.empty())
+		{
+			DecodeSection(m_sections[section], types);
+			EncodeSection(m_sections[section], types, s_paletteSections);
+		}
+		else
+		{
+			EncodeSection(m_sections[section], &m_expandedTypes[section * BLOCKSPERSECTION], s_paletteSections);
+		}
+	}
+	std::vector<uint8_t>().swap(m_expandedTypes);
+}
+
+//--------------------------------------------------------------------
+// the section vectors keep their capacity, so a reused copy (a ChunkMeshSnapshot) rarely allocates
+void ChunkBlocks::CopyTypesFrom(ChunkBlocks const& copyFrom)
+{
+	for (int section = 0; section < SECTIONSPERCHUNK; section++)
+	{
+		m_sections[section].m_bits = copyFrom.m_sections[section].m_bits;
+		m_sections[section].m_uniformType = copyFrom.m_sections[section].m_uniformType;
+		m_sections[section].m_palette.assign(copyFrom.m_sections[section].m_palette.begin(), copyFrom.m_sections[section].m_palette.end());
+		m_sections[section].m_words.assign(copyFrom.m_sections[section].m_words.begin(), copyFrom.m_sections[section].m_words.end());
+	}
+	m_expandedTypes.assign(copyFrom.m_expandedTypes.begin(), copyFrom.m_expandedTypes.end());
+}
+
+//--------------------------------------------------------------------
+ChunkBlockMemory ChunkBlocks::GetMemory() const
+{
+	ChunkBlockMemory memory;
+	memory.m_chunkCount = 1;
+	memory.m_typeBytes = sizeof(m_sections) + m_expandedTypes.capacity();
+	memory.m_lightBytes = sizeof(m_light);
+	memory.m_flagBytes = sizeof(m_skyHeights);
+	for (Section const& section : m_sections)
+	{
+		memory.m_typeBytes += section.m_palette.capacity() * sizeof(uint8_t) + section.m_words.capacity() * sizeof(uint64_t);
+		int encoding = section.m_bits == 0 ? 0 : (section.m_bits == 1 ? 1 : (section.m_bits == 2 ? 2 : (section.m_bits == 4 ? 3 : 4)));
+		memory.m_sectionCounts[encoding]++;
+	}
+	return memory;
+}
+
+//--------------------------------------------------------------------
+void ChunkBlocks::DecodeSection(Section const& section, uint8_t* out_types)
+{
+	if (section.m_bits == 0)
+	{
+		memset(out_types, section.m_uniformType, BLOCKSPERSECTION);
+		return;
+	}
+	int bits = section.m_bits;
+	uint64_t valueMask = (1ull << bits) - 1ull;
+	int valuesPerWord = 64 / bits;
+	uint8_t const* palette = section.m_palette.data();
+	for (int word = 0; word < (int)section.m_words.size(); word++)
+	{
+		uint64_t packed = section.m_words[word];
+		for (int value = 0; value < valuesPerWord; value++, packed >>= bits)
+		{
+			*out_types++ = bits == 8 ? (uint8_t)packed : palette[packed & valueMask];
+		}
+	}
+}
+
+//--------------------------------------------------------------------
+// the palette is in order of first use, so the same types always encode the same way
+void ChunkBlocks::EncodeSection(Section& section, uint8_t const* types, bool usePalette)
+{
+	std::vector<uint8_t> palette;
+	int bits = 8;
+	if (usePalette)
+	{
+		bool isInPalette[256] = {};
+		for (int index = 0; index < BLOCKSPERSECTION && palette.size() <= 16; index++)
+		{
+			if (!isInPalette[types[index]])
+			{
+				isInPalette[types[index]] = true;
+				palette.push_back(types[index]);
+			}
+		}
+
+		if (palette.size() == 1)
+		{
+			section.m_bits = 0;
+			section.m_uniformType = types[0];
+			std::vector<uint8_t>().swap(section.m_palette);
+			std::vector<uint64_t>().swap(section.m_words);
+			return;
+		}
+		bits = palette.size() <= 2 ? 1 : (palette.size() <= 4 ? 2 : (palette.size() <= 16 ? 4 : 8));
+	}
+
+	uint8_t paletteIndexes[256];
+	if (bits == 8)
+	{
+		palette.clear();
+		for (int type = 0; type < 256; type++)
+		{
+			paletteIndexes[type] = (uint8_t)type;
+		}
+	}
+	for (int paletteIndex = 0; paletteIndex < (int)palette.size(); paletteIndex++)
+	{
+		paletteIndexes[palette[paletteIndex]] = (uint8_t)paletteIndex;
+	}
+
+	section.m_bits = (uint8_t)bits;
+	section.m_palette.swap(palette);
+	size_t wordCount = BLOCKSPERSECTION * bits / 64;
+	if (section.m_words.size() != wordCount)
+	{
+		std::vector<uint64_t>(wordCount).swap(section.m_words);
+	}
+	int valuesPerWord = 64 / bits;
+	for (size_t word = 0; word < wordCount; word++)
+	{
+		uint64_t packed = 0;
+		for (int value = 0; value < valuesPerWord; value++)
+		{
+			packed |= (uint64_t)paletteIndexes[*types++] << (value * bits);
+		}
+		section.m_words[word] = packed;
+	}
+}
+
+//--------------------------------------------------------------------
+BlockDefinition const& ChunkBlocks::GetDefinition(int index) const
+{
+	return BlockDefinition::s_definitions[GetType(index)];
+}
+
+//--------------------------------------------------------------------
+bool ChunkBlocks::IsOpaque(int index) const
+{
+	return GetDefinition(index).m_opaque;
+}
+
+//--------------------------------------------------------------------
+bool ChunkBlocks::IsSolid(int index) const
+{
+	return GetDefinition(index).m_solid;
+}
+
+//--------------------------------------------------------------------
+uint8_t ChunkBlocks::GetLightEmitted(int index) const
+{
+	return (uint8_t)GetDefinition(index).m_light;
+}
+
+//--------------------------------------------------------------------
+uint8_t ChunkBlocks::GetIndoorLight(int index) const
+{
+	return m_light[index] & 0x0F;
+}
+
+//--------------------------------------------------------------------
+uint8_t ChunkBlocks::GetOutdoorLight(int index) const
+{
+	return (m_light[index] >> 4) & 0x0F;
+}
+
+//--------------------------------------------------------------------
+void ChunkBlocks::SetIndoorLight(int index, uint8_t indoor)
+{
+	m_light[index] = (m_light[index] & 0xF0) | (indoor & 0x0F);
+}
+
+//--------------------------------------------------------------------
+void ChunkBlocks::SetOutdoorLight(int index, uint8_t outdoor)
+{
+	m_light[index] = (m_light[index] & 0x0F) | ((outdoor & 0x0F) << 4);
+}
+
+//--------------------------------------------------------------------
+bool ChunkBlocks::IsSky(int index) const
+{
+	return (index >> (BITS_X + BITS_Y)) >= m_skyHeights[index & (BLOCKSPERLAYER - 1)];
+}
+
+//--------------------------------------------------------------------
+int ChunkBlocks::GetSkyHeight(int column) const
+{
+	return m_skyHeights[column];
+}
+
+//--------------------------------------------------------------------
+void ChunkBlocks::SetSkyHeight(int column, int z)
+{
+	m_skyHeights[column] = (uint8_t)z;
+}
+
+//--------------------------------------------------------------------
+// sections of air at the top are sky throughout without reading their blocks
+void ChunkBlocks::ComputeSkyHeights()
+{
+	int airLayers = 0;
+	uint8_t sectionType = AIR;
+	for (int section = SECTIONSPERCHUNK - 1; section >= 0 && IsUniformSection(section, sectionType) && !BlockDefinition::s_definitions[sectionType].m_opaque; section--)
+	{
+		airLayers += SECTION_LAYERS;
+	}
+	for (int column = 0; column < BLOCKSPERLAYER; column++)
+	{
+		int z = SIZE_Z - airLayers;
+		while (z > 0 && !IsOpaque((z - 1) << (BITS_X + BITS_Y) | column))
+		{
+			z--;
+		}
+		m_skyHeights[column] = (uint8_t)z;
+	}
+}
+
+//--------------------------------------------------------------------
+static ChunkBlockMemory GetActiveChunkBlockMemory(World const& world)
+{
+	ChunkBlockMemory memory;
+	for (Chunk const* chunk : world.m_chunks)
+	{
+		memory.Add(chunk->m_blocks.GetMemory());
+	}
+	return memory;
+}
+
+//--------------------------------------------------------------------
+static void PrintChunkBlockMemory(ChunkBlockMemory const& memory)
+{
+	int chunkCount = memory.m_chunkCount > 0 ? memory.m_chunkCount : 1;
+	double kilobytes = 1024.0 * (double)chunkCount;
+	std::string line = Stringf("block storage (%s): %i chunks, %.1f KB per chunk, types %.1f, light %.1f, flags %.1f, against %.1f KB as 3 byte blocks",
+		ChunkBlocks::s_paletteSections ? "palette sections" : "raw types", memory.m_chunkCount, (double)memory.GetTotalBytes() / kilobytes,
+		(double)memory.m_typeBytes / kilobytes, (double)memory.m_lightBytes / kilobytes, (double)memory.m_flagBytes / kilobytes, 3.0 * BLOCKSPERCHUNK / 1024.0);
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, line);
+	DebuggerPrintf("%s\n", line.c_str());
+	line = Stringf("        sections: %i uniform, %i 1 bit, %i 2 bit, %i 4 bit, %i raw", memory.m_sectionCounts[0], memory.m_sectionCounts[1],
+		memory.m_sectionCounts[2], memory.m_sectionCounts[3], memory.m_sectionCounts[4]);
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MINOR, line);
+	DebuggerPrintf("%s\n", line.c_str());
+}
+
+//--------------------------------------------------------------------
+// with palette= the active chunks are re-encoded and the storage is reported before and after
+bool Command_BlockMemory(EventArgs& args)
+{
+	if (g_theGame == nullptr || g_theGame->m_world == nullptr)
+	{
+		return false;
+	}
+	World& world = *g_theGame->m_world;
+	PrintChunkBlockMemory(GetActiveChunkBlockMemory(world));
+	if (!args.GetValue("palette", "").empty())
+	{
+		ChunkBlocks::s_paletteSections = args.GetValue("palette", ChunkBlocks::s_paletteSections);
+		for (Chunk* chunk : world.m_chunks)
+		{
+			chunk->m_blocks.Compact();
+		}
+		PrintChunkBlockMemory(GetActiveChunkBlockMemory(world));
+	}
+	return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Game/BlockDefinition.hpp"
+#include <vector>
+
+// block types are stored in sections of whole z layers, each encoded on its own
+constexpr int BITS_SECTION_Z = 4;
+constexpr int SECTION_LAYERS = 1 << BITS_SECTION_Z;
+constexpr int BITS_SECTION = BITS_X + BITS_Y + BITS_SECTION_Z;
+constexpr int BLOCKSPERSECTION = 1 << BITS_SECTION;
+constexpr int SECTIONSPERCHUNK = SIZE_Z / SECTION_LAYERS;
+
+// resident block storage summed over chunks, for the blockmemory command and the terrain benchmark
+struct ChunkBlockMemory
+{
+	int m_chunkCount = 0;
+	size_t m_typeBytes = 0;		// sections, their palettes and packed indexes
+	size_t m_lightBytes = 0;
+	size_t m_flagBytes = 0;
+	int m_sectionCounts[5] = {};	// uniform, then 1, 2, 4 and 8 bits per block
+
+	void Add(ChunkBlockMemory const& add);
+	size_t GetTotalBytes() const;
+};
+
+// a chunk's blocks as separate planes instead of interleaved 3 byte Blocks: types, light and the sky height of each column
+// types are kept per section as one value when the whole section is a single type (the air above the terrain, the stone
+// below it), otherwise as 1, 2 or 4 bit indexes into a palette of the section's types, or as raw 8 bit types past 16 of them
+// sections widen as SetType adds types and only narrow again on Compact, opaque, solid and visible come from the definition
+// generation and loading write a whole chunk, so they Expand it to a flat array of types first and Compact it once at the end
+class ChunkBlocks
+{
+public:
+	ChunkBlocks();
+	ChunkBlocks(const ChunkBlocks& copy) = delete;
+
+	uint8_t GetType(int index) const;
+	void SetType(int index, uint8_t type);
+	bool IsUniformSection(int section, uint8_t& out_type) const;
+	void Expand();		// types in one flat array until Compact, so writing a whole chunk does not keep re-encoding sections
+	void Compact();		// every section at its narrowest encoding, raw types only without s_paletteSections
+	void CopyTypesFrom(ChunkBlocks const& copyFrom);
+	ChunkBlockMemory GetMemory() const;
+
+	BlockDefinition const& GetDefinition(int index) const;
+	bool IsOpaque(int index) const;
+	bool IsSolid(int index) const;
+	uint8_t GetLightEmitted(int index) const;
+	uint8_t GetIndoorLight(int index) const;
+	uint8_t GetOutdoorLight(int index) const;
+	void SetIndoorLight(int index, uint8_t indoor);
+	void SetOutdoorLight(int index, uint8_t outdoor);
+	bool IsSky(int index) const;		// at or above its column's sky height
+	int GetSkyHeight(int column) const;
+	void SetSkyHeight(int column, int z);
+	void ComputeSkyHeights();
+
+	static bool s_paletteSections;
+
+	uint8_t m_light[BLOCKSPERCHUNK];	// outdoor bits 4-7, indoor bits 0-3
+
+private:
+	struct Section
+	{
+		uint8_t m_bits = 0;					// 0 for a uniform section, 1, 2 or 4 for palette indexes, 8 for raw types
+		uint8_t m_uniformType = AIR;
+		std::vector<uint8_t> m_palette;		// index to type, only with 1, 2 or 4 bits
+		std::vector<uint64_t> m_words;		// a value of m_bits for each block, packed from the low bits up
+	};
+
+	static void DecodeSection(Section const& section, uint8_t* out_types);
+	static void EncodeSection(Section& section, uint8_t const* types, bool usePalette);
+
+	Section m_sections[SECTIONSPERCHUNK];
+	std::vector<uint8_t> m_expandedTypes;	// every type while expanded, the sections are stale then
+	uint8_t m_skyHeights[BLOCKSPERLAYER];	// one above the top opaque block of each column, SIZE_Z until ComputeSkyHeights
+};
+
+// console command: blockmemory palette=<true|false>
+bool Command_BlockMemory(EventArgs& args);
@@ -0,0 +1,154 @@
+#include "Game/ChunkGrid.hpp"
+
+constexpr int CHUNK_GRID_MIN_SLOTS = 64;
+
+//--------------------------------------------------------------------
+ChunkGrid::ChunkGrid()
+{
+	Resize(CHUNK_GRID_MIN_SLOTS);
+}
+
+//--------------------------------------------------------------------
+// neighboring coordinates land far apart, so the square of chunks around the player does not pile into long probe runs
+uint32_t ChunkGrid::HashCoords(IntVec2 const& chunkCoords)
+{
+	uint32_t hash = (uint32_t)chunkCoords.x * 0x9E3779B1u ^ (uint32_t)chunkCoords.y * 0x85EBCA77u;
+	hash ^= hash >> 15;
+	hash *= 0x2C1B3C6Du;
+	hash ^= hash >> 12;
+	return hash;
+}
+
+//--------------------------------------------------------------------
+int ChunkGrid::FindSlot(IntVec2 const& chunkCoords) const
+{
+	int mask = (int)m_slots.size() - 1;
+	int slot = (int)(HashCoords(chunkCoords) & (uint32_t)mask);
+	while (m_slots[slot].m_chunkIndex >= 0 && m_slots[slot].m_chunkCoords != chunkCoords)
+	{
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+//--------------------------------------------------------------------
+Chunk* ChunkGrid::Find(IntVec2 const& chunkCoords) const
+{
+	return m_slots[FindSlot(chunkCoords)].m_chunk;
+}
+
+//--------------------------------------------------------------------
+Chunk* ChunkGrid::Find(int x, int y) const
+{
+	return Find(IntVec2(x, y));
+}
+
+//--------------------------------------------------------------------
+bool ChunkGrid::Contains(IntVec2 const& chunkCoords) const
+{
+	return m_slots[FindSlot(chunkCoords)].m_chunkIndex >= 0;
+}
+
+//--------------------------------------------------------------------
+void ChunkGrid::Insert(IntVec2 const& chunkCoords, Chunk* chunk)
+{
+	if (2 * ((int)m_chunks.size() + 1) > (int)m_slots.size())
+	{
+		Resize(2 * (int)m_slots.size());
+	}
+
+	Slot& slot = m_slots[FindSlot(chunkCoords)];
+	if (slot.m_chunkIndex >= 0)
+	{
+		slot.m_chunk = chunk;
+		m_chunks[slot.m_chunkIndex] = chunk;
+		return;
+	}
+	slot.m_chunkCoords = chunkCoords;
+	slot.m_chunk = chunk;
+	slot.m_chunkIndex = (int)m_chunks.size();
+	m_chunks.push_back(chunk);
+	m_chunkCoords.push_back(chunkCoords);
+}
+
+//--------------------------------------------------------------------
+// the slots after the hole move back into it while that keeps them at or after their hashed slot, which leaves every probe
+// run as if the erased chunk had never been inserted
+bool ChunkGrid::Erase(IntVec2 const& chunkCoords)
+{
+	int mask = (int)m_slots.size() - 1;
+	int hole = FindSlot(chunkCoords);
+	int chunkIndex = m_slots[hole].m_chunkIndex;
+	if (chunkIndex < 0)
+	{
+		return false;
+	}
+
+	for (int slot = (hole + 1) & mask; m_slots[slot].m_chunkIndex >= 0; slot = (slot + 1) & mask)
+	{
+		int home = (int)(HashCoords(m_slots[slot].m_chunkCoords) & (uint32_t)mask);
+		if (((slot - home) & mask) >= ((slot - hole) & mask))
+		{
+			m_slots[hole] = m_slots[slot];
+			hole = slot;
+		}
+	}
+	m_slots[hole] = Slot();
+
+	int lastIndex = (int)m_chunks.size() - 1;
+	if (chunkIndex != lastIndex)
+	{
+		m_chunks[chunkIndex] = m_chunks[lastIndex];
+		m_chunkCoords[chunkIndex] = m_chunkCoords[lastIndex];
+		m_slots[FindSlot(m_chunkCoords[chunkIndex])].m_chunkIndex = chunkIndex;
+	}
+	m_chunks.pop_back();
+	m_chunkCoords.pop_back();
+	return true;
+}
+
+//--------------------------------------------------------------------
+void ChunkGrid::Clear()
+{
+	m_chunks.clear();
+	m_chunkCoords.clear();
+	m_slots.assign(m_slots.size(), Slot());
+}
+
+//--------------------------------------------------------------------
+int ChunkGrid::GetCount() const
+{
+	return (int)m_chunks.size();
+}
+
+//--------------------------------------------------------------------
+size_t ChunkGrid::GetBytes() const
+{
+	return m_slots.capacity() * sizeof(Slot) + m_chunks.capacity() * sizeof(Chunk*) + m_chunkCoords.capacity() * sizeof(IntVec2);
+}
+
+//--------------------------------------------------------------------
+std::vector<Chunk*>::const_iterator ChunkGrid::begin() const
+{
+	return m_chunks.begin();
+}
+
+//--------------------------------------------------------------------
+std::vector<Chunk*>::const_iterator ChunkGrid::end() const
+{
+	return m_chunks.end();
+}
+
+//--------------------------------------------------------------------
+// reinserts every chunk, slotCount must be a power of two
+void ChunkGrid::Resize(int slotCount)
+{
+	m_slots.assign(slotCount, Slot());
+	for (int chunkIndex = 0; chunkIndex < (int)m_chunks.size(); chunkIndex++)
+	{
+		Slot& slot = m_slots[FindSlot(m_chunkCoords[chunkIndex])];
+		slot.m_chunkCoords = m_chunkCoords[chunkIndex];
+		slot.m_chunk = m_chunks[chunkIndex];
+		slot.m_chunkIndex = chunkIndex;
+	}
+}
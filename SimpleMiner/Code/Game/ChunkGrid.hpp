@@ -0,0 +1,44 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <vector>
+
+class Chunk;
+
+// chunks by chunk coordinates in an open addressing table with linear probing, kept at most half full so a lookup touches
+// a slot or two of one flat array, erasing shifts the rest of the probe run back instead of leaving tombstones
+// the chunks are also kept packed in an array for iteration, in no particular order, erasing moves the last one into the gap
+class ChunkGrid
+{
+public:
+	ChunkGrid();
+	ChunkGrid(const ChunkGrid& copy) = delete;
+
+	Chunk* Find(IntVec2 const& chunkCoords) const;
+	Chunk* Find(int x, int y) const;
+	bool Contains(IntVec2 const& chunkCoords) const;
+	void Insert(IntVec2 const& chunkCoords, Chunk* chunk);	// replaces the chunk already at chunkCoords
+	bool Erase(IntVec2 const& chunkCoords);
+	void Clear();
+	int GetCount() const;
+	size_t GetBytes() const;
+
+	std::vector<Chunk*>::const_iterator begin() const;
+	std::vector<Chunk*>::const_iterator end() const;
+
+private:
+	struct Slot
+	{
+		IntVec2 m_chunkCoords;
+		Chunk* m_chunk = nullptr;
+		int m_chunkIndex = -1;		// into m_chunks, -1 for an empty slot
+	};
+
+	int FindSlot(IntVec2 const& chunkCoords) const;		// the slot holding chunkCoords, or the empty slot ending its probe run
+	void Resize(int slotCount);
+	static uint32_t HashCoords(IntVec2 const& chunkCoords);
+
+	std::vector<Slot> m_slots;				// a power of two of them
+	std::vector<Chunk*> m_chunks;
+	std::vector<IntVec2> m_chunkCoords;		// of each of m_chunks, to find its slot when it moves into a gap
+};
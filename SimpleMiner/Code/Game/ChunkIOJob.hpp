@@ -1,11 +1,11 @@
 #pragma once
-#include <thread>
+#include "Engine/Core/JobPool.hpp"
 #include "Engine/Math/IntVec2.hpp"
 
 class Chunk;
 class JobWorkerThread;
 
-class ChunkIOJob : public Job
+class ChunkIOJob : public Job, public Pooled<ChunkIOJob>
 {
 public:
 	ChunkIOJob(Chunk* chunk, int jobType);
@@ -16,6 +16,5 @@ private:
 public:
 //	IntVec2 m_chunkCoords;
 	Chunk* m_chunk = nullptr;
-	std::thread m_thread;
 };
 
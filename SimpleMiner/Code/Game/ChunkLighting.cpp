@@ -0,0 +1,464 @@
+#include "Game/ChunkLighting.hpp"
+#include "Game/Chunk.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include <algorithm>
+
+constexpr int LIGHT_DIRECTIONS = 6; // NORTH, EAST, SOUTH and WEST, then up and down
+
+//--------------------------------------------------------------------
+static int GetLight(ChunkBlocks const& blocks, int index, int channel)
+{
+	return channel == LIGHT_OUTDOOR ? blocks.GetOutdoorLight(index) : blocks.GetIndoorLight(index);
+}
+
+//--------------------------------------------------------------------
+static void SetLight(ChunkBlocks& blocks, int index, int channel, int light)
+{
+	if (channel == LIGHT_OUTDOOR)
+	{
+		blocks.SetOutdoorLight(index, (uint8_t)light);
+	}
+	else
+	{
+		blocks.SetIndoorLight(index, (uint8_t)light);
+	}
+}
+
+//--------------------------------------------------------------------
+// the light a block has whatever its neighbors have
+static int GetBaseline(ChunkBlocks const& blocks, int index, int channel)
+{
+	if (channel == LIGHT_OUTDOOR)
+	{
+		return blocks.IsSky(index) ? MAX_LIGHT : 0;
+	}
+	return blocks.GetLightEmitted(index);
+}
+
+//--------------------------------------------------------------------
+// the block next to index toward direction, in the same chunk or, across the border, in m_neighbors[direction], -1 past the
+// top or bottom of the world
+static int GetNeighborIndex(int index, int direction, bool& out_isAcrossBorder)
+{
+	out_isAcrossBorder = false;
+	switch (direction)
+	{
+	case NORTH:
+		out_isAcrossBorder = ((index >> BITS_X) & MASK_Y) == MASK_Y;
+		return out_isAcrossBorder ? index & ~(MASK_Y << BITS_X) : index + SIZE_X;
+	case EAST:
+		out_isAcrossBorder = (index & MASK_X) == MASK_X;
+		return out_isAcrossBorder ? index & ~MASK_X : index + 1;
+	case SOUTH:
+		out_isAcrossBorder = ((index >> BITS_X) & MASK_Y) == 0;
+		return out_isAcrossBorder ? index | (MASK_Y << BITS_X) : index - SIZE_X;
+	case WEST:
+		out_isAcrossBorder = (index & MASK_X) == 0;
+		return out_isAcrossBorder ? index | MASK_X : index - 1;
+	case 4:
+		return (index >> (BITS_X + BITS_Y)) == MASK_Z ? -1 : index + BLOCKSPERLAYER;
+	default:
+		return index < BLOCKSPERLAYER ? -1 : index - BLOCKSPERLAYER;
+	}
+}
+
+//--------------------------------------------------------------------
+// run updates are dropped from the front once they are half the queue, so a chunk relit over many phases does not keep growing it
+static void CompactUpdates(std::vector<LightUpdate>& updates, int& head)
+{
+	if (head == (int)updates.size())
+	{
+		updates.clear();
+		head = 0;
+	}
+	else if (head * 2 >= (int)updates.size())
+	{
+		updates.erase(updates.begin(), updates.begin() + head);
+		head = 0;
+	}
+}
+
+//--------------------------------------------------------------------
+bool ChunkLightQueue::HasDarkens() const
+{
+	return m_darkenHead < (int)m_darkens.size();
+}
+
+//--------------------------------------------------------------------
+bool ChunkLightQueue::IsEmpty() const
+{
+	return m_darkenHead == (int)m_darkens.size() && m_spreadHead == (int)m_spreads.size();
+}
+
+//--------------------------------------------------------------------
+bool ChunkLightQueue::IsScheduled() const
+{
+	return m_scheduleIndex >= 0;
+}
+
+//--------------------------------------------------------------------
+void ChunkLighting::QueueSpread(Chunk* chunk, int index, int channel)
+{
+	chunk->m_lightQueue.m_spreads.push_back({ (uint16_t)index, (uint8_t)channel, 0 });
+	Schedule(chunk);
+}
+
+//--------------------------------------------------------------------
+void ChunkLighting::Schedule(Chunk* chunk)
+{
+	if (!chunk->m_lightQueue.IsScheduled())
+	{
+		chunk->m_lightQueue.m_scheduleIndex = (int)m_scheduledChunks.size();
+		m_scheduledChunks.push_back(chunk);
+	}
+}
+
+//--------------------------------------------------------------------
+// only the blocks between the column's old and new sky height change outdoor baseline, digging out the top block of a column
+// under open sky lights the blocks below it down to the next opaque one, not the whole column
+void ChunkLighting::UpdateBlock(Chunk* chunk, int index)
+{
+	ChunkBlocks& blocks = chunk->m_blocks;
+	int column = index & (BLOCKSPERLAYER - 1);
+	int z = index >> (BITS_X + BITS_Y);
+	bool isOpaque = blocks.IsOpaque(index);
+	int oldHeight = blocks.GetSkyHeight(column);
+	int newHeight = oldHeight;
+	if (isOpaque && z >= oldHeight)
+	{
+		newHeight = z + 1;
+	}
+	else if (!isOpaque && z + 1 == oldHeight)
+	{
+		newHeight = z;
+		while (newHeight > 0 && !blocks.IsOpaque((newHeight - 1) << (BITS_X + BITS_Y) | column))
+		{
+			newHeight--;
+		}
+	}
+	blocks.SetSkyHeight(column, newHeight);
+
+	ResetLight(chunk, index, LIGHT_INDOOR);
+	ResetLight(chunk, index, LIGHT_OUTDOOR);
+	for (int columnZ = std::min(oldHeight, newHeight); columnZ < std::max(oldHeight, newHeight); columnZ++)
+	{
+		ResetLight(chunk, columnZ << (BITS_X + BITS_Y) | column, LIGHT_OUTDOOR);
+	}
+
+	// an opened block is lit by its neighbors, spread once every darkening is done so the light is not about to go away
+	for (int direction = 0; direction < LIGHT_DIRECTIONS && !isOpaque; direction++)
+	{
+		bool isAcrossBorder = false;
+		int neighborIndex = GetNeighborIndex(index, direction, isAcrossBorder);
+		Chunk* neighbor = isAcrossBorder ? chunk->m_neighbors[direction] : chunk;
+		for (int channel = LIGHT_INDOOR; neighborIndex >= 0 && neighbor && channel <= LIGHT_OUTDOOR; channel++)
+		{
+			if (GetLight(neighbor->m_blocks, neighborIndex, channel) > 1)
+			{
+				QueueSpread(neighbor, neighborIndex, channel);
+			}
+		}
+	}
+
+	HandOverBorders(chunk);
+	if (!chunk->m_lightQueue.IsEmpty())
+	{
+		Schedule(chunk);
+	}
+}
+
+//--------------------------------------------------------------------
+// to the block's baseline, on the main thread
+void ChunkLighting::ResetLight(Chunk* chunk, int index, int channel)
+{
+	ChunkBlocks& blocks = chunk->m_blocks;
+	int light = GetLight(blocks, index, channel);
+	int baseline = GetBaseline(blocks, index, channel);
+	if (baseline < light)
+	{
+		DropToBaseline(chunk, index, channel, light, baseline);
+	}
+	else if (baseline > light)
+	{
+		SetLight(blocks, index, channel, baseline);
+		MarkLightChanged(chunk, index);
+		chunk->m_lightQueue.m_spreads.push_back({ (uint16_t)index, (uint8_t)channel, 0 });
+	}
+}
+
+//--------------------------------------------------------------------
+// darkenings join the neighbor's queue as they are, raises are made here so the neighbor spreads from the raised block,
+// and may schedule the neighbor
+void ChunkLighting::HandOverBorders(Chunk* chunk)
+{
+	ChunkLightQueue& queue = chunk->m_lightQueue;
+	for (int direction = 0; direction < 4; direction++)
+	{
+		Chunk* neighbor = chunk->m_neighbors[direction];
+		if (neighbor)
+		{
+			ChunkLightQueue& neighborQueue = neighbor->m_lightQueue;
+			neighborQueue.m_darkens.insert(neighborQueue.m_darkens.end(), queue.m_borderDarkens[direction].begin(), queue.m_borderDarkens[direction].end());
+			for (LightUpdate const& raise : queue.m_borderRaises[direction])
+			{
+				Raise(neighbor, raise.m_index, raise.m_channel, raise.m_light);
+			}
+			neighbor->m_sectionsNeedingMesh |= queue.m_borderSectionsNeedingMesh[direction];
+			if (!neighborQueue.IsEmpty())
+			{
+				Schedule(neighbor);
+			}
+		}
+		queue.m_borderDarkens[direction].clear();
+		queue.m_borderRaises[direction].clear();
+		queue.m_borderSectionsNeedingMesh[direction] = 0;
+	}
+}
+
+//--------------------------------------------------------------------
+int ChunkLighting::Process(JobSystem& jobSystem, double budgetSeconds)
+{
+	PROFILE_SCOPE("ChunkLighting::Process");
+	double budgetEnd = GetCurrentTimeSeconds() + budgetSeconds;
+	int updateCount = 0;
+	while (!m_scheduledChunks.empty())
+	{
+		// no chunk spreads while any chunk still has darkening to do
+		bool isDarkening = false;
+		for (int chunkIndex = 0; chunkIndex < (int)m_scheduledChunks.size() && !isDarkening; chunkIndex++)
+		{
+			isDarkening = m_scheduledChunks[chunkIndex]->m_lightQueue.HasDarkens();
+		}
+		updateCount += ProcessPhase(jobSystem, m_nextPhase, isDarkening);
+		m_nextPhase = (m_nextPhase + 1) & 3;
+		if (GetCurrentTimeSeconds() >= budgetEnd)
+		{
+			break;
+		}
+	}
+	return updateCount;
+}
+
+//--------------------------------------------------------------------
+int ChunkLighting::ProcessPhase(JobSystem& jobSystem, int phase, bool isDarkening)
+{
+	m_phaseChunks.clear();
+	for (Chunk* chunk : m_scheduledChunks)
+	{
+		ChunkLightQueue const& queue = chunk->m_lightQueue;
+		bool hasUpdates = isDarkening ? queue.HasDarkens() : queue.m_spreadHead < (int)queue.m_spreads.size();
+		if (hasUpdates && ((chunk->m_chunkCoords.x & 1) | ((chunk->m_chunkCoords.y & 1) << 1)) == phase)
+		{
+			m_phaseChunks.push_back(chunk);
+		}
+	}
+	if (m_phaseChunks.empty())
+	{
+		return 0;
+	}
+
+	// the threads' share split between the chunks, so a phase takes about as long however many chunks are in it
+	int threadCount = jobSystem.m_workerThreads + 1;
+	int maxUpdates = LIGHT_UPDATES_PER_PHASE * threadCount / (int)m_phaseChunks.size();
+	maxUpdates = maxUpdates < LIGHT_UPDATES_PER_PHASE / 16 ? LIGHT_UPDATES_PER_PHASE / 16 : (maxUpdates > LIGHT_UPDATES_PER_PHASE ? LIGHT_UPDATES_PER_PHASE : maxUpdates);
+	m_phaseUpdateCounts.assign(m_phaseChunks.size(), 0);
+	jobSystem.ParallelFor(0, (int)m_phaseChunks.size(), 1, [&](int chunkIndex)
+	{
+		m_phaseUpdateCounts[chunkIndex] = RelightChunk(m_phaseChunks[chunkIndex], maxUpdates, isDarkening);
+	});
+
+	// the border exchange, which may schedule neighbors for the next phases
+	int updateCount = 0;
+	for (int chunkIndex = 0; chunkIndex < (int)m_phaseChunks.size(); chunkIndex++)
+	{
+		updateCount += m_phaseUpdateCounts[chunkIndex];
+		HandOverBorders(m_phaseChunks[chunkIndex]);
+	}
+
+	// only this phase's chunks can have run out of updates
+	int scheduledCount = 0;
+	for (Chunk* chunk : m_scheduledChunks)
+	{
+		if (chunk->m_lightQueue.IsEmpty())
+		{
+			chunk->m_lightQueue.m_scheduleIndex = -1;
+		}
+		else
+		{
+			chunk->m_lightQueue.m_scheduleIndex = scheduledCount;
+			m_scheduledChunks[scheduledCount++] = chunk;
+		}
+	}
+	m_scheduledChunks.resize(scheduledCount);
+	return updateCount;
+}
+
+//--------------------------------------------------------------------
+// the updates go with the chunk's own queue, and the last scheduled chunk takes its place in the schedule, so discarding
+// chunks leaving the activation range costs the same however much lighting is pending
+void ChunkLighting::Discard(Chunk* chunk)
+{
+	ChunkLightQueue& queue = chunk->m_lightQueue;
+	queue.m_darkens.clear();
+	queue.m_spreads.clear();
+	queue.m_darkenHead = 0;
+	queue.m_spreadHead = 0;
+	if (queue.IsScheduled())
+	{
+		Chunk* lastChunk = m_scheduledChunks.back();
+		m_scheduledChunks[queue.m_scheduleIndex] = lastChunk;
+		lastChunk->m_lightQueue.m_scheduleIndex = queue.m_scheduleIndex;
+		m_scheduledChunks.pop_back();
+		queue.m_scheduleIndex = -1;
+	}
+}
+
+//--------------------------------------------------------------------
+bool ChunkLighting::IsSettled() const
+{
+	return m_scheduledChunks.empty();
+}
+
+//--------------------------------------------------------------------
+int ChunkLighting::GetScheduledChunkCount() const
+{
+	return (int)m_scheduledChunks.size();
+}
+
+//--------------------------------------------------------------------
+// runs on a worker, the updates this makes inside the chunk join its queue, the ones across a border wait for the hand over
+int ChunkLighting::RelightChunk(Chunk* chunk, int maxUpdates, bool isDarkening)
+{
+	ChunkLightQueue& queue = chunk->m_lightQueue;
+	int updateCount = 0;
+	if (isDarkening)
+	{
+		while (updateCount < maxUpdates && queue.m_darkenHead < (int)queue.m_darkens.size())
+		{
+			Darken(chunk, queue.m_darkens[queue.m_darkenHead++]);
+			updateCount++;
+		}
+	}
+	else
+	{
+		while (updateCount < maxUpdates && queue.m_spreadHead < (int)queue.m_spreads.size())
+		{
+			Spread(chunk, queue.m_spreads[queue.m_spreadHead++]);
+			updateCount++;
+		}
+	}
+	CompactUpdates(queue.m_darkens, queue.m_darkenHead);
+	CompactUpdates(queue.m_spreads, queue.m_spreadHead);
+	return updateCount;
+}
+
+//--------------------------------------------------------------------
+// a block dimmer than the darkened neighbor was may have been lit by it, one at least as bright was lit from elsewhere and
+// spreads back into the darkened blocks
+void ChunkLighting::Darken(Chunk* chunk, LightUpdate update)
+{
+	ChunkBlocks& blocks = chunk->m_blocks;
+	int light = GetLight(blocks, update.m_index, update.m_channel);
+	if (light == 0)
+	{
+		return;
+	}
+	int baseline = GetBaseline(blocks, update.m_index, update.m_channel);
+	if (light >= update.m_light || light <= baseline)
+	{
+		chunk->m_lightQueue.m_spreads.push_back({ update.m_index, update.m_channel, 0 });
+		return;
+	}
+	DropToBaseline(chunk, update.m_index, update.m_channel, light, baseline);
+}
+
+//--------------------------------------------------------------------
+void ChunkLighting::DropToBaseline(Chunk* chunk, int index, int channel, int light, int baseline)
+{
+	ChunkBlocks& blocks = chunk->m_blocks;
+	ChunkLightQueue& queue = chunk->m_lightQueue;
+	SetLight(blocks, index, channel, baseline);
+	MarkLightChanged(chunk, index);
+	for (int direction = 0; direction < LIGHT_DIRECTIONS; direction++)
+	{
+		bool isAcrossBorder = false;
+		int neighborIndex = GetNeighborIndex(index, direction, isAcrossBorder);
+		if (neighborIndex < 0)
+		{
+			continue;
+		}
+		LightUpdate darken = { (uint16_t)neighborIndex, (uint8_t)channel, (uint8_t)light };
+		if (!isAcrossBorder)
+		{
+			if (GetLight(blocks, neighborIndex, channel) != 0)
+			{
+				queue.m_darkens.push_back(darken);
+			}
+		}
+		else if (chunk->m_neighbors[direction] && GetLight(chunk->m_neighbors[direction]->m_blocks, neighborIndex, channel) != 0)
+		{
+			queue.m_borderDarkens[direction].push_back(darken);
+		}
+	}
+	if (baseline > 0)
+	{
+		queue.m_spreads.push_back({ (uint16_t)index, (uint8_t)channel, 0 });
+	}
+}
+
+//--------------------------------------------------------------------
+void ChunkLighting::Spread(Chunk* chunk, LightUpdate update)
+{
+	int light = GetLight(chunk->m_blocks, update.m_index, update.m_channel) - 1;
+	if (light <= 0)
+	{
+		return;
+	}
+	for (int direction = 0; direction < LIGHT_DIRECTIONS; direction++)
+	{
+		bool isAcrossBorder = false;
+		int neighborIndex = GetNeighborIndex(update.m_index, direction, isAcrossBorder);
+		if (neighborIndex < 0)
+		{
+			continue;
+		}
+		if (!isAcrossBorder)
+		{
+			Raise(chunk, neighborIndex, update.m_channel, light);
+			continue;
+		}
+		Chunk* neighbor = chunk->m_neighbors[direction];
+		if (neighbor && !neighbor->m_blocks.IsOpaque(neighborIndex) && GetLight(neighbor->m_blocks, neighborIndex, update.m_channel) < light)
+		{
+			chunk->m_lightQueue.m_borderRaises[direction].push_back({ (uint16_t)neighborIndex, update.m_channel, (uint8_t)light });
+		}
+	}
+}
+
+//--------------------------------------------------------------------
+void ChunkLighting::Raise(Chunk* chunk, int index, int channel, int light)
+{
+	ChunkBlocks& blocks = chunk->m_blocks;
+	if (blocks.IsOpaque(index) || GetLight(blocks, index, channel) >= light)
+	{
+		return;
+	}
+	SetLight(blocks, index, channel, light);
+	MarkLightChanged(chunk, index);
+	chunk->m_lightQueue.m_spreads.push_back({ (uint16_t)index, (uint8_t)channel, 0 });
+}
+
+//--------------------------------------------------------------------
+// the sections whose faces look into the block, in the neighbor across a border once handed over
+void ChunkLighting::MarkLightChanged(Chunk* chunk, int index)
+{
+	chunk->MarkBlockNeedsMesh(index);
+	uint8_t section = (uint8_t)(1 << (index >> BITS_SECTION));
+	int x = index & MASK_X;
+	int y = (index >> BITS_X) & MASK_Y;
+	uint8_t* borderSections = chunk->m_lightQueue.m_borderSectionsNeedingMesh;
+	borderSections[NORTH] |= y == MASK_Y ? section : 0;
+	borderSections[EAST] |= x == MASK_X ? section : 0;
+	borderSections[SOUTH] |= y == 0 ? section : 0;
+	borderSections[WEST] |= x == 0 ? section : 0;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include <vector>
+
+class Chunk;
+class JobSystem;
+
+constexpr int LIGHT_INDOOR = 0;
+constexpr int LIGHT_OUTDOOR = 1;
+
+// one light channel of a block of a chunk, m_light is the light it had for a darkening and the light to raise it to for a
+// raise across a border, a spread reads the block's light when it runs
+struct LightUpdate
+{
+	uint16_t m_index;
+	uint8_t m_channel;
+	uint8_t m_light;
+};
+
+// a chunk's pending light updates, only the worker relighting the chunk touches it during a phase
+struct ChunkLightQueue
+{
+	std::vector<LightUpdate> m_darkens;		// blocks a darkened neighbor may have been lighting
+	std::vector<LightUpdate> m_spreads;		// blocks to spread light to their neighbors from
+	int m_darkenHead = 0;					// next of m_darkens to run
+	int m_spreadHead = 0;
+	std::vector<LightUpdate> m_borderDarkens[4];	// of blocks of m_neighbors[direction], handed over after the phase
+	std::vector<LightUpdate> m_borderRaises[4];
+	uint8_t m_borderSectionsNeedingMesh[4] = {};	// of m_neighbors[direction], whose faces toward this chunk changed light
+	int m_scheduleIndex = -1;		// in ChunkLighting::m_scheduledChunks, -1 when not scheduled
+
+	bool HasDarkens() const;
+	bool IsEmpty() const;
+	bool IsScheduled() const;
+};
+
+// each channel's light is max(its baseline, brightest neighbor - 1), where the baseline is the light the block emits indoors
+// and full light outdoors at or above its column's sky height, kept up breadth first so only blocks whose light changes are
+// visited: a block that darkens takes each neighbor dimmer than it was back to its own baseline in turn, and the neighbors
+// at least as bright, lit from elsewhere, spread back into the darkened blocks, while a block that brightens raises the
+// neighbors it now outshines. every darkening queued runs before any spread, so no spread carries light that is going away
+// updates are queued per chunk and run on workers in phases, each phase takes the scheduled chunks of one of four classes
+// by the parity of their x and y, no two of which share a face, so a worker owns its chunk's light outright and only reads
+// the border light of neighbors sitting the phase out, the updates it makes across a border wait in its queue until the main
+// thread hands them over once every worker is done
+// the light has one solution, so it settles to the same light whatever order the chunks and phases run in
+class ChunkLighting
+{
+public:
+	void QueueSpread(Chunk* chunk, int index, int channel);
+	// after the block's type changed: its column's sky height, then its light and the blocks that gained or lost the sky
+	void UpdateBlock(Chunk* chunk, int index);
+	// phases until nothing is queued or budgetSeconds has passed, at least one runs even over budget and the next call carries
+	// on with the phase after it, returns the updates run
+	int Process(JobSystem& jobSystem, double budgetSeconds);
+	void Discard(Chunk* chunk);		// drops the chunk's pending updates in constant time, before it is deactivated
+	bool IsSettled() const;
+	int GetScheduledChunkCount() const;
+
+private:
+	void Schedule(Chunk* chunk);
+	void ResetLight(Chunk* chunk, int index, int channel);
+	void HandOverBorders(Chunk* chunk);
+	int ProcessPhase(JobSystem& jobSystem, int phase, bool isDarkening);
+	static int RelightChunk(Chunk* chunk, int maxUpdates, bool isDarkening);
+	static void Darken(Chunk* chunk, LightUpdate update);
+	static void Spread(Chunk* chunk, LightUpdate update);
+	static void Raise(Chunk* chunk, int index, int channel, int light);
+	static void DropToBaseline(Chunk* chunk, int index, int channel, int light, int baseline);
+	static void MarkLightChanged(Chunk* chunk, int index);
+
+	std::vector<Chunk*> m_scheduledChunks;		// every chunk with updates queued, in no particular order, each knows its index
+	std::vector<Chunk*> m_phaseChunks;			// reused every phase
+	std::vector<int> m_phaseUpdateCounts;		// of each of m_phaseChunks, written by the worker relighting it
+	int m_nextPhase = 0;
+};
@@ -0,0 +1,70 @@
+#include "Engine/Core/Job.hpp"
+#include "Game/ChunkMeshJob.hpp"
+#include "Game/Game.hpp"
+#include <algorithm>
+
+//--------------------------------------------------------------------------------
+static int GetSlabBlockIndex(int direction, int step, int z)
+{
+	switch (direction)
+	{
+	case NORTH:	return (z << (BITS_X + BITS_Y)) | step;						// y = 0 of the chunk to the north
+	case EAST:	return (z << (BITS_X + BITS_Y)) | (step << BITS_X);			// x = 0 of the chunk to the east
+	case SOUTH:	return (z << (BITS_X + BITS_Y)) | (MASK_Y << BITS_X) | step;	// y = MASK_Y of the chunk to the south
+	default:	return (z << (BITS_X + BITS_Y)) | (step << BITS_X) | MASK_X;	// x = MASK_X of the chunk to the west
+	}
+}
+
+//--------------------------------------------------------------------------------
+// meshing looks one block past the edge at most, so the neighbors' types (compact, copied whole) and a slab of their light
+// is all it needs
+void ChunkMeshSnapshot::CopyFrom(Chunk const& chunk)
+{
+	m_chunk.m_blocks.CopyTypesFrom(chunk.m_blocks);
+	std::copy(chunk.m_blocks.m_light, chunk.m_blocks.m_light + BLOCKSPERCHUNK, m_chunk.m_blocks.m_light);
+	m_chunk.m_chunkCoords = chunk.m_chunkCoords;
+	m_chunk.m_worldBounds = chunk.m_worldBounds;
+	m_chunk.m_sectionsNeedingMesh = chunk.m_sectionsNeedingMesh;
+	m_chunk.m_isGreedyMesh = chunk.m_isGreedyMesh;
+	m_chunk.m_isPackedMesh = chunk.m_isPackedMesh;
+	for (int direction = 0; direction < 4; direction++)
+	{
+		Chunk const* neighbor = chunk.m_neighbors[direction];
+		m_chunk.m_neighbors[direction] = neighbor ? &m_neighbors[direction] : nullptr;
+		if (neighbor == nullptr)
+		{
+			continue;
+		}
+		m_neighbors[direction].m_blocks.CopyTypesFrom(neighbor->m_blocks);
+		for (int z = 0; z < SIZE_Z; z++)
+		{
+			for (int step = 0; step < SIZE_X; step++) // SIZE_X == SIZE_Y
+			{
+				int index = GetSlabBlockIndex(direction, step, z);
+				m_neighbors[direction].m_blocks.m_light[index] = neighbor->m_blocks.m_light[index];
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------
+ChunkMeshJob::~ChunkMeshJob()
+{
+	delete m_snapshot; // only still set if the job was never retired by a world
+}
+
+//--------------------------------------------------------------------------------
+ChunkMeshJob::ChunkMeshJob(IntVec2 chunkCoords, ChunkMeshSnapshot* snapshot, bool greedy, bool packed)
+	: Job(JobType::JOB_MESH), m_chunkCoords(chunkCoords), m_snapshot(snapshot), m_greedy(greedy), m_packed(packed)
+{
+
+}
+
+//--------------------------------------------------------------------------------
+void ChunkMeshJob::Execute()
+{
+	if (m_snapshot)
+	{
+		m_snapshot->m_chunk.CreateSectionGeometry(*g_theJobSystem, m_greedy, m_packed);
+	}
+}
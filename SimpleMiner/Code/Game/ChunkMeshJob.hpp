@@ -0,0 +1,32 @@
+#pragma once
+#include "Engine/Core/JobPool.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Game/Chunk.hpp"
+
+// a chunk's blocks plus the row or column of each neighbor that touches it, copied on the main thread so a worker can
+// mesh them while lighting and edits carry on in the live chunks, the world reuses them so copying does not allocate
+struct ChunkMeshSnapshot
+{
+	Chunk m_chunk;
+	Chunk m_neighbors[4]; // types are copied whole, light only for the border slab facing m_chunk
+
+	void CopyFrom(Chunk const& chunk);
+};
+
+// builds the batch meshes of the sections m_snapshot->m_chunk needs meshed, the world swaps them into the live chunk, which
+// appends them to its unchanged batches and uploads the result
+class ChunkMeshJob : public Job, public Pooled<ChunkMeshJob>
+{
+public:
+	~ChunkMeshJob();
+	ChunkMeshJob(IntVec2 chunkCoords, ChunkMeshSnapshot* snapshot, bool greedy, bool packed);
+
+private:
+	virtual void Execute() override;
+
+public:
+	IntVec2 m_chunkCoords; // the live chunk is looked up again on retirement, it may have been deactivated meanwhile
+	ChunkMeshSnapshot* m_snapshot = nullptr; // owned until the world takes it back
+	bool m_greedy = false;
+	bool m_packed = false;
+};
@@ -840,23 +840,13 @@ void Entity::Dig()
 
 	BlockIterator block = m_raycastHit.blockIterator;
 	block.m_chunk->SetBlock(block.m_x, block.m_y, block.m_z, AIR);
-	block.m_chunk->m_needsMesh = true;
+	block.m_chunk->MarkBlockNeedsMesh(block.m_blockIndex);
 	block.m_chunk->m_dirty = true;
 	// test if on chunk boundary and dirty adjacent chunk if so
-	block.m_chunk->TestNeighborNeedsMesh(block.m_x, block.m_y);
+	block.m_chunk->TestNeighborNeedsMesh(block.m_x, block.m_y, block.m_z);
 
-	// set sky flags if open to sky
-	BlockIterator blockIterator = block;
-	g_theGame->m_world->MarkLightingDirty(blockIterator);
-	if (blockIterator.GetTopNeighbor().GetBlock() && blockIterator.GetTopNeighbor().GetBlock()->IsSky())
-	{
-		while (blockIterator.GetBlock() && blockIterator.GetBlock()->IsOpaque() == false)
-		{
-			blockIterator.GetBlock()->SetSky(true);
-			g_theGame->m_world->MarkLightingDirty(blockIterator);
-			blockIterator = blockIterator.GetBottomNeighbor();
-		}
-	}
+	// opens the column below to the sky if this was its top block
+	g_theGame->m_world->UpdateBlockLighting(block);
 }
 
 //----------------------------------------------------------------------
@@ -870,24 +860,13 @@ void Entity::Place(uint8_t blockType)
 	BlockIterator block = GetAdjacentBlockByNormal(m_raycastHit);
 
 	block.m_chunk->SetBlock(block.m_x, block.m_y, block.m_z, blockType);
-	block.m_chunk->m_needsMesh = true;
+	block.m_chunk->MarkBlockNeedsMesh(block.m_blockIndex);
 	block.m_chunk->m_dirty = true;
 	// test if on chunk boundary and dirty adjacent chunk if so
-	block.m_chunk->TestNeighborNeedsMesh(block.m_x, block.m_y);
-
-	// reset sky flags if open to sky
-	BlockIterator blockIterator = block;
-	g_theGame->m_world->MarkLightingDirty(blockIterator);
+	block.m_chunk->TestNeighborNeedsMesh(block.m_x, block.m_y, block.m_z);
 
-	if (blockIterator.GetBlock()->IsSky())
-	{
-		while (blockIterator.GetBlock() && blockIterator.GetBlock()->IsOpaque() == false)
-		{
-			blockIterator.GetBlock()->SetSky(false);
-			g_theGame->m_world->MarkLightingDirty(blockIterator);
-			blockIterator = blockIterator.GetBottomNeighbor();
-		}
-	}
+	// shades the column below if this is now its top block
+	g_theGame->m_world->UpdateBlockLighting(block);
 }
 
 //----------------------------------------------------------------------
@@ -11,6 +11,11 @@
 #include "BlockTemplate.hpp"
 #include "TestJob.hpp"
 #include "BuildingTemplate.hpp"
+#include "Engine/Core/JobSystemBenchmark.hpp"
+#include "Engine/Core/Profiler.hpp"
+#include "Game/TerrainBenchmark.hpp"
+#include "Game/NoiseTileCache.hpp"
+#include "Game/ChunkBlocks.hpp"
 
 RandomNumberGenerator random; // singleton for now only used by entities in the Game
 
@@ -22,6 +27,100 @@ bool Command_Test(EventArgs& args)
 	return false;
 }
 
+// console command: parallelbench workers=<max> repeats=<count>
+// scaling of the chunk noise fill and meshing kernels on a standalone chunk, worker count 0 is the serial baseline
+bool Command_ParallelBenchmark(EventArgs& args)
+{
+	int maxWorkers = args.GetValue("workers", 16);
+	int repeats = args.GetValue("repeats", 20);
+
+	Chunk* chunk = new Chunk();
+	chunk->Initialize(IntVec2(3, 7));
+	chunk->Create();
+	RunParallelScalingBenchmark("chunk noise", maxWorkers, repeats, [chunk](JobSystem& jobSystem) { chunk->GenerateNoise(jobSystem); });
+	RunParallelScalingBenchmark("chunk geometry", maxWorkers, repeats, [chunk](JobSystem& jobSystem) { chunk->CreateGeometry(jobSystem); });
+	delete chunk;
+	return true;
+}
+
+// console command: jobwaits reset=<true|false>
+// queue wait percentiles per priority lane since startup or the last reset
+bool Command_JobWaits(EventArgs& args)
+{
+	g_theJobSystem->ReportQueueWaitHistograms();
+	if (args.GetValue("reset", false))
+	{
+		g_theJobSystem->ResetQueueWaitHistograms();
+	}
+	return true;
+}
+
+// console command: jobidle reset=<true|false>
+// busy, spinning and parked time per worker plus the queue to start latency, since startup or the last reset
+bool Command_JobIdle(EventArgs& args)
+{
+	g_theJobSystem->ReportWorkerIdleStats();
+	if (args.GetValue("reset", false))
+	{
+		g_theJobSystem->ResetWorkerIdleStats();
+		g_theJobSystem->ResetQueueWaitHistograms();
+	}
+	return true;
+}
+
+// console command: jobpool
+// occupancy of every job pool and whether the last frames had to grow one
+bool Command_JobPool(EventArgs& args)
+{
+	UNUSED(args);
+	g_theJobSystem->ReportJobPools();
+	return true;
+}
+
+// console command: jobtrace seconds=<duration> file=<path>
+// starts recording every job run, the next jobtrace (or the time limit) writes Chrome trace JSON for chrome://tracing
+bool Command_JobTrace(EventArgs& args)
+{
+	if (g_theJobSystem->IsTracing())
+	{
+		g_theJobSystem->StopTrace();
+		return true;
+	}
+	g_theJobSystem->StartTrace(args.GetValue("seconds", 0.0f), args.GetValue("file", "JobTrace.json"));
+	return true;
+}
+
+static void RemeshAllChunks()
+{
+	if (g_theGame && g_theGame->m_world)
+	{
+		for (Chunk* chunk : g_theGame->m_world->m_chunks)
+		{
+			chunk->MarkNeedsMesh();
+		}
+	}
+}
+
+// console command: greedymesh enabled=<true|false>
+// switches chunk meshing between one quad per block face and merged greedy quads, every loaded chunk is remeshed
+bool Command_GreedyMesh(EventArgs& args)
+{
+	Chunk::s_greedyMeshing = args.GetValue("enabled", !Chunk::s_greedyMeshing);
+	RemeshAllChunks();
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, Chunk::s_greedyMeshing ? "greedy meshing on" : "greedy meshing off");
+	return true;
+}
+
+// console command: packedmesh enabled=<true|false>
+// switches chunk vertexes between Vertex_PCU and the 8 byte Vertex_Voxel, every loaded chunk is remeshed
+bool Command_PackedMesh(EventArgs& args)
+{
+	Chunk::s_packedVertexes = args.GetValue("enabled", !Chunk::s_packedVertexes);
+	RemeshAllChunks();
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, Chunk::s_packedVertexes ? "packed chunk vertexes on" : "packed chunk vertexes off");
+	return true;
+}
+
 Game::~Game()
 {
 	if (m_world)
@@ -42,8 +141,27 @@ Game::~Game()
 Game::Game()
 {
 	m_worldSeed = g_gameConfigBlackboard.GetValue("WORLD_SEED", WORLD_SEED);
+	Chunk::s_greedyMeshing = g_gameConfigBlackboard.GetValue("GREEDY_MESHING", false);
+	Chunk::s_packedVertexes = g_gameConfigBlackboard.GetValue("PACKED_VERTEXES", false);
+	ChunkBlocks::s_paletteSections = g_gameConfigBlackboard.GetValue("PALETTE_SECTIONS", true);
 
 	g_theEventSystem->SubscribeEventCallbackFunction( "test", Command_Test );
+	g_theEventSystem->SubscribeEventCallbackFunction( "jobbench", Command_JobBenchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "parallelbench", Command_ParallelBenchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "jobwaits", Command_JobWaits );
+	g_theEventSystem->SubscribeEventCallbackFunction( "jobidle", Command_JobIdle );
+	g_theEventSystem->SubscribeEventCallbackFunction( "jobtrace", Command_JobTrace );
+	g_theEventSystem->SubscribeEventCallbackFunction( "jobpool", Command_JobPool );
+	g_theEventSystem->SubscribeEventCallbackFunction( "profile", Command_Profile );
+	g_theEventSystem->SubscribeEventCallbackFunction( "terrainbench", Command_TerrainBenchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "noisebench", Command_NoiseBenchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "noisecache", Command_NoiseCache );
+	g_theEventSystem->SubscribeEventCallbackFunction( "meshbench", Command_MeshBenchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "greedymesh", Command_GreedyMesh );
+	g_theEventSystem->SubscribeEventCallbackFunction( "packedmesh", Command_PackedMesh );
+	g_theEventSystem->SubscribeEventCallbackFunction( "blockmemory", Command_BlockMemory );
+	g_theEventSystem->SubscribeEventCallbackFunction( "chunkindexbench", Command_ChunkIndexBenchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "lightbench", Command_LightBenchmark );
 
 	// Load the test font for testing
 	g_testFont = g_theRenderer->CreateOrGetBitmapFont( "Data/Fonts/MyFixedFont" ); // DO NOT SPECIFY FILE EXTENSION!!  (Important later on.)
@@ -118,6 +236,7 @@ void Game::Startup()
 
 void Game::Update(float deltaSeconds)
 {
+	PROFILE_SCOPE("Game::Update");
 // 	float fontSize = 20.0f;
 // 	float vertical = g_gameConfigBlackboard.GetValue("SCREEN_CAMERA_HEIGHT", 800.0f);
 // 	Vec3 pos;
@@ -454,6 +573,7 @@ void Game::UpdateCameras(float deltaSeconds)
 
 void Game::Render() const
 {
+	PROFILE_SCOPE("Game::Render");
 	std::string str;
 	std::vector<Vertex_PCU> vertexArray;
 // 	float cellHeight = 0.0f;
@@ -44,19 +44,13 @@ enum direction
 	WEST
 };
 
-enum BlockFlags
-{
-	BLOCK_BIT_IS_SKY = 0,
-	BLOCK_BIT_IS_LIGHT_DIRTY,
-	BLOCK_BIT_IS_FULL_OPAQUE,
-	BLOCK_BIT_IS_SOLID,
-	BLOCK_BIT_IS_VISIBLE,
-	BLOCK_BIT_IS_X,
-	BLOCK_BIT_IS_Y,
-};
-
 // world parameters
 constexpr float CHUNK_ACTIVATION_RANGE = 250.0f;
+constexpr float CHUNK_ACTIVATION_BUDGET_MS = 1.0f; // main thread time per frame for activating and deactivating chunks
+constexpr float CHUNK_APPROACH_SPEED = 20.0f; // blocks per second used to turn chunk distance into a job deadline
+constexpr float CHUNK_VIEW_COSINE = 0.5f; // chunks within 60 degrees of the camera heading are generated first
+constexpr float CHUNK_NEAR_DISTANCE = 32.0f; // chunks this close always count as in view
+constexpr double CHUNK_JOB_REPRIORITIZE_SECONDS = 0.25; // queued chunk jobs are re-ranked at most this often, when the player changes chunk
 constexpr float NOISE_SCALE = 200.0f;
 constexpr float LIGHTNING_SCALE = 0.01f;
 constexpr int NOISE_OCTAVES = 5;
@@ -87,12 +81,26 @@ constexpr int VILLAGE_DIAMETER = 5 - 1; // 5 x 5 chunk villages
 constexpr int VILLAGE_RANGE = 23 - 1; // 23 x 23 chunk regions for possible village
 constexpr int NOISE_DIM = 16 + 2 * TREE_DIAMETER;
 constexpr int NOISE_ARRAY = NOISE_DIM * NOISE_DIM;
+constexpr int MAX_CHUNK_MESH_JOBS = 8; // chunk snapshots being meshed on workers at once, nearest chunks go first
+constexpr int CHUNK_ACTIVATION_JOBS_PER_WORKER = 2; // generate and load jobs queued at once, enough to keep every worker busy
+constexpr float CHUNK_LIGHTING_BUDGET_MS = 2.0f; // main thread time per frame for relighting, the rest settles over the next frames
+constexpr int LIGHT_UPDATES_PER_PHASE = 4096; // light updates each thread runs in one lighting phase, about 0.2 ms, and the most for one chunk
+constexpr int NOISE_ROWS_PER_BATCH = 4; // ParallelFor grain for the noise fill, 7 batches per chunk
+constexpr int GEOMETRY_LAYERS_PER_BATCH = 8; // ParallelFor grain for meshing, 2048 blocks per batch
+constexpr int GEOMETRY_BATCHES = SIZE_Z / GEOMETRY_LAYERS_PER_BATCH;
 
 constexpr float OCEAN_SCALE = 500.0f;
 constexpr float HILL_SCALE = 700.0f;
 constexpr float HUMIDITY_SCALE = 300.0f;
 constexpr float TEMP_SCALE = 400.0f;
 
+// purposes for RandomSequence::MakeSeed during world generation, each keyed by world block column
+enum WorldRandomPurpose
+{
+	RANDOM_SOIL_DEPTH,
+	RANDOM_ORES,
+};
+
 constexpr float OCEAN_FLOOR = 0.5f;
 constexpr float OCEAN_RANGE = 2.0f; // inverse of floor fraction to get range of 0 to 1 for LERP
 constexpr float OCEAN_LERPED = 0.0f;
@@ -5,6 +5,7 @@
 #include <crtdbg.h>
 #include <stdio.h>
 #include "App.hpp"
+#include "TerrainBenchmark.hpp"
 
 App* g_theApp = nullptr; // not in App.cpp...
 
@@ -27,7 +28,11 @@ const char* APP_NAME = "SimpleMiner";	// ...becomes ??? (Change this per project
 int WINAPI WinMain( HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR commandLineString, int )
 {
 	UNUSED( applicationInstanceHandle );
-	UNUSED( commandLineString );
+	if (strstr(commandLineString, "terrainbench") != nullptr || strstr(commandLineString, "noisebench") != nullptr || strstr(commandLineString, "meshbench") != nullptr
+		|| strstr(commandLineString, "chunkindexbench") != nullptr || strstr(commandLineString, "lightbench") != nullptr)
+	{
+		return RunHeadlessTerrainBenchmark(commandLineString); // no window, renderer or audio
+	}
 
 	g_theApp = new App();
 	g_theApp->Startup();
@@ -0,0 +1,245 @@
+#include "Game/NoiseTileCache.hpp"
+#include "Game/Game.hpp"
+#include "Game/World.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "ThirdParty/Squirrel/SmoothNoise.hpp"
+
+//--------------------------------------------------------------------
+// renormalized Perlin field doubling in frequency each octave, stored as bias + (1 - bias) * noise (bias 0.5 maps it to [0,1])
+static NoiseBundleField MakeNoiseField(float* output, float scale, unsigned int numOctaves, float persistence, unsigned int seed, float bias)
+{
+	NoiseBundleField field;
+	field.m_output = output;
+	field.m_scale = scale;
+	field.m_numOctaves = numOctaves;
+	field.m_octavePersistence = persistence;
+	field.m_seed = seed;
+	field.m_outputBias = bias;
+	field.m_outputMultiplier = 1.0f - bias;
+	return field;
+}
+
+//--------------------------------------------------------------------
+// one fused bundle, forest shares its lattice with temperature (same scale) and takes tree density as persistence
+void ComputeTerrainNoise(float* const* out_fields, int startX, int startY, int countX, int countY, int worldSeed)
+{
+	NoiseBundleField fields[NUM_TERRAIN_NOISE_FIELDS];
+	fields[NOISE_FIELD_TREE_DENSITY] = MakeNoiseField(out_fields[NOISE_FIELD_TREE_DENSITY], 200.0f, 10, 0.6f, worldSeed + 6, 0.5f);
+	fields[NOISE_FIELD_HUMIDITY] = MakeNoiseField(out_fields[NOISE_FIELD_HUMIDITY], HUMIDITY_SCALE, 6, 0.5f, worldSeed + 1, 0.5f);
+	fields[NOISE_FIELD_TEMPERATURE] = MakeNoiseField(out_fields[NOISE_FIELD_TEMPERATURE], TEMP_SCALE, 8, 0.6f, worldSeed + 2, 0.5f);
+	fields[NOISE_FIELD_HILLINESS] = MakeNoiseField(out_fields[NOISE_FIELD_HILLINESS], HILL_SCALE, 5, 0.6f, worldSeed + 3, 0.5f);
+	fields[NOISE_FIELD_OCEAN] = MakeNoiseField(out_fields[NOISE_FIELD_OCEAN], OCEAN_SCALE, 5, 0.5f, worldSeed + 4, 0.0f);
+	fields[NOISE_FIELD_FOREST] = MakeNoiseField(out_fields[NOISE_FIELD_FOREST], 400.0f, 9, 0.0f, worldSeed + 5, 0.5f);
+	fields[NOISE_FIELD_FOREST].m_persistenceField = NOISE_FIELD_TREE_DENSITY;
+	Compute2dPerlinNoiseBundle(fields, NUM_TERRAIN_NOISE_FIELDS, countX, countY, float(startX), float(startY), 1.0f);
+}
+
+//--------------------------------------------------------------------
+void ComputeTownNoise(float* out_town, int startX, int startY, int countX, int countY, int worldSeed)
+{
+	NoiseBundleField town = MakeNoiseField(out_town, 200.0f, 9, 0.5f, worldSeed + 7, 0.5f);
+	Compute2dPerlinNoiseBundle(&town, 1, countX, countY, float(startX), float(startY), 1.0f);
+}
+
+//--------------------------------------------------------------------
+double NoiseTileCacheStats::GetHitRate() const
+{
+	uint64_t lookups = m_hits + m_misses;
+	return lookups ? (double)m_hits / (double)lookups : 0.0;
+}
+
+//--------------------------------------------------------------------
+bool NoiseTileCache::TileKey::operator<(TileKey const& compare) const
+{
+	if (m_field != compare.m_field)
+		return m_field < compare.m_field;
+	if (m_seed != compare.m_seed)
+		return m_seed < compare.m_seed;
+	return m_tileCoords < compare.m_tileCoords;
+}
+
+//--------------------------------------------------------------------
+NoiseTileCache::~NoiseTileCache()
+{
+	Clear();
+}
+
+//--------------------------------------------------------------------
+// never smaller than the tiles one chunk touches, 3 x 3 of each terrain field and up to 2 x 2 of town
+NoiseTileCache::NoiseTileCache(size_t maxBytes)
+{
+	m_maxTiles = (int)(maxBytes / GetBytesPerTile());
+	int minTiles = 9 * NUM_TERRAIN_NOISE_FIELDS + 4;
+	m_maxTiles = m_maxTiles < minTiles ? minTiles : m_maxTiles;
+}
+
+//--------------------------------------------------------------------
+size_t NoiseTileCache::GetBytesPerTile()
+{
+	// map node (key, tile and about four links) and list node (key and two links)
+	return sizeof(TileKey) + sizeof(Tile) + 4 * sizeof(void*) + sizeof(TileKey) + 2 * sizeof(void*);
+}
+
+//--------------------------------------------------------------------
+// tiles are aligned to multiples of NOISE_TILE_SIZE, so negative coordinates floor with an arithmetic shift
+void NoiseTileCache::CopyRegion(NoiseField field, int seed, int startX, int startY, int countX, int countY, float* out_values, int outStride)
+{
+	int firstTileX = startX >> NOISE_TILE_BITS;
+	int firstTileY = startY >> NOISE_TILE_BITS;
+	int lastTileX = (startX + countX - 1) >> NOISE_TILE_BITS;
+	int lastTileY = (startY + countY - 1) >> NOISE_TILE_BITS;
+	for (int tileY = firstTileY; tileY <= lastTileY; tileY++)
+	{
+		for (int tileX = firstTileX; tileX <= lastTileX; tileX++)
+		{
+			TileKey key;
+			key.m_field = field;
+			key.m_seed = seed;
+			key.m_tileCoords = IntVec2(tileX, tileY);
+			CopyFromTile(key, startX, startY, countX, countY, out_values, outStride);
+		}
+	}
+}
+
+//--------------------------------------------------------------------
+static void CopyTileValues(float const* tileValues, int firstX, int firstY, int countX, int countY, float* out_values, int outStride)
+{
+	for (int y = 0; y < countY; y++)
+	{
+		float const* source = tileValues + (firstY + y) * NOISE_TILE_SIZE + firstX;
+		float* destination = out_values + y * outStride;
+		for (int x = 0; x < countX; x++)
+		{
+			destination[x] = source[x];
+		}
+	}
+}
+
+//--------------------------------------------------------------------
+// a terrain miss computes every terrain field of the tile in one bundle, the siblings then hit
+void NoiseTileCache::CopyFromTile(TileKey const& key, int startX, int startY, int countX, int countY, float* out_values, int outStride)
+{
+	int tileStartX = key.m_tileCoords.x << NOISE_TILE_BITS;
+	int tileStartY = key.m_tileCoords.y << NOISE_TILE_BITS;
+	int minX = startX > tileStartX ? startX : tileStartX;
+	int minY = startY > tileStartY ? startY : tileStartY;
+	int maxX = startX + countX < tileStartX + NOISE_TILE_SIZE ? startX + countX : tileStartX + NOISE_TILE_SIZE;
+	int maxY = startY + countY < tileStartY + NOISE_TILE_SIZE ? startY + countY : tileStartY + NOISE_TILE_SIZE;
+	float* destination = out_values + (minY - startY) * outStride + (minX - startX);
+
+	if (CopyIfCached(key, minX - tileStartX, minY - tileStartY, maxX - minX, maxY - minY, destination, outStride))
+	{
+		m_hits++;
+		return;
+	}
+	m_misses++;
+
+	// two threads missing the same tile both compute it, the values are identical so the second insert is dropped
+	if (key.m_field == NOISE_FIELD_TOWN)
+	{
+		float values[NOISE_TILE_SIZE * NOISE_TILE_SIZE];
+		ComputeTownNoise(values, tileStartX, tileStartY, NOISE_TILE_SIZE, NOISE_TILE_SIZE, key.m_seed);
+		InsertTile(key, values);
+		CopyTileValues(values, minX - tileStartX, minY - tileStartY, maxX - minX, maxY - minY, destination, outStride);
+		return;
+	}
+
+	float values[NUM_TERRAIN_NOISE_FIELDS][NOISE_TILE_SIZE * NOISE_TILE_SIZE];
+	float* outputs[NUM_TERRAIN_NOISE_FIELDS];
+	for (int field = 0; field < NUM_TERRAIN_NOISE_FIELDS; field++)
+	{
+		outputs[field] = values[field];
+	}
+	ComputeTerrainNoise(outputs, tileStartX, tileStartY, NOISE_TILE_SIZE, NOISE_TILE_SIZE, key.m_seed);
+	for (int field = 0; field < NUM_TERRAIN_NOISE_FIELDS; field++)
+	{
+		TileKey siblingKey = key;
+		siblingKey.m_field = field;
+		InsertTile(siblingKey, values[field]);
+	}
+	CopyTileValues(values[key.m_field], minX - tileStartX, minY - tileStartY, maxX - minX, maxY - minY, destination, outStride);
+}
+
+//--------------------------------------------------------------------
+bool NoiseTileCache::CopyIfCached(TileKey const& key, int firstX, int firstY, int countX, int countY, float* out_values, int outStride)
+{
+	m_mutex.lock();
+	std::map<TileKey, Tile>::iterator found = m_tiles.find(key);
+	if (found == m_tiles.end())
+	{
+		m_mutex.unlock();
+		return false;
+	}
+	m_recentUse.splice(m_recentUse.begin(), m_recentUse, found->second.m_recentUse);
+	CopyTileValues(found->second.m_values, firstX, firstY, countX, countY, out_values, outStride);
+	m_mutex.unlock();
+	return true;
+}
+
+//--------------------------------------------------------------------
+void NoiseTileCache::InsertTile(TileKey const& key, float const* values)
+{
+	m_mutex.lock();
+	if (m_tiles.find(key) == m_tiles.end())
+	{
+		while ((int)m_tiles.size() >= m_maxTiles)
+		{
+			m_tiles.erase(m_recentUse.back());
+			m_recentUse.pop_back();
+		}
+		Tile& tile = m_tiles[key];
+		for (int index = 0; index < NOISE_TILE_SIZE * NOISE_TILE_SIZE; index++)
+		{
+			tile.m_values[index] = values[index];
+		}
+		m_recentUse.push_front(key);
+		tile.m_recentUse = m_recentUse.begin();
+	}
+	m_mutex.unlock();
+}
+
+//--------------------------------------------------------------------
+void NoiseTileCache::Clear()
+{
+	m_mutex.lock();
+	m_tiles.clear();
+	m_recentUse.clear();
+	m_mutex.unlock();
+	m_hits = 0;
+	m_misses = 0;
+}
+
+//--------------------------------------------------------------------
+NoiseTileCacheStats NoiseTileCache::GetStats() const
+{
+	NoiseTileCacheStats stats;
+	stats.m_hits = m_hits;
+	stats.m_misses = m_misses;
+	m_mutex.lock();
+	stats.m_tileCount = (int)m_tiles.size();
+	m_mutex.unlock();
+	stats.m_maxTiles = m_maxTiles;
+	stats.m_bytes = (size_t)stats.m_tileCount * GetBytesPerTile();
+	return stats;
+}
+
+//--------------------------------------------------------------------
+bool Command_NoiseCache(EventArgs& args)
+{
+	if (g_theGame == nullptr || g_theGame->m_world == nullptr)
+	{
+		return false;
+	}
+	NoiseTileCache& cache = g_theGame->m_world->m_noiseCache;
+	NoiseTileCacheStats stats = cache.GetStats();
+	std::string line = Stringf("noise cache: %llu lookups, %.1f%% hits, %i of %i tiles, %.2f MB", stats.m_hits + stats.m_misses,
+		stats.GetHitRate() * 100.0, stats.m_tileCount, stats.m_maxTiles, (double)stats.m_bytes / (1024.0 * 1024.0));
+	g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, line);
+	DebuggerPrintf("%s\n", line.c_str());
+	if (args.GetValue("clear", false))
+	{
+		cache.Clear();
+		g_theConsole->AddLine(DevConsole::TINT_INFO_MINOR, "noise cache cleared");
+	}
+	return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+
+// the noise fields chunk generation samples, tree density first since it is forest's persistence
+enum NoiseField
+{
+	NOISE_FIELD_TREE_DENSITY,
+	NOISE_FIELD_HUMIDITY,
+	NOISE_FIELD_TEMPERATURE,
+	NOISE_FIELD_HILLINESS,
+	NOISE_FIELD_OCEAN,
+	NOISE_FIELD_FOREST,
+	NOISE_FIELD_TOWN,		// one sample per chunk, in chunk coordinates, the others are one per block column
+	NUM_NOISE_FIELDS
+};
+constexpr int NUM_TERRAIN_NOISE_FIELDS = NOISE_FIELD_TOWN;
+
+// every terrain field (out_fields holds one countX * countY array per field) or the town field over a grid of integer positions
+void ComputeTerrainNoise(float* const* out_fields, int startX, int startY, int countX, int countY, int worldSeed);
+void ComputeTownNoise(float* out_town, int startX, int startY, int countX, int countY, int worldSeed);
+
+constexpr int NOISE_TILE_BITS = 4;
+constexpr int NOISE_TILE_SIZE = 1 << NOISE_TILE_BITS; // a chunk wide, so a chunk's padded noise grid spans 3 x 3 tiles
+constexpr size_t NOISE_TILE_CACHE_BYTES = 8 * 1024 * 1024;
+
+struct NoiseTileCacheStats
+{
+	uint64_t m_hits = 0;		// tile lookups served without evaluating noise
+	uint64_t m_misses = 0;
+	int m_tileCount = 0;
+	int m_maxTiles = 0;
+	size_t m_bytes = 0;			// tiles plus the map and list bookkeeping for each
+
+	double GetHitRate() const;
+};
+
+// world-space tiles of noise shared by every chunk that samples them, keyed by field, tile coordinates and seed
+// neighboring chunks overlap by their TREE_DIAMETER padding and the town window covers many chunks, so most lookups hit
+// any thread may read, misses are computed outside the lock and the least recently used tiles are evicted past maxBytes
+// values are identical to computing the noise directly, so generation stays deterministic whatever the cache holds
+class NoiseTileCache
+{
+public:
+	~NoiseTileCache();
+	explicit NoiseTileCache(size_t maxBytes = NOISE_TILE_CACHE_BYTES);
+	NoiseTileCache(const NoiseTileCache& copy) = delete;
+
+	// copies field samples [startX, startX + countX) x [startY, startY + countY) into out_values, rows outStride floats apart
+	void CopyRegion(NoiseField field, int seed, int startX, int startY, int countX, int countY, float* out_values, int outStride);
+	void Clear();
+	NoiseTileCacheStats GetStats() const;
+
+	static size_t GetBytesPerTile();
+
+private:
+	struct TileKey
+	{
+		int m_field = 0;
+		int m_seed = 0;
+		IntVec2 m_tileCoords;
+
+		bool operator<(TileKey const& compare) const;
+	};
+
+	struct Tile
+	{
+		float m_values[NOISE_TILE_SIZE * NOISE_TILE_SIZE];
+		std::list<TileKey>::iterator m_recentUse;
+	};
+
+	void CopyFromTile(TileKey const& key, int startX, int startY, int countX, int countY, float* out_values, int outStride);
+	bool CopyIfCached(TileKey const& key, int firstX, int firstY, int countX, int countY, float* out_values, int outStride);
+	void InsertTile(TileKey const& key, float const* values);
+
+	int m_maxTiles = 0;
+	mutable std::mutex m_mutex;
+	std::map<TileKey, Tile> m_tiles;
+	std::list<TileKey> m_recentUse;		// most recently used first
+	std::atomic<uint64_t> m_hits = 0;
+	std::atomic<uint64_t> m_misses = 0;
+};
+
+// console command: noisecache clear=<true>
+bool Command_NoiseCache(EventArgs& args);
@@ -0,0 +1,1104 @@
+#include "Game/TerrainBenchmark.hpp"
+#include "Game/BlockDefinition.hpp"
+#include "Game/BlockTemplate.hpp"
+#include "Game/BuildingTemplate.hpp"
+#include "Game/ChunkGrid.hpp"
+#include "Game/ChunkLighting.hpp"
+#include "Game/ChunkMeshJob.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "ThirdParty/Squirrel/RawNoise.hpp"
+#include "ThirdParty/Squirrel/SmoothNoise.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <map>
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+//--------------------------------------------------------------------
+static uint64_t HashBytes(uint64_t hash, void const* data, size_t size)
+{
+	unsigned char const* bytes = (unsigned char const*)data;
+	for (size_t index = 0; index < size; index++)
+	{
+		hash = (hash ^ bytes[index]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+//--------------------------------------------------------------------
+// chunks fill a square around the world origin in row order
+static IntVec2 GetBenchmarkChunkCoords(int chunkIndex, int chunkCount)
+{
+	int side = 1;
+	while (side * side < chunkCount)
+	{
+		side++;
+	}
+	return IntVec2(chunkIndex % side - (side >> 1), chunkIndex / side - (side >> 1));
+}
+
+//--------------------------------------------------------------------
+// a private job system for one benchmark run, not held to the hardware threads so runs can oversubscribe the cores
+static JobSystem* CreateBenchmarkJobSystem(int workerThreads)
+{
+	JobSystemConfig config;
+	config.m_workerThreads = workerThreads;
+	config.m_limitToHardwareThreads = false;
+	JobSystem* jobSystem = new JobSystem(config);
+	jobSystem->Startup();
+	return jobSystem;
+}
+
+//--------------------------------------------------------------------
+static void DestroyBenchmarkJobSystem(JobSystem*& jobSystem)
+{
+	jobSystem->Shutdown();
+	delete jobSystem;
+	jobSystem = nullptr;
+}
+
+//--------------------------------------------------------------------
+// generates a side by side square of chunks around the world origin, in the row order of GetBenchmarkChunkCoords, each
+// linked to its neighbors inside the square, the chunks along the edge have no neighbor outward, unlit but with their sky
+// heights computed, as linked neighbors in the world were lit when activated, so even the first to be lit reads theirs
+static std::vector<Chunk*> CreateBenchmarkChunks(int side, int seed)
+{
+	JobSystem* jobSystem = CreateBenchmarkJobSystem(0);
+	int chunkCount = side * side;
+	std::vector<Chunk*> chunks(chunkCount, nullptr);
+	for (int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+	{
+		Chunk* chunk = new Chunk();
+		chunk->m_worldSeed = seed;
+		chunk->Initialize(GetBenchmarkChunkCoords(chunkIndex, chunkCount));
+		chunk->Create(*jobSystem);
+		chunks[chunkIndex] = chunk;
+	}
+	DestroyBenchmarkJobSystem(jobSystem);
+
+	for (int y = 0; y < side; y++)
+	{
+		for (int x = 0; x < side; x++)
+		{
+			Chunk* chunk = chunks[y * side + x];
+			chunk->m_neighbors[NORTH] = y + 1 < side ? chunks[(y + 1) * side + x] : nullptr;
+			chunk->m_neighbors[EAST] = x + 1 < side ? chunks[y * side + x + 1] : nullptr;
+			chunk->m_neighbors[SOUTH] = y > 0 ? chunks[(y - 1) * side + x] : nullptr;
+			chunk->m_neighbors[WEST] = x > 0 ? chunks[y * side + x - 1] : nullptr;
+		}
+	}
+	for (Chunk* chunk : chunks)
+	{
+		chunk->m_blocks.ComputeSkyHeights();
+	}
+	return chunks;
+}
+
+//--------------------------------------------------------------------
+static void DeleteBenchmarkChunks(std::vector<Chunk*>& chunks)
+{
+	for (Chunk* chunk : chunks)
+	{
+		delete chunk;
+	}
+	chunks.clear();
+}
+
+//--------------------------------------------------------------------
+static uint64_t GenerateBenchmarkChunk(JobSystem& jobSystem, IntVec2 chunkCoords, int seed, NoiseTileCache* cache, ChunkGenerationTimes& out_times,
+	ChunkBlockMemory& out_memory)
+{
+	Chunk* chunk = new Chunk();
+	chunk->m_worldSeed = seed;
+	chunk->Initialize(chunkCoords);
+	chunk->Create(jobSystem, &out_times, cache);
+
+	uint64_t checksum = FNV_OFFSET_BASIS;
+	for (int index = 0; index < BLOCKSPERCHUNK; index++)
+	{
+		uint8_t block = chunk->GetBlock(index);
+		checksum = HashBytes(checksum, &block, sizeof(block));
+	}
+	out_memory = chunk->m_blocks.GetMemory();
+	delete chunk;
+	return checksum;
+}
+
+//--------------------------------------------------------------------
+class TerrainBenchmarkJob : public Job
+{
+public:
+	TerrainBenchmarkJob(JobSystem& jobSystem, IntVec2 chunkCoords, int seed, NoiseTileCache* cache, uint64_t* out_checksum, ChunkGenerationTimes* out_times,
+		ChunkBlockMemory* out_memory)
+		: Job(JobType::JOB_CREATE), m_jobSystem(jobSystem), m_chunkCoords(chunkCoords), m_seed(seed), m_cache(cache), m_checksum(out_checksum), m_times(out_times),
+		m_memory(out_memory)
+	{
+		m_deleteWhenComplete = true;
+	}
+
+	virtual void Execute() override
+	{
+		*m_checksum = GenerateBenchmarkChunk(m_jobSystem, m_chunkCoords, m_seed, m_cache, *m_times, *m_memory);
+	}
+
+	JobSystem& m_jobSystem;
+	IntVec2 m_chunkCoords;
+	int m_seed = 0;
+	NoiseTileCache* m_cache = nullptr;
+	uint64_t* m_checksum = nullptr;
+	ChunkGenerationTimes* m_times = nullptr;
+	ChunkBlockMemory* m_memory = nullptr;
+};
+
+//--------------------------------------------------------------------
+TerrainBenchmarkResult RunTerrainBenchmark(int chunkCount, int seed, int workerThreads, NoiseTileCache* cache)
+{
+	TerrainBenchmarkResult result;
+	result.m_workerThreads = workerThreads;
+	result.m_chunkCount = chunkCount;
+
+	JobSystem* jobSystem = CreateBenchmarkJobSystem(workerThreads);
+
+	// each chunk writes its own slot so the fold below is in chunk order whatever the scheduling
+	std::vector<uint64_t> checksums(chunkCount, 0);
+	std::vector<ChunkGenerationTimes> times(chunkCount);
+	std::vector<ChunkBlockMemory> memories(chunkCount);
+	double startTime = GetCurrentTimeSeconds();
+	if (workerThreads == 0)
+	{
+		for (int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+		{
+			checksums[chunkIndex] = GenerateBenchmarkChunk(*jobSystem, GetBenchmarkChunkCoords(chunkIndex, chunkCount), seed, cache, times[chunkIndex], memories[chunkIndex]);
+		}
+	}
+	else
+	{
+		std::vector<JobHandle> handles;
+		handles.reserve(chunkCount);
+		for (int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+		{
+			Job* job = new TerrainBenchmarkJob(*jobSystem, GetBenchmarkChunkCoords(chunkIndex, chunkCount), seed, cache, &checksums[chunkIndex], &times[chunkIndex], &memories[chunkIndex]);
+			handles.push_back(job->GetHandle());
+			jobSystem->QueueJob(job);
+		}
+		for (int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+		{
+			handles[chunkIndex].Wait();
+		}
+	}
+	result.m_seconds = GetCurrentTimeSeconds() - startTime;
+	DestroyBenchmarkJobSystem(jobSystem);
+
+	result.m_checksum = FNV_OFFSET_BASIS;
+	for (int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+	{
+		result.m_checksum = HashBytes(result.m_checksum, &checksums[chunkIndex], sizeof(uint64_t));
+		result.m_phases.m_noiseSeconds += times[chunkIndex].m_noiseSeconds;
+		result.m_phases.m_columnSeconds += times[chunkIndex].m_columnSeconds;
+		result.m_phases.m_treeSeconds += times[chunkIndex].m_treeSeconds;
+		result.m_phases.m_villageSeconds += times[chunkIndex].m_villageSeconds;
+		result.m_blockMemory.Add(memories[chunkIndex]);
+	}
+	return result;
+}
+
+//--------------------------------------------------------------------
+static std::string FormatTerrainBenchmarkLine(std::string const& label, TerrainBenchmarkResult const& result)
+{
+	double msPerChunk = 1000.0 / (double)result.m_chunkCount;
+	return Stringf("%7s %9.1f %9.1f %8.3f %8.3f %8.3f %8.3f  %016llx", label.c_str(),
+		(double)result.m_chunkCount / result.m_seconds, result.m_seconds * 1000000000.0 / ((double)result.m_chunkCount * (double)BLOCKSPERCHUNK),
+		result.m_phases.m_noiseSeconds * msPerChunk, result.m_phases.m_columnSeconds * msPerChunk,
+		result.m_phases.m_treeSeconds * msPerChunk, result.m_phases.m_villageSeconds * msPerChunk, result.m_checksum);
+}
+
+//--------------------------------------------------------------------
+bool RunTerrainBenchmarks(int chunkCount, int seed, int maxWorkers, std::vector<std::string>& out_lines)
+{
+	chunkCount = chunkCount < 1 ? 1 : chunkCount;
+	out_lines.push_back(Stringf("terrain benchmark: %i chunks, seed %i, phases are ms per chunk", chunkCount, seed));
+	out_lines.push_back("workers  chunks/s  ns/block    noise  columns    trees villages  checksum");
+	uint64_t serialChecksum = 0;
+	bool isMatching = true;
+	int mostWorkers = 0;
+	for (int workers = 0; workers <= maxWorkers; workers = workers ? workers * 2 : 1)
+	{
+		TerrainBenchmarkResult result = RunTerrainBenchmark(chunkCount, seed, workers);
+		serialChecksum = workers == 0 ? result.m_checksum : serialChecksum;
+		isMatching = isMatching && result.m_checksum == serialChecksum;
+		out_lines.push_back(FormatTerrainBenchmarkLine(Stringf("%i", workers), result));
+		if (workers == 0)
+		{
+			ChunkBlockMemory const& memory = result.m_blockMemory;
+			double kilobytes = 1024.0 * (double)chunkCount;
+			out_lines.push_back(Stringf("        block storage: %.1f KB per chunk, %.1f KB of it types, %i of %i sections uniform, against %.1f KB as 3 byte blocks",
+				(double)memory.GetTotalBytes() / kilobytes, (double)memory.m_typeBytes / kilobytes, memory.m_sectionCounts[0], chunkCount * SECTIONSPERCHUNK,
+				3.0 * BLOCKSPERCHUNK / 1024.0));
+		}
+		mostWorkers = workers;
+	}
+
+	// serial and widest again through a cold noise tile cache, which must not change a single block
+	int const cachedWorkers[2] = { 0, mostWorkers };
+	for (int run = 0; run < (mostWorkers > 0 ? 2 : 1); run++)
+	{
+		NoiseTileCache cache;
+		TerrainBenchmarkResult result = RunTerrainBenchmark(chunkCount, seed, cachedWorkers[run], &cache);
+		isMatching = isMatching && result.m_checksum == serialChecksum;
+		out_lines.push_back(FormatTerrainBenchmarkLine(Stringf("%i cache", cachedWorkers[run]), result));
+		NoiseTileCacheStats stats = cache.GetStats();
+		out_lines.push_back(Stringf("        noise cache: %.1f%% of %llu tile lookups hit, %i tiles, %.2f MB", stats.GetHitRate() * 100.0,
+			stats.m_hits + stats.m_misses, stats.m_tileCount, (double)stats.m_bytes / (1024.0 * 1024.0)));
+	}
+	out_lines.push_back(isMatching ? "checksums match" : "CHECKSUM MISMATCH between runs");
+	return isMatching;
+}
+
+//--------------------------------------------------------------------
+static void WriteTerrainBenchmarkReport(std::vector<std::string> const& lines, std::string const& filename)
+{
+	std::string text;
+	for (int index = 0; index < (int)lines.size(); index++)
+	{
+		text += lines[index] + "\n";
+	}
+	std::vector<uint8_t> buffer(text.begin(), text.end());
+	FileWriteBinaryBuffer(buffer, filename);
+}
+
+//--------------------------------------------------------------------
+// the first two lines stand out in the console, every line also goes to the debugger
+static void PrintBenchmarkLines(std::vector<std::string> const& lines)
+{
+	for (int index = 0; index < (int)lines.size(); index++)
+	{
+		g_theConsole->AddLine(index < 2 ? DevConsole::TINT_INFO_MAJOR : DevConsole::TINT_INFO_MINOR, lines[index]);
+		DebuggerPrintf("%s\n", lines[index].c_str());
+	}
+}
+
+//--------------------------------------------------------------------
+bool Command_TerrainBenchmark(EventArgs& args)
+{
+	int chunkCount = args.GetValue("chunks", 64);
+	int seed = args.GetValue("seed", g_gameConfigBlackboard.GetValue("WORLD_SEED", WORLD_SEED));
+	int maxWorkers = args.GetValue("workers", 12);
+	std::string filename = args.GetValue("file", "");
+
+	std::vector<std::string> lines;
+	RunTerrainBenchmarks(chunkCount, seed, maxWorkers, lines);
+	PrintBenchmarkLines(lines);
+	if (!filename.empty())
+	{
+		WriteTerrainBenchmarkReport(lines, filename);
+		g_theConsole->AddLine(DevConsole::TINT_INFO_MAJOR, Stringf("terrain benchmark written to %s", filename.c_str()));
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------
+bool RunNoiseBenchmark(int samples, int seed, std::vector<std::string>& out_lines)
+{
+	int side = 1;
+	while (side * side < samples)
+	{
+		side++;
+	}
+	samples = side * side;
+	std::vector<float> scalarNoise(samples);
+	std::vector<float> batchedNoise(samples);
+	float startX = -0.5f * (float)side;
+	float startY = 1000.0f;
+
+	out_lines.push_back(Stringf("noise benchmark: %i samples, %i lanes, scalar against batched Perlin noise", samples, GetNoiseBatchLanes()));
+	out_lines.push_back("octaves  scalar Ms/s  batched Ms/s  speedup  max difference");
+	bool isWithinTolerance = true;
+	int const octaveCounts[] = { 5, 6, 8, 9, 10 }; // the fields Chunk::GenerateNoise computes
+	for (int octaves : octaveCounts)
+	{
+		double startTime = GetCurrentTimeSeconds();
+		for (int y = 0; y < side; y++)
+		{
+			for (int x = 0; x < side; x++)
+			{
+				scalarNoise[y * side + x] = Compute2dPerlinNoise(startX + (float)x, startY + (float)y, 300.0f, octaves, 0.5f, 2.0f, true, seed);
+			}
+		}
+		double scalarSeconds = GetCurrentTimeSeconds() - startTime;
+
+		startTime = GetCurrentTimeSeconds();
+		Compute2dPerlinNoiseGrid(batchedNoise.data(), side, side, startX, startY, 1.0f, 300.0f, octaves, 0.5f, 2.0f, true, seed);
+		double batchedSeconds = GetCurrentTimeSeconds() - startTime;
+
+		float maxDifference = 0.0f;
+		for (int index = 0; index < samples; index++)
+		{
+			float difference = fabsf(scalarNoise[index] - batchedNoise[index]);
+			maxDifference = difference > maxDifference ? difference : maxDifference;
+		}
+		isWithinTolerance = isWithinTolerance && maxDifference <= NOISE_BATCH_TOLERANCE;
+		out_lines.push_back(Stringf("%7i %12.2f %13.2f %7.2fx  %g", octaves, (double)samples / scalarSeconds * 0.000001,
+			(double)samples / batchedSeconds * 0.000001, scalarSeconds / batchedSeconds, maxDifference));
+	}
+
+	// the six fields Chunk::GenerateNoise samples on the chunk grid, one scalar call each against one fused bundle
+	std::vector<float> scalarFields(samples * 6);
+	std::vector<float> bundleFields(samples * 6);
+	NoiseBundleField fields[6];
+	float const scales[6] = { 200.0f, HUMIDITY_SCALE, TEMP_SCALE, HILL_SCALE, OCEAN_SCALE, 400.0f };
+	unsigned int const octaves[6] = { 10, 6, 8, 5, 5, 9 };
+	float const persistences[6] = { 0.6f, 0.5f, 0.6f, 0.6f, 0.5f, 0.0f };
+	for (int field = 0; field < 6; field++)
+	{
+		fields[field].m_output = &bundleFields[field * samples];
+		fields[field].m_scale = scales[field];
+		fields[field].m_numOctaves = octaves[field];
+		fields[field].m_octavePersistence = persistences[field];
+		fields[field].m_seed = seed + field;
+		fields[field].m_outputBias = 0.5f;
+		fields[field].m_outputMultiplier = 0.5f;
+	}
+	fields[5].m_persistenceField = 0; // forest persistence is tree density
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int y = 0; y < side; y++)
+	{
+		for (int x = 0; x < side; x++)
+		{
+			int index = y * side + x;
+			for (int field = 0; field < 6; field++)
+			{
+				float persistence = field == 5 ? scalarFields[index] : persistences[field];
+				scalarFields[field * samples + index] = 0.5f + 0.5f * Compute2dPerlinNoise(startX + (float)x, startY + (float)y,
+					scales[field], octaves[field], persistence, 2.0f, true, seed + field);
+			}
+		}
+	}
+	double scalarSeconds = GetCurrentTimeSeconds() - startTime;
+
+	startTime = GetCurrentTimeSeconds();
+	Compute2dPerlinNoiseBundle(fields, 6, side, side, startX, startY, 1.0f);
+	double bundleSeconds = GetCurrentTimeSeconds() - startTime;
+
+	float maxDifference = 0.0f;
+	for (int index = 0; index < samples * 6; index++)
+	{
+		float difference = fabsf(scalarFields[index] - bundleFields[index]);
+		maxDifference = difference > maxDifference ? difference : maxDifference;
+	}
+	isWithinTolerance = isWithinTolerance && maxDifference <= NOISE_BATCH_TOLERANCE;
+	out_lines.push_back(Stringf(" bundle %12.2f %13.2f %7.2fx  %g  (Ms/s of 6 field chunk sets)", (double)samples / scalarSeconds * 0.000001,
+		(double)samples / bundleSeconds * 0.000001, scalarSeconds / bundleSeconds, maxDifference));
+	out_lines.push_back(isWithinTolerance ? "batched noise within tolerance" : Stringf("BATCHED NOISE DIFFERS by more than %g", NOISE_BATCH_TOLERANCE));
+	return isWithinTolerance;
+}
+
+//--------------------------------------------------------------------
+bool Command_NoiseBenchmark(EventArgs& args)
+{
+	int samples = args.GetValue("samples", 65536);
+	int seed = args.GetValue("seed", g_gameConfigBlackboard.GetValue("WORLD_SEED", WORLD_SEED));
+
+	std::vector<std::string> lines;
+	RunNoiseBenchmark(samples, seed, lines);
+	PrintBenchmarkLines(lines);
+	return true;
+}
+
+//--------------------------------------------------------------------
+// world positions for Vertex_PCU, chunk local for the packed Vertex_Voxel
+static Vec3 GetMeshVertexPosition(Vertex_PCU const& vertex)
+{
+	return vertex.m_position;
+}
+
+static Vec3 GetMeshVertexPosition(Vertex_Voxel const& vertex)
+{
+	return Vec3((float)vertex.m_x, (float)vertex.m_y, (float)vertex.m_z);
+}
+
+//--------------------------------------------------------------------
+// face (+z, -y, +x, +y, -x, -z) a quad faces, from the edges leaving its bottom left corner
+static int GetMeshQuadFace(Vec3 const& alongWidth, Vec3 const& alongHeight)
+{
+	Vec3 normal = CrossProduct3D(alongWidth, alongHeight);
+	if (fabsf(normal.z) >= fabsf(normal.x) && fabsf(normal.z) >= fabsf(normal.y))
+	{
+		return normal.z > 0.0f ? 0 : 5;
+	}
+	if (fabsf(normal.y) >= fabsf(normal.x))
+	{
+		return normal.y > 0.0f ? 3 : 1;
+	}
+	return normal.x > 0.0f ? 2 : 4;
+}
+
+//--------------------------------------------------------------------
+// sums a hash of every block face a quad covers with the quad's light (the color's r and g in every mesher), so two meshes
+// match only if each block face is lit the same in both however the faces were merged, origin is subtracted from the
+// vertex positions to make them chunk local
+template <typename VertexType>
+static uint64_t GetMeshLitFaceHash(std::vector<VertexType> const& vertexes, Vec3 const& origin)
+{
+	uint64_t hash = 0;
+	for (int vertex = 0; vertex + 3 < (int)vertexes.size(); vertex += 4)
+	{
+		Vec3 bottomLeft = GetMeshVertexPosition(vertexes[vertex + 1]) - origin;
+		Vec3 alongWidth = GetMeshVertexPosition(vertexes[vertex + 2]) - origin - bottomLeft;
+		Vec3 alongHeight = GetMeshVertexPosition(vertexes[vertex]) - origin - bottomLeft;
+		int width = (int)(alongWidth.GetLength() + 0.5f);
+		int height = (int)(alongHeight.GetLength() + 0.5f);
+		int face = GetMeshQuadFace(alongWidth, alongHeight);
+		Rgba8 color = vertexes[vertex].m_color;
+		Vec3 stepA = width > 0 ? alongWidth / (float)width : Vec3();
+		Vec3 stepB = height > 0 ? alongHeight / (float)height : Vec3();
+		for (int b = 0; b < height; b++)
+		{
+			for (int a = 0; a < width; a++)
+			{
+				// doubled cell center, whole numbers for any face
+				Vec3 center = (bottomLeft + stepA * ((float)a + 0.5f) + stepB * ((float)b + 0.5f)) * 2.0f;
+				int cell[6] = { (int)floorf(center.x + 0.5f), (int)floorf(center.y + 0.5f), (int)floorf(center.z + 0.5f), face, color.r, color.g };
+				hash += HashBytes(FNV_OFFSET_BASIS, cell, sizeof(cell));
+			}
+		}
+	}
+	return hash;
+}
+
+//--------------------------------------------------------------------
+// block faces covered by the chunk's quads, from the two edges leaving each quad's bottom left corner
+template <typename VertexType>
+static uint64_t GetMeshFaceArea(std::vector<VertexType> const& vertexes)
+{
+	uint64_t area = 0;
+	for (int vertex = 0; vertex + 3 < (int)vertexes.size(); vertex += 4)
+	{
+		Vec3 bottomLeft = GetMeshVertexPosition(vertexes[vertex + 1]);
+		float width = (GetMeshVertexPosition(vertexes[vertex + 2]) - bottomLeft).GetLength();
+		float height = (GetMeshVertexPosition(vertexes[vertex]) - bottomLeft).GetLength();
+		area += (uint64_t)(width * height + 0.5f);
+	}
+	return area;
+}
+
+//--------------------------------------------------------------------
+bool RunMeshBenchmark(int chunkCount, int seed, std::vector<std::string>& out_lines)
+{
+	int side = 3;
+	while ((side - 2) * (side - 2) < chunkCount)
+	{
+		side++;
+	}
+	chunkCount = (side - 2) * (side - 2);
+
+	// a border ring of generated neighbors so every measured chunk sees the faces along its edges as the world would, lit
+	// as the world lights them so faces only merge where their light matches
+	std::vector<Chunk*> chunks = CreateBenchmarkChunks(side, seed);
+	JobSystem* jobSystem = CreateBenchmarkJobSystem(0);
+	ChunkLighting lighting;
+	for (Chunk* chunk : chunks)
+	{
+		chunk->InitializeLighting(lighting);
+	}
+	while (!lighting.IsSettled())
+	{
+		lighting.Process(*jobSystem, 1.0e9);
+	}
+
+	out_lines.push_back(Stringf("mesh benchmark: %i chunks, seed %i, per chunk averages, lit", chunkCount, seed));
+	out_lines.push_back("        mesher   vertexes    indexes  vertex KB   index KB        ms   block faces");
+	// per-face and greedy, each with Vertex_PCU then packed Vertex_Voxel
+	uint64_t faceAreas[4] = { 0, 0, 0, 0 };
+	uint64_t litFaceHashes[4] = { 0, 0, 0, 0 };
+	double vertexBytes[4] = { 0.0, 0.0, 0.0, 0.0 };
+	char const* const labels[4] = { "faces", "faces packed", "greedy", "greedy packed" };
+	for (int run = 0; run < 4; run++)
+	{
+		bool greedy = run >= 2;
+		bool packed = (run & 1) != 0;
+		uint64_t vertexes = 0;
+		uint64_t indexes = 0;
+		double seconds = 0.0;
+		for (int y = 1; y < side - 1; y++)
+		{
+			for (int x = 1; x < side - 1; x++)
+			{
+				Chunk* chunk = chunks[y * side + x];
+				double startTime = GetCurrentTimeSeconds();
+				chunk->CreateGeometry(*jobSystem, greedy, packed);
+				seconds += GetCurrentTimeSeconds() - startTime;
+				vertexes += packed ? chunk->m_packedVertexes.size() : chunk->m_vertexes.size();
+				indexes += chunk->m_indexes.size();
+				faceAreas[run] += packed ? GetMeshFaceArea(chunk->m_packedVertexes) : GetMeshFaceArea(chunk->m_vertexes);
+				litFaceHashes[run] += packed ? GetMeshLitFaceHash(chunk->m_packedVertexes, Vec3()) : GetMeshLitFaceHash(chunk->m_vertexes, chunk->m_worldBounds.m_mins);
+			}
+		}
+		vertexBytes[run] = (double)vertexes * (packed ? sizeof(Vertex_Voxel) : sizeof(Vertex_PCU));
+		out_lines.push_back(Stringf("%14s %10.0f %10.0f %10.1f %10.1f %9.3f %13.0f", labels[run], (double)vertexes / chunkCount, (double)indexes / chunkCount,
+			vertexBytes[run] / (1024.0 * chunkCount), (double)indexes * sizeof(unsigned int) / (1024.0 * chunkCount), seconds * 1000.0 / chunkCount,
+			(double)faceAreas[run] / chunkCount));
+	}
+	if (vertexBytes[3] > 0.0)
+	{
+		out_lines.push_back(Stringf("        vertex bytes against faces: %.2fx smaller packed, %.2fx greedy, %.2fx greedy packed", vertexBytes[0] / vertexBytes[1],
+			vertexBytes[0] / vertexBytes[2], vertexBytes[0] / vertexBytes[3]));
+	}
+
+	// the copy is all a ChunkMeshJob leaves on the main thread, and its snapshot must mesh exactly like the live chunk
+	ChunkMeshSnapshot* snapshot = new ChunkMeshSnapshot();
+	double snapshotSeconds = 0.0;
+	bool isSnapshotMatching = true;
+	for (int y = 1; y < side - 1; y++)
+	{
+		for (int x = 1; x < side - 1; x++)
+		{
+			Chunk* chunk = chunks[y * side + x];
+			chunk->CreateGeometry(*jobSystem);
+			double startTime = GetCurrentTimeSeconds();
+			snapshot->CopyFrom(*chunk);
+			snapshotSeconds += GetCurrentTimeSeconds() - startTime;
+			snapshot->m_chunk.CreateGeometry(*jobSystem);
+			isSnapshotMatching = isSnapshotMatching && snapshot->m_chunk.m_indexes == chunk->m_indexes && snapshot->m_chunk.m_vertexes.size() == chunk->m_vertexes.size()
+				&& memcmp(snapshot->m_chunk.m_vertexes.data(), chunk->m_vertexes.data(), chunk->m_vertexes.size() * sizeof(Vertex_PCU)) == 0;
+		}
+	}
+	delete snapshot;
+	out_lines.push_back(Stringf("        mesh job snapshot: %.3f ms per chunk on the main thread, %s", snapshotSeconds * 1000.0 / chunkCount,
+		isSnapshotMatching ? "meshes like the live chunk" : "MESHES DIFFERENTLY from the live chunk"));
+
+	// an edit at the surface of the middle column only remeshes its section, which must leave the mesh as a whole remesh made it
+	double chunkSeconds = 0.0;
+	double sectionSeconds = 0.0;
+	bool isSectionMatching = true;
+	std::vector<Vertex_PCU> wholeVertexes;
+	std::vector<unsigned int> wholeIndexes;
+	for (int y = 1; y < side - 1; y++)
+	{
+		for (int x = 1; x < side - 1; x++)
+		{
+			Chunk* chunk = chunks[y * side + x];
+			chunk->MarkNeedsMesh();
+			double startTime = GetCurrentTimeSeconds();
+			chunk->CreateGeometry(*jobSystem);
+			chunkSeconds += GetCurrentTimeSeconds() - startTime;
+			wholeVertexes = chunk->m_vertexes;
+			wholeIndexes = chunk->m_indexes;
+
+			int index = (MASK_Z << (BITS_X + BITS_Y)) | ((SIZE_Y / 2) << BITS_X) | (SIZE_X / 2);
+			while (index >= BLOCKSPERLAYER && chunk->GetBlock(index) == AIR)
+			{
+				index -= BLOCKSPERLAYER;
+			}
+			chunk->m_sectionsNeedingMesh = 0;
+			chunk->MarkBlockNeedsMesh(index);
+			startTime = GetCurrentTimeSeconds();
+			chunk->CreateGeometry(*jobSystem);
+			sectionSeconds += GetCurrentTimeSeconds() - startTime;
+			isSectionMatching = isSectionMatching && chunk->m_indexes == wholeIndexes && chunk->m_vertexes.size() == wholeVertexes.size()
+				&& memcmp(chunk->m_vertexes.data(), wholeVertexes.data(), wholeVertexes.size() * sizeof(Vertex_PCU)) == 0;
+		}
+	}
+	out_lines.push_back(Stringf("        surface edit remesh: %.3f ms per chunk for its sections against %.3f ms for the whole chunk, %s", sectionSeconds * 1000.0 / chunkCount,
+		chunkSeconds * 1000.0 / chunkCount, isSectionMatching ? "meshes like a whole remesh" : "MESHES DIFFERENTLY from a whole remesh"));
+
+	DestroyBenchmarkJobSystem(jobSystem);
+	DeleteBenchmarkChunks(chunks);
+
+	// every mesher must cover exactly the same visible block faces, each lit the same
+	bool isMatching = faceAreas[0] == faceAreas[1] && faceAreas[0] == faceAreas[2] && faceAreas[0] == faceAreas[3];
+	out_lines.push_back(isMatching ? "every mesher covers the same block faces" : "MESHES DIFFER in the block faces they cover");
+	bool isLightMatching = litFaceHashes[0] == litFaceHashes[1] && litFaceHashes[0] == litFaceHashes[2] && litFaceHashes[0] == litFaceHashes[3];
+	out_lines.push_back(isLightMatching ? "every mesher lights each block face the same" : "MESHES DIFFER in the light of their block faces");
+	isMatching = isMatching && isLightMatching && isSnapshotMatching && isSectionMatching;
+	return isMatching;
+}
+
+//--------------------------------------------------------------------
+bool Command_MeshBenchmark(EventArgs& args)
+{
+	int chunkCount = args.GetValue("chunks", 16);
+	int seed = args.GetValue("seed", g_gameConfigBlackboard.GetValue("WORLD_SEED", WORLD_SEED));
+
+	std::vector<std::string> lines;
+	RunMeshBenchmark(chunkCount, seed, lines);
+	PrintBenchmarkLines(lines);
+	return true;
+}
+
+//--------------------------------------------------------------------
+// World::Update's activation scan over the square around the player at the origin, as it was with two std::maps (a lookup
+// in each for every chunk corner in range while nothing nearer is found) or with the grid (one lookup for a chunk whose
+// nearest corner is in range and nearer than the best so far), returns the candidate, or a far sentinel if none
+template <typename IsChunkMissing>
+static IntVec2 ScanForActivationCandidate(int radius, float range, bool isPerCorner, IsChunkMissing const& isChunkMissing)
+{
+	IntVec2 candidate(radius * 4, radius * 4);
+	float candidateRange = 2.0f * range * range;
+	Vec3 player(0.5f, 0.5f, 64.0f);
+	for (int x = -radius; x < radius; x++)
+	{
+		for (int y = -radius; y < radius; y++)
+		{
+			AABB2 bounds = Chunk::GetChunkWorldBounds(x, y);
+			float corners[4] = { Vec2(bounds.m_mins.x - player.x, bounds.m_mins.y - player.y).GetLengthSquared(), Vec2(bounds.m_mins.x - player.x, bounds.m_maxs.y - player.y).GetLengthSquared(),
+				Vec2(bounds.m_maxs.x - player.x, bounds.m_mins.y - player.y).GetLengthSquared(), Vec2(bounds.m_maxs.x - player.x, bounds.m_maxs.y - player.y).GetLengthSquared() };
+			if (isPerCorner)
+			{
+				for (int corner = 0; corner < 4; corner++)
+				{
+					if (corners[corner] < range * range && corners[corner] < candidateRange && isChunkMissing(IntVec2(x, y)))
+					{
+						candidate = IntVec2(x, y);
+						candidateRange = corners[corner];
+					}
+				}
+				continue;
+			}
+			float distance = std::min(std::min(corners[0], corners[1]), std::min(corners[2], corners[3]));
+			if (distance < range * range && distance < candidateRange && isChunkMissing(IntVec2(x, y)))
+			{
+				candidate = IntVec2(x, y);
+				candidateRange = distance;
+			}
+		}
+	}
+	return candidate;
+}
+
+//--------------------------------------------------------------------
+constexpr int CHUNK_INDEX_REPEATS = 16;
+
+bool RunChunkIndexBenchmark(int maxRadius, std::vector<std::string>& out_lines)
+{
+	out_lines.push_back(Stringf("chunk index benchmark: std::map against ChunkGrid, every chunk within the activation range of the origin"));
+	out_lines.push_back("  range  chunks   map ns/find  grid ns/find   map scan ms  grid scan ms   map iter us  grid iter us  grid KB");
+	bool isMatching = true;
+	for (int radius = 8; radius <= maxRadius; radius *= 2)
+	{
+		// the world's radius for this activation range, with every chunk whose nearest corner is in range already active
+		float range = (float)((radius - 1) * SIZE_X);
+		std::map<IntVec2, Chunk*> chunkMap;
+		std::map<IntVec2, Chunk*> liveMap;
+		ChunkGrid grid;
+		std::vector<uint64_t> chunkTags((size_t)(4 * radius * radius));
+		for (int y = -radius; y < radius; y++)
+		{
+			for (int x = -radius; x < radius; x++)
+			{
+				AABB2 bounds = Chunk::GetChunkWorldBounds(x, y);
+				float nearX = std::max(bounds.m_mins.x, std::min(0.5f, bounds.m_maxs.x)) - 0.5f;
+				float nearY = std::max(bounds.m_mins.y, std::min(0.5f, bounds.m_maxs.y)) - 0.5f;
+				if (nearX * nearX + nearY * nearY < range * range * 0.9f)
+				{
+					Chunk* chunk = reinterpret_cast<Chunk*>(&chunkTags[(size_t)((y + radius) * 2 * radius + x + radius)]); // never dereferenced
+					chunkMap[IntVec2(x, y)] = chunk;
+					liveMap[IntVec2(x, y)] = chunk;
+					grid.Insert(IntVec2(x, y), chunk);
+				}
+			}
+		}
+
+		// finds over the square and a chunk past it on every side, so a share of them miss, every pass is repeated and averaged
+		int finds = 0;
+		uintptr_t mapSum = 0;
+		uintptr_t gridSum = 0;
+		double startTime = GetCurrentTimeSeconds();
+		for (int repeat = 0; repeat < CHUNK_INDEX_REPEATS; repeat++)
+		{
+			for (int y = -radius - 1; y <= radius; y++)
+			{
+				for (int x = -radius - 1; x <= radius; x++)
+				{
+					std::map<IntVec2, Chunk*>::const_iterator found = chunkMap.find(IntVec2(x, y));
+					mapSum += found == chunkMap.end() ? 0 : (uintptr_t)found->second;
+					finds++;
+				}
+			}
+		}
+		double mapFindSeconds = GetCurrentTimeSeconds() - startTime;
+		startTime = GetCurrentTimeSeconds();
+		for (int repeat = 0; repeat < CHUNK_INDEX_REPEATS; repeat++)
+		{
+			for (int y = -radius - 1; y <= radius; y++)
+			{
+				for (int x = -radius - 1; x <= radius; x++)
+				{
+					gridSum += (uintptr_t)grid.Find(x, y);
+				}
+			}
+		}
+		double gridFindSeconds = GetCurrentTimeSeconds() - startTime;
+		isMatching = isMatching && mapSum == gridSum && (int)chunkMap.size() == grid.GetCount();
+
+		IntVec2 mapCandidate;
+		IntVec2 gridCandidate;
+		startTime = GetCurrentTimeSeconds();
+		for (int repeat = 0; repeat < CHUNK_INDEX_REPEATS; repeat++)
+		{
+			mapCandidate = ScanForActivationCandidate(radius, range, true, [&](IntVec2 const& chunkCoords)
+			{
+				return chunkMap.find(chunkCoords) == chunkMap.end() && liveMap.find(chunkCoords) == liveMap.end();
+			});
+		}
+		double mapScanSeconds = (GetCurrentTimeSeconds() - startTime) / CHUNK_INDEX_REPEATS;
+		startTime = GetCurrentTimeSeconds();
+		for (int repeat = 0; repeat < CHUNK_INDEX_REPEATS; repeat++)
+		{
+			gridCandidate = ScanForActivationCandidate(radius, range, false, [&](IntVec2 const& chunkCoords)
+			{
+				return !grid.Contains(chunkCoords);
+			});
+		}
+		double gridScanSeconds = (GetCurrentTimeSeconds() - startTime) / CHUNK_INDEX_REPEATS;
+		isMatching = isMatching && mapCandidate == gridCandidate;
+
+		// the deactivation and mesh passes visit every active chunk each frame
+		mapSum = 0;
+		gridSum = 0;
+		startTime = GetCurrentTimeSeconds();
+		for (int repeat = 0; repeat < CHUNK_INDEX_REPEATS; repeat++)
+		{
+			for (std::map<IntVec2, Chunk*>::const_iterator iter = chunkMap.begin(); iter != chunkMap.end(); iter++)
+			{
+				mapSum += (uintptr_t)iter->second;
+			}
+		}
+		double mapIterateSeconds = (GetCurrentTimeSeconds() - startTime) / CHUNK_INDEX_REPEATS;
+		startTime = GetCurrentTimeSeconds();
+		for (int repeat = 0; repeat < CHUNK_INDEX_REPEATS; repeat++)
+		{
+			for (Chunk* chunk : grid)
+			{
+				gridSum += (uintptr_t)chunk;
+			}
+		}
+		double gridIterateSeconds = (GetCurrentTimeSeconds() - startTime) / CHUNK_INDEX_REPEATS;
+		isMatching = isMatching && mapSum == gridSum;
+
+		int chunkCount = grid.GetCount();
+		size_t gridBytes = grid.GetBytes();
+
+		// erasing shifts probe runs back, every chunk left must still be found and every erased one missed
+		for (int y = -radius; y < radius; y++)
+		{
+			for (int x = -radius; x < radius; x++)
+			{
+				if (((x * 7 + y * 3) & 7) < 3)
+				{
+					isMatching = isMatching && grid.Erase(IntVec2(x, y)) == (chunkMap.erase(IntVec2(x, y)) != 0);
+				}
+			}
+		}
+		for (int y = -radius - 1; y <= radius; y++)
+		{
+			for (int x = -radius - 1; x <= radius; x++)
+			{
+				std::map<IntVec2, Chunk*>::const_iterator found = chunkMap.find(IntVec2(x, y));
+				isMatching = isMatching && grid.Find(x, y) == (found == chunkMap.end() ? nullptr : found->second);
+			}
+		}
+		isMatching = isMatching && (int)chunkMap.size() == grid.GetCount();
+
+		out_lines.push_back(Stringf("%7.0f %7i %13.1f %13.1f %13.3f %13.3f %13.1f %13.1f %8.1f", range, chunkCount, mapFindSeconds * 1.0e9 / finds,
+			gridFindSeconds * 1.0e9 / finds, mapScanSeconds * 1000.0, gridScanSeconds * 1000.0, mapIterateSeconds * 1.0e6, gridIterateSeconds * 1.0e6,
+			(double)gridBytes / 1024.0));
+	}
+	out_lines.push_back(isMatching ? "grid finds, scans and iterates the same chunks as the map" : "GRID DIFFERS from the map");
+	return isMatching;
+}
+
+//--------------------------------------------------------------------
+bool Command_ChunkIndexBenchmark(EventArgs& args)
+{
+	std::vector<std::string> lines;
+	RunChunkIndexBenchmark(args.GetValue("radius", 64), lines);
+	PrintBenchmarkLines(lines);
+	return true;
+}
+
+//--------------------------------------------------------------------
+// FNV-1a of every chunk's light, in chunk order
+static uint64_t HashChunkLight(std::vector<Chunk*> const& chunks)
+{
+	uint64_t checksum = FNV_OFFSET_BASIS;
+	for (Chunk* chunk : chunks)
+	{
+		checksum = HashBytes(checksum, chunk->m_blocks.m_light, sizeof(chunk->m_blocks.m_light));
+	}
+	return checksum;
+}
+
+//--------------------------------------------------------------------
+struct LightBenchmarkRun
+{
+	double m_seedSeconds = 0.0;		// InitializeLighting for every chunk
+	double m_seconds = 0.0;			// every Process call
+	double m_worstFrameSeconds = 0.0;
+	int m_frames = 0;
+	int64_t m_updates = 0;
+	uint64_t m_checksum = 0;		// FNV-1a of every chunk's light, in chunk order
+};
+
+//--------------------------------------------------------------------
+// clears the chunks' light and lights them again from scratch through Process calls of budgetSeconds each until it settles
+static LightBenchmarkRun RunLightBenchmarkFrames(std::vector<Chunk*> const& chunks, int workerThreads, double budgetSeconds)
+{
+	JobSystem* jobSystem = CreateBenchmarkJobSystem(workerThreads);
+	LightBenchmarkRun run;
+	ChunkLighting lighting;
+	double startTime = GetCurrentTimeSeconds();
+	for (Chunk* chunk : chunks)
+	{
+		memset(chunk->m_blocks.m_light, 0, sizeof(chunk->m_blocks.m_light));
+		chunk->InitializeLighting(lighting);
+	}
+	run.m_seedSeconds = GetCurrentTimeSeconds() - startTime;
+
+	while (!lighting.IsSettled())
+	{
+		double frameStartTime = GetCurrentTimeSeconds();
+		run.m_updates += lighting.Process(*jobSystem, budgetSeconds);
+		double frameSeconds = GetCurrentTimeSeconds() - frameStartTime;
+		run.m_seconds += frameSeconds;
+		run.m_worstFrameSeconds = std::max(run.m_worstFrameSeconds, frameSeconds);
+		run.m_frames++;
+	}
+	DestroyBenchmarkJobSystem(jobSystem);
+
+	run.m_checksum = HashChunkLight(chunks);
+	return run;
+}
+
+//--------------------------------------------------------------------
+struct LightEditStats
+{
+	int m_edits = 0;
+	int64_t m_updates = 0;
+	int m_mostUpdates = 0;
+	double m_seconds = 0.0;		// UpdateBlock and the Process calls until settled
+};
+
+//--------------------------------------------------------------------
+// kind 0 digs out the top block of the column, 1 and 2 put stone and glowstone on it and 3 digs a block halfway down,
+// returns false when the column has no such block
+static bool ApplyLightEdit(Chunk* chunk, int column, int kind, ChunkLighting& lighting)
+{
+	int skyHeight = 0;
+	while (skyHeight < SIZE_Z && !chunk->m_blocks.IsSky(skyHeight << (BITS_X + BITS_Y) | column))
+	{
+		skyHeight++;
+	}
+	int z = kind == 0 ? skyHeight - 1 : (kind == 3 ? skyHeight / 2 : skyHeight);
+	int index = z << (BITS_X + BITS_Y) | column;
+	if (z < 0 || z >= SIZE_Z || (kind == 3 && chunk->GetBlock(index) == AIR))
+	{
+		return false;
+	}
+	uint8_t const types[4] = { AIR, STONE, GLOWSTONE, AIR };
+	chunk->SetBlock(index, types[kind]);
+	lighting.UpdateBlock(chunk, index);
+	return true;
+}
+
+//--------------------------------------------------------------------
+bool RunLightBenchmark(int chunkCount, int seed, int maxWorkers, float budgetMs, std::vector<std::string>& out_lines)
+{
+	int side = 1;
+	while (side * side < chunkCount)
+	{
+		side++;
+	}
+	chunkCount = side * side;
+
+	std::vector<Chunk*> chunks = CreateBenchmarkChunks(side, seed);
+
+	out_lines.push_back(Stringf("light benchmark: %i chunks lit from scratch, seed %i", chunkCount, seed));
+	out_lines.push_back("workers    budget   frames  worst ms  total ms   seed ms       updates Mupdates/s  checksum");
+	uint64_t serialChecksum = 0;
+	bool isMatching = true;
+	int mostWorkers = 0;
+	for (int workers = 0; workers <= maxWorkers; workers = workers ? workers * 2 : 1)
+	{
+		LightBenchmarkRun run = RunLightBenchmarkFrames(chunks, workers, 1.0e9);
+		serialChecksum = workers == 0 ? run.m_checksum : serialChecksum;
+		isMatching = isMatching && run.m_checksum == serialChecksum;
+		out_lines.push_back(Stringf("%7i %9s %8i %9.2f %9.2f %9.2f %13lli %10.1f  %016llx", workers, "none", run.m_frames, run.m_worstFrameSeconds * 1000.0,
+			run.m_seconds * 1000.0, run.m_seedSeconds * 1000.0, run.m_updates, (double)run.m_updates / (run.m_seconds * 1.0e6), run.m_checksum));
+		mostWorkers = workers;
+	}
+
+	// the widest again a frame at a time, as the world runs it
+	int const budgetWorkers[2] = { 0, mostWorkers };
+	for (int budgetRun = 0; budgetRun < (mostWorkers > 0 ? 2 : 1); budgetRun++)
+	{
+		LightBenchmarkRun run = RunLightBenchmarkFrames(chunks, budgetWorkers[budgetRun], 0.001 * (double)budgetMs);
+		isMatching = isMatching && run.m_checksum == serialChecksum;
+		out_lines.push_back(Stringf("%7i %6.2f ms %8i %9.2f %9.2f %9.2f %13lli %10.1f  %016llx", budgetWorkers[budgetRun], budgetMs, run.m_frames,
+			run.m_worstFrameSeconds * 1000.0, run.m_seconds * 1000.0, run.m_seedSeconds * 1000.0, run.m_updates,
+			(double)run.m_updates / (run.m_seconds * 1.0e6), run.m_checksum));
+	}
+
+	out_lines.push_back(isMatching ? "every run settles to the same light" : "LIGHT DIFFERS between runs");
+
+	// every chunk seeded and then discarded unlit, as chunks leaving the activation range during fast travel are
+	ChunkLighting discardLighting;
+	for (Chunk* chunk : chunks)
+	{
+		chunk->InitializeLighting(discardLighting);
+	}
+	int scheduledCount = discardLighting.GetScheduledChunkCount();
+	double discardStartTime = GetCurrentTimeSeconds();
+	for (Chunk* chunk : chunks)
+	{
+		discardLighting.Discard(chunk);
+	}
+	double discardSeconds = GetCurrentTimeSeconds() - discardStartTime;
+	isMatching = isMatching && discardLighting.IsSettled();
+	out_lines.push_back(Stringf("discarding %i chunks, %i scheduled: %.3f ms, %s", chunkCount, scheduledCount, discardSeconds * 1000.0,
+		discardLighting.IsSettled() ? "nothing left pending" : "LIGHTING STILL PENDING"));
+
+	// edits at random columns, each settled before the next so its cost can be counted, then as many again a phase apart
+	// so they overlap, after each the light must be what lighting the edited chunks from scratch leaves
+	JobSystem* editJobSystem = CreateBenchmarkJobSystem(mostWorkers);
+	char const* editNames[4] = { "dig the top block", "place stone on top", "place glowstone on top", "dig a block underground" };
+	LightEditStats editStats[4];
+	ChunkLighting lighting;
+	int const editCount = 256;
+	for (int editIndex = 0; editIndex < 2 * editCount; editIndex++)
+	{
+		unsigned int random = Get1dNoiseUint(editIndex, (unsigned int)seed);
+		int kind = editIndex & 3;
+		double startTime = GetCurrentTimeSeconds();
+		bool isApplied = ApplyLightEdit(chunks[random % chunkCount], (random >> 16) & (BLOCKSPERLAYER - 1), kind, lighting);
+		int updates = 0;
+		if (isApplied && editIndex < editCount)
+		{
+			while (!lighting.IsSettled())
+			{
+				updates += lighting.Process(*editJobSystem, 1.0e9);
+			}
+			editStats[kind].m_seconds += GetCurrentTimeSeconds() - startTime;
+			editStats[kind].m_edits++;
+			editStats[kind].m_updates += updates;
+			editStats[kind].m_mostUpdates = std::max(editStats[kind].m_mostUpdates, updates);
+		}
+		else if (isApplied)
+		{
+			lighting.Process(*editJobSystem, 0.0);
+		}
+		if (editIndex != editCount - 1 && editIndex != 2 * editCount - 1)
+		{
+			continue;
+		}
+		while (!lighting.IsSettled())
+		{
+			lighting.Process(*editJobSystem, 1.0e9);
+		}
+		uint64_t editedChecksum = HashChunkLight(chunks);
+		LightBenchmarkRun run = RunLightBenchmarkFrames(chunks, mostWorkers, 1.0e9);
+		bool isEditMatching = run.m_checksum == editedChecksum;
+		isMatching = isMatching && isEditMatching;
+		if (editIndex < editCount)
+		{
+			for (int kindIndex = 0; kindIndex < 4; kindIndex++)
+			{
+				LightEditStats const& stats = editStats[kindIndex];
+				out_lines.push_back(Stringf("%24s: %4i edits, %7.1f updates and %.3f ms each on average, at most %i updates", editNames[kindIndex], stats.m_edits,
+					stats.m_edits ? (double)stats.m_updates / stats.m_edits : 0.0, stats.m_edits ? stats.m_seconds * 1000.0 / stats.m_edits : 0.0, stats.m_mostUpdates));
+			}
+		}
+		out_lines.push_back(Stringf("%i edits %s: %s", editCount, editIndex < editCount ? "each settled" : "a phase apart",
+			isEditMatching ? "light matches lighting the edited chunks from scratch" : "EDITED LIGHT DIFFERS from lighting the edited chunks from scratch"));
+	}
+	DestroyBenchmarkJobSystem(editJobSystem);
+	DeleteBenchmarkChunks(chunks);
+	return isMatching;
+}
+
+//--------------------------------------------------------------------
+bool Command_LightBenchmark(EventArgs& args)
+{
+	int chunkCount = args.GetValue("chunks", 64);
+	int seed = args.GetValue("seed", g_gameConfigBlackboard.GetValue("WORLD_SEED", WORLD_SEED));
+	int maxWorkers = args.GetValue("workers", 12);
+	float budgetMs = args.GetValue("budget", g_gameConfigBlackboard.GetValue("CHUNK_LIGHTING_BUDGET_MS", CHUNK_LIGHTING_BUDGET_MS));
+
+	std::vector<std::string> lines;
+	RunLightBenchmark(chunkCount, seed, maxWorkers, budgetMs, lines);
+	PrintBenchmarkLines(lines);
+	return true;
+}
+
+//--------------------------------------------------------------------
+int RunHeadlessTerrainBenchmark(char const* commandLine)
+{
+	tinyxml2::XMLDocument doc;
+	doc.LoadFile("Data/GameConfig.xml");
+	XmlElement* element = doc.RootElement();
+	while (element)
+	{
+		g_gameConfigBlackboard.PopulateFromXmlElementAttributes(*element);
+		element = element->NextSiblingElement();
+	}
+
+	// no sprite sheet, so the block definitions skip their UVs
+	BlockDefinition::Initialize("Data/Definitions/BlockDefinitions.xml");
+	BlockTemplate::Initialize("Data/Definitions/BlockTemplates.xml");
+	BuildingTemplate::Initialize("Data/Definitions/TemplateNames.xml");
+	if (BlockDefinition::s_definitions.empty())
+	{
+		printf("terrainbench: Data/Definitions/BlockDefinitions.xml not found, run from the Run folder\n");
+		return 1;
+	}
+
+	EventArgs args;
+	Strings words = SplitStringOnDelimiter(commandLine, ' ');
+	for (int index = 0; index < (int)words.size(); index++)
+	{
+		Strings keyValue = SplitStringOnDelimiter(words[index], '=');
+		if (keyValue.size() == 2)
+		{
+			args.SetValue(keyValue[0], keyValue[1]);
+		}
+	}
+	int seed = args.GetValue("seed", g_gameConfigBlackboard.GetValue("WORLD_SEED", WORLD_SEED));
+	std::string filename = args.GetValue("file", "TerrainBenchmark.txt");
+
+	std::vector<std::string> lines;
+	bool isMatching = true;
+	if (strstr(commandLine, "noisebench") != nullptr)
+	{
+		isMatching = RunNoiseBenchmark(args.GetValue("samples", 65536), seed, lines) && isMatching;
+	}
+	if (strstr(commandLine, "meshbench") != nullptr)
+	{
+		isMatching = RunMeshBenchmark(args.GetValue("chunks", 16), seed, lines) && isMatching;
+	}
+	if (strstr(commandLine, "chunkindexbench") != nullptr)
+	{
+		isMatching = RunChunkIndexBenchmark(args.GetValue("radius", 64), lines) && isMatching;
+	}
+	if (strstr(commandLine, "lightbench") != nullptr)
+	{
+		isMatching = RunLightBenchmark(args.GetValue("chunks", 64), seed, args.GetValue("workers", 12), args.GetValue("budget", CHUNK_LIGHTING_BUDGET_MS), lines) && isMatching;
+	}
+	if (strstr(commandLine, "terrainbench") != nullptr)
+	{
+		isMatching = RunTerrainBenchmarks(args.GetValue("chunks", 256), seed, args.GetValue("workers", 12), lines) && isMatching;
+	}
+	for (int index = 0; index < (int)lines.size(); index++)
+	{
+		printf("%s\n", lines[index].c_str());
+		DebuggerPrintf("%s\n", lines[index].c_str());
+	}
+	WriteTerrainBenchmarkReport(lines, filename);
+
+	BuildingTemplate::Destroy();
+	BlockTemplate::Destroy();
+	return isMatching ? 0 : 2;
+}
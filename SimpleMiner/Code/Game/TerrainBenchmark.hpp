@@ -0,0 +1,66 @@
+#pragma once
+#include "Game/Chunk.hpp"
+#include "Game/NoiseTileCache.hpp"
+#include <string>
+#include <vector>
+
+// generates chunks at a fixed seed without a renderer or window, so terrain changes can be timed and checked bit-exact
+struct TerrainBenchmarkResult
+{
+	int m_workerThreads = 0;		// 0 generates every chunk on the calling thread
+	int m_chunkCount = 0;
+	double m_seconds = 0.0;			// wall clock for the whole run
+	ChunkGenerationTimes m_phases;	// summed over every chunk, with workers this adds up to more than m_seconds
+	uint64_t m_checksum = 0;		// FNV-1a of every chunk's blocks, folded in chunk order
+	ChunkBlockMemory m_blockMemory;	// of every chunk once generated
+};
+
+// cache is shared by every chunk of the run when given, start it cold to measure a fresh world
+TerrainBenchmarkResult RunTerrainBenchmark(int chunkCount, int seed, int workerThreads, NoiseTileCache* cache = nullptr);
+// a serial run, then 1, 2, 4 ... workers up to maxWorkers, then serial and widest again with a noise tile cache,
+// one line per run (and the cache's hit rate and memory), returns false if any checksum differs
+bool RunTerrainBenchmarks(int chunkCount, int seed, int maxWorkers, std::vector<std::string>& out_lines);
+
+// console command: terrainbench chunks=<count> seed=<seed> workers=<max> file=<path>
+bool Command_TerrainBenchmark(EventArgs& args);
+
+// samples/s of Compute2dPerlinNoise against the batched SIMD version over a grid of samples, for the octave counts
+// chunk generation uses and for its fused six field bundle, returns false if any batched sample is further than
+// NOISE_BATCH_TOLERANCE from the scalar one
+constexpr float NOISE_BATCH_TOLERANCE = 1e-6f;
+bool RunNoiseBenchmark(int samples, int seed, std::vector<std::string>& out_lines);
+
+// console command: noisebench samples=<count> seed=<seed>
+bool Command_NoiseBenchmark(EventArgs& args);
+
+// lights a square of about chunkCount generated chunks (each with its four neighbors) and meshes them per face and greedy,
+// each into Vertex_PCU and packed Vertex_Voxel, one line per mesher with the vertex, index and byte counts and meshing time,
+// returns false if the meshes do not cover the same block faces, light any block face differently, a mesh job snapshot
+// meshes differently from its chunk or remeshing only an edited section leaves a different mesh than a whole remesh
+bool RunMeshBenchmark(int chunkCount, int seed, std::vector<std::string>& out_lines);
+
+// console command: meshbench chunks=<count> seed=<seed>
+bool Command_MeshBenchmark(EventArgs& args);
+
+// std::map against ChunkGrid for activation ranges of 8, 16, 32 ... up to maxRadius chunks: finds, the activation scan
+// World::Update makes every frame as it was against as it is now, and a pass over every chunk, one line per range, returns
+// false if the grid finds, scans or iterates differently from the map
+bool RunChunkIndexBenchmark(int maxRadius, std::vector<std::string>& out_lines);
+
+// console command: chunkindexbench radius=<chunks>
+bool Command_ChunkIndexBenchmark(EventArgs& args);
+
+// lights a square of about chunkCount generated and linked chunks from scratch, as activating them all at once would, with
+// ChunkLighting on the calling thread and then on 1, 2, 4 ... workers up to maxWorkers, unbudgeted and then in frames of
+// budgetMs, one line per run, then times discarding every chunk with its lighting pending, then digs and places blocks at
+// random columns and counts the light updates each takes, returns false if any run leaves different light, a discard leaves
+// lighting pending or the edited light is not what lighting the edited chunks from scratch leaves
+bool RunLightBenchmark(int chunkCount, int seed, int maxWorkers, float budgetMs, std::vector<std::string>& out_lines);
+
+// console command: lightbench chunks=<count> seed=<seed> workers=<max> budget=<ms>
+bool Command_LightBenchmark(EventArgs& args);
+
+// "SimpleMiner.exe terrainbench chunks=256 workers=12" (or noisebench samples=65536, meshbench chunks=16, chunkindexbench radius=64,
+// lightbench chunks=64) runs the benchmark instead of the game,
+// without creating a window, and writes the report to file= (TerrainBenchmark.txt by default), returns the process exit code
+int RunHeadlessTerrainBenchmark(char const* commandLine);
@@ -2,6 +2,7 @@
 #include "Game\TestJob.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Math/Easing.hpp"
+#include <thread>
 
 TestJob::TestJob(int id) 
 	: Job(0xFFFF), m_id(id)
@@ -1,5 +1,4 @@
 #pragma once
-#include <thread>
 #include "Engine/Math/IntVec2.hpp"
 
 class JobWorkerThread;
@@ -18,6 +17,5 @@ public:
 	int m_id;
 	int m_waitTime = 1000;
 	int m_elapsed = 0;
-	std::thread m_thread;
 };
 
@@ -7,6 +7,9 @@
 #include "ChunkGenerateJob.hpp"
 #include "ChunkLoadJob.hpp"
 #include "ChunkSaveJob.hpp"
+#include "ChunkMeshJob.hpp"
+#include <algorithm>
+#include "Engine/Core/Profiler.hpp"
 
 constexpr bool doMultithreaded = true;
 
@@ -18,6 +21,10 @@ World::~World()
 	}
 
 	ClearChunkMap();
+	for (ChunkMeshSnapshot* snapshot : m_freeMeshSnapshots)
+	{
+		delete snapshot;
+	}
 }
 
 //------------------------------------------------------------------------------------
@@ -29,6 +36,8 @@ World::World(int worldSeed)
 	m_maxChunksRadiusY = 1 + int(m_chunkActivationRange) / SIZE_Y;
 	m_inactiveRange = m_chunkActivationRange + SIZE_X + SIZE_Y;
 	m_maxChunks = (2 * m_maxChunksRadiusX) * (2 * m_maxChunksRadiusY); 
+	m_chunkActivationBudget = 0.001 * (double)g_gameConfigBlackboard.GetValue("CHUNK_ACTIVATION_BUDGET_MS", CHUNK_ACTIVATION_BUDGET_MS);
+	m_lightingBudget = 0.001 * (double)g_gameConfigBlackboard.GetValue("CHUNK_LIGHTING_BUDGET_MS", CHUNK_LIGHTING_BUDGET_MS);
 	m_path = "Saves/";
 	m_path += std::to_string(m_worldSeed);
 	_mkdir(m_path.c_str()); // make sure we have this directory
@@ -90,183 +99,128 @@ float World::CalcChunkToCameraDistance(Chunk* chunk)
 }
 
 //------------------------------------------------------------------------------------
-void World::Update(float deltaSeconds)
+// chunks in view of the camera run in the high lane and every chunk is due by the time the player could reach it
+void World::GetChunkJobUrgency(IntVec2 const& chunkCoords, JobPriority& out_priority, double& out_deadline) const
 {
-	m_timeOfDay += (deltaSeconds * m_worldTimeScale) / (60.f * 60.f * 24.f);
+	AABB2 bounds = Chunk::GetChunkWorldBounds(chunkCoords.x, chunkCoords.y);
+	Vec2 toChunk = bounds.GetCenter() - Vec2(m_player->m_cameraPosition.x, m_player->m_cameraPosition.y);
+	float distance = toChunk.GetLength();
+	Vec3 forward = m_player->m_cameraOrientation.GetForwardNormal();
+	Vec2 heading(forward.x, forward.y);
 
-	ChunkMap::iterator iter;
-	// activate or deactivate chunks
-	IntVec2 activateCandidate = IntVec2::ZERO;
-	float activateCandidateRange = 2.0f * m_chunkActivationRange * m_chunkActivationRange;
-	IntVec2 playerChunk = Chunk::GetChunkForWorldPosition(m_player->m_position);
-	float distance = 0.0f;
-	AABB2 bounds = AABB2::ZERO_TO_ONE;
-
-	if (m_chunkCount < m_maxChunks)
+	bool isInView = distance < CHUNK_NEAR_DISTANCE || heading.GetLength() < 0.01f; // looking straight up or down sees everything
+	if (!isInView)
 	{
-		for (int x = playerChunk.x - m_maxChunksRadiusX; x < playerChunk.x + m_maxChunksRadiusX; x++)
-		{
-			for (int y = playerChunk.y - m_maxChunksRadiusY; y < playerChunk.y + m_maxChunksRadiusY; y++)
-			{
-				bounds = Chunk::GetChunkWorldBounds(x, y);
-				if ((distance = DistanceSquared(bounds.m_mins.x, bounds.m_mins.y, m_player->m_position)) < m_chunkActivationRange * m_chunkActivationRange)
-				{
-					if (distance < activateCandidateRange && GetMappedValue(IntVec2(x, y)) == nullptr && NotLiveChunk(IntVec2(x, y)))
-					{
-						activateCandidate = IntVec2(x, y);
-						activateCandidateRange = distance;
-					}
-				}
-				if ((distance = DistanceSquared(bounds.m_mins.x, bounds.m_maxs.y, m_player->m_position)) < m_chunkActivationRange * m_chunkActivationRange)
-				{
-					if (distance < activateCandidateRange && GetMappedValue(IntVec2(x, y)) == nullptr && NotLiveChunk(IntVec2(x, y)))
-					{
-						activateCandidate = IntVec2(x, y);
-						activateCandidateRange = distance;
-					}
-				}
-				if ((distance = DistanceSquared(bounds.m_maxs.x, bounds.m_mins.y, m_player->m_position)) < m_chunkActivationRange * m_chunkActivationRange)
-				{
-					if (distance < activateCandidateRange && GetMappedValue(IntVec2(x, y)) == nullptr && NotLiveChunk(IntVec2(x, y)))
-					{
-						activateCandidate = IntVec2(x, y);
-						activateCandidateRange = distance;
-					}
-				}
-				if ((distance = DistanceSquared(bounds.m_maxs.x, bounds.m_maxs.y, m_player->m_position)) < m_chunkActivationRange * m_chunkActivationRange)
-				{
-					if (distance < activateCandidateRange && GetMappedValue(IntVec2(x, y)) == nullptr && NotLiveChunk(IntVec2(x, y)))
-					{
-						activateCandidate = IntVec2(x, y);
-						activateCandidateRange = distance;
-					}
-				}
-			}
-		}
+		isInView = DotProduct2D(heading.GetNormalized(), toChunk / distance) > CHUNK_VIEW_COSINE;
 	}
+	out_priority = isInView ? JobPriority::HIGH : JobPriority::NORMAL;
+	out_deadline = GetCurrentTimeSeconds() + (double)(distance / CHUNK_APPROACH_SPEED);
+}
 
-	// activate or deactivate one chunk if possible
-	if (activateCandidateRange < 2.0f * m_chunkActivationRange * m_chunkActivationRange && m_chunkCount < m_maxChunks)
-	{
-		m_chunkCount++;
-		Chunk* chunk = new Chunk();
-		m_chunksLive[activateCandidate] = chunk;
-		chunk->m_status = ChunkState::CHUNK_INITIALIZING;
-
-		chunk->Initialize(activateCandidate);
-		chunk->m_status = ChunkState::CHUNK_READY;
+//------------------------------------------------------------------------------------
+void World::QueueChunkJob(Job* job, IntVec2 const& chunkCoords)
+{
+	GetChunkJobUrgency(chunkCoords, job->m_priority, job->m_deadline);
+	QueuedChunkJob queued;
+	queued.m_job = job;
+	queued.m_chunkCoords = chunkCoords;
+	m_queuedChunkJobs.push_back(queued);
+	g_theJobSystem->QueueJob(job);
+}
 
-		char filename[80];
-		sprintf_s(filename, "%s/Chunk(%i,%i).chunk", g_theGame->m_world->m_path.c_str(), activateCandidate.x, activateCandidate.y);
-		if (fileExists(filename))
-		{
-			if (doMultithreaded)
-			{
-				Job* job = new ChunkLoadJob(chunk, JobType::JOB_LOAD); // assumes no failure
-				chunk->m_status = ChunkState::CHUNK_QUEUED;
-				g_theJobSystem->QueueJob(job);
-			}
-			else
-			{
-				chunk->ReadChunkFromDisc(filename);
-				chunk->Activate(*this); // temporary
-				m_chunks[activateCandidate] = chunk;
-			}
-		}
-		else
-		{
-			if (doMultithreaded)
-			{
-				Job* job = new ChunkGenerateJob(chunk); // assumes no failure
-				job->m_jobType = JobType::JOB_CREATE;
-				chunk->m_status = ChunkState::CHUNK_QUEUED;
-				g_theJobSystem->QueueJob(job);
-			}
-			else
-			{
-				// old version of the code
-				chunk->Create();
-				chunk->Activate(*this);
-				m_chunks[activateCandidate] = chunk;
-			}
-		}
-	}
-	else if (m_chunkCount == m_maxChunks)
+//------------------------------------------------------------------------------------
+// only once the player is in another chunk, and no more often than CHUNK_JOB_REPRIORITIZE_SECONDS however fast they fly,
+// the ranks from the last pass stay good enough while they are still in the same chunk
+void World::UpdateChunkJobPriorities()
+{
+	IntVec2 playerChunk = Chunk::GetChunkForWorldPosition(m_player->m_position);
+	double now = GetCurrentTimeSeconds();
+	if (playerChunk == m_priorityCenter || now - m_lastReprioritizeTime < CHUNK_JOB_REPRIORITIZE_SECONDS)
 	{
-		// test whether to deactivate
-		AABB3 bounds3 = AABB3::ZERO_TO_ONE;
-		IntVec2 deactivateCandidate = IntVec2::ZERO;
-		float deactivateCandidateRange = 0.0f;
-		distance = 0.0f;
+		return;
+	}
+	m_priorityCenter = playerChunk;
+	m_lastReprioritizeTime = now;
 
-		for (iter = m_chunks.begin(); iter != m_chunks.end(); iter++)
+	PROFILE_SCOPE("World::UpdateChunkJobPriorities");
+	for (int index = 0; index < (int)m_queuedChunkJobs.size(); index++)
+	{
+		QueuedChunkJob& queued = m_queuedChunkJobs[index];
+		if (queued.m_job->m_state != JobState::QUEUED)
 		{
-			Chunk* chunk = iter->second;
-			bounds3 = chunk->m_worldBounds;
-			if ((distance = DistanceSquared(bounds3.GetCenter().x, bounds3.GetCenter().y, m_player->m_position)) > m_inactiveRange * m_inactiveRange)
-			{
-				if (distance > deactivateCandidateRange)
-				{
-					deactivateCandidate = chunk->m_chunkCoords;
-					deactivateCandidateRange = distance;
-				}
-			}
+			continue;
 		}
+		JobPriority priority = JobPriority::NORMAL;
+		double deadline = 0.0;
+		GetChunkJobUrgency(queued.m_chunkCoords, priority, deadline);
+		g_theJobSystem->Reprioritize(queued.m_job, priority, deadline);
+	}
+}
 
-		if (deactivateCandidateRange > 0.0f)
+//------------------------------------------------------------------------------------
+void World::RemoveQueuedChunkJob(Job* job)
+{
+	for (int index = 0; index < (int)m_queuedChunkJobs.size(); index++)
+	{
+		if (m_queuedChunkJobs[index].m_job == job)
 		{
-			m_chunkCount--;
-			Chunk* chunk = GetMappedValue(deactivateCandidate);
-			if (doMultithreaded)
-			{
-				m_chunks.erase(chunk->m_chunkCoords);
-				m_chunksLive.erase(chunk->m_chunkCoords);
-				UnlinkNeighbors(chunk);
-				if (chunk->m_chunkCoords != deactivateCandidate)
-				{
-					ERROR_RECOVERABLE("Chunk coords corrupted");
-				}
-				Job* job = new ChunkSaveJob(chunk, JobType::JOB_SAVE); // assumes no failure
-				chunk->m_status = ChunkState::CHUNK_QUEUED;
-				g_theJobSystem->QueueJob(job);
-			}
-			else
-			{
-				UnlinkNeighbors(chunk);
-				chunk->Deactivate();
-				delete chunk;
-				m_chunks.erase(deactivateCandidate);
-				m_chunksLive.erase(deactivateCandidate); // put in the right place
-			}
+			m_queuedChunkJobs[index] = m_queuedChunkJobs.back();
+			m_queuedChunkJobs.pop_back();
+			return;
 		}
 	}
+}
 
-	// check completed jobs for chunks to activate
-	Job* job = g_theJobSystem->RetrieveCompletedJob();
-	if (job)
+//------------------------------------------------------------------------------------
+void World::RetireCompletedChunkJobs()
+{
+	PROFILE_SCOPE("World::RetireCompletedChunkJobs");
+	m_completedJobs.clear();
+	g_theJobSystem->RetrieveCompletedJobs(m_completedJobs);
+	for (int index = 0; index < (int)m_completedJobs.size(); index++)
 	{
+		Job* job = m_completedJobs[index];
 		switch (job->m_jobType)
 		{
 		case JobType::JOB_CREATE:
 			{
+			RemoveQueuedChunkJob(job);
 			ChunkGenerateJob* chunkJob = dynamic_cast<ChunkGenerateJob*>(job);
 			Chunk* chunk1 = chunkJob->m_chunk;
 			chunk1->Activate(*this);
-			m_chunks[chunk1->m_chunkCoords] = chunk1;
+			m_chunks.Insert(chunk1->m_chunkCoords, chunk1);
 			chunk1->m_status = ChunkState::CHUNK_ACTIVE;
 			delete job;
 			}
 			break;
 		case JobType::JOB_LOAD:
 			{
+			RemoveQueuedChunkJob(job);
 			ChunkLoadJob* ioJob = dynamic_cast<ChunkLoadJob*>(job);
 			Chunk* chunk2 = ioJob->m_chunk;
 			chunk2->Activate(*this);
-			m_chunks[chunk2->m_chunkCoords] = chunk2;
+			m_chunks.Insert(chunk2->m_chunkCoords, chunk2);
 			chunk2->m_status = ChunkState::CHUNK_ACTIVE;
 			delete job;
 			}
 			break;
+		case JobType::JOB_MESH:
+			{
+			RemoveQueuedChunkJob(job);
+			ChunkMeshJob* meshJob = dynamic_cast<ChunkMeshJob*>(job);
+			Chunk* chunk4 = GetMappedValue(meshJob->m_chunkCoords);
+			if (chunk4 && chunk4->m_meshJob == job) // otherwise the chunk was deactivated while its mesh was built
+			{
+				chunk4->TakeMesh(meshJob->m_snapshot->m_chunk);
+				chunk4->CreateBuffers();
+				chunk4->m_meshJob = nullptr;
+			}
+			m_freeMeshSnapshots.push_back(meshJob->m_snapshot);
+			meshJob->m_snapshot = nullptr;
+			m_meshJobsInFlight--;
+			delete job;
+			}
+			break;
 		case JobType::JOB_SAVE:
 			{
 			ChunkSaveJob* ioJob = dynamic_cast<ChunkSaveJob*>(job);
@@ -283,53 +237,293 @@ void World::Update(float deltaSeconds)
 			break;
 		}
 	}
+}
 
-	// do lighting update after activate/deactive and before updating chunks
-	ProcessDirtyLighting();
+//------------------------------------------------------------------------------------
+// snapshots the nearest chunks that need a mesh and whose light has settled, a chunk changed while its job runs is queued again
+// once the job is retired
+void World::QueueChunkMeshJobs()
+{
+	PROFILE_SCOPE("World::QueueChunkMeshJobs");
+	int jobCount = MAX_CHUNK_MESH_JOBS - m_meshJobsInFlight;
+	if (jobCount <= 0)
+	{
+		return;
+	}
 
-	// Get closest two chunks that need mesh updates
-	Chunk* nearest = nullptr;
-	Chunk* nearby = nullptr;
-	float nearestDistance = 9999.0f;
-	float testDistance = 0.0f;
+	m_meshCandidates.clear();
+	for (Chunk* chunk : m_chunks)
+	{
+		if (chunk->NeedsMesh() && chunk->m_meshJob == nullptr && !chunk->m_lightQueue.IsScheduled())
+		{
+			m_meshCandidates.push_back(std::make_pair(CalcChunkToCameraDistance(chunk), chunk));
+		}
+	}
+	jobCount = jobCount < (int)m_meshCandidates.size() ? jobCount : (int)m_meshCandidates.size();
+	std::partial_sort(m_meshCandidates.begin(), m_meshCandidates.begin() + jobCount, m_meshCandidates.end());
 
-	for (iter = m_chunks.begin(); iter != m_chunks.end(); iter++)
+	for (int index = 0; index < jobCount; index++)
 	{
-		Chunk* chunk = iter->second;
-		if (chunk->m_needsMesh)
+		Chunk* chunk = m_meshCandidates[index].second;
+		ChunkMeshSnapshot* snapshot = nullptr;
+		if (m_freeMeshSnapshots.empty())
+		{
+			snapshot = new ChunkMeshSnapshot();
+		}
+		else
+		{
+			snapshot = m_freeMeshSnapshots.back();
+			m_freeMeshSnapshots.pop_back();
+		}
+		snapshot->CopyFrom(*chunk);
+
+		Job* job = new ChunkMeshJob(chunk->m_chunkCoords, snapshot, Chunk::s_greedyMeshing, Chunk::s_packedVertexes);
+		chunk->m_meshJob = job;
+		chunk->m_sectionsNeedingMesh = 0;
+		m_meshJobsInFlight++;
+		QueueChunkJob(job, chunk->m_chunkCoords);
+	}
+}
+
+//------------------------------------------------------------------------------------
+// the offsets are measured from the center of the player's chunk, so the ring only changes when the player crosses into
+// another chunk, the chunks left past m_inactiveRange are queued for deactivation at the same time
+void World::RebuildChunkActivationRing(IntVec2 const& playerChunk)
+{
+	PROFILE_SCOPE("World::RebuildChunkActivationRing");
+	Vec3 chunkCenter(0.5f * (float)SIZE_X, 0.5f * (float)SIZE_Y, 0.0f);
+	if (m_activationOffsets.empty())
+	{
+		// the nearest corner of each chunk, as the per frame scan measured it from the player
+		std::vector<std::pair<float, IntVec2>> offsets;
+		float activationRangeSquared = m_chunkActivationRange * m_chunkActivationRange;
+		for (int x = -m_maxChunksRadiusX; x <= m_maxChunksRadiusX; x++)
 		{
-			testDistance = CalcChunkToCameraDistance(chunk);
-			if (testDistance < nearestDistance)
+			for (int y = -m_maxChunksRadiusY; y <= m_maxChunksRadiusY; y++)
 			{
-				nearby = nearest;
-				nearest = chunk;
-				nearestDistance = testDistance;
+				AABB2 bounds = Chunk::GetChunkWorldBounds(x, y);
+				float distance = std::min(std::min(DistanceSquared(bounds.m_mins.x, bounds.m_mins.y, chunkCenter), DistanceSquared(bounds.m_mins.x, bounds.m_maxs.y, chunkCenter)),
+					std::min(DistanceSquared(bounds.m_maxs.x, bounds.m_mins.y, chunkCenter), DistanceSquared(bounds.m_maxs.x, bounds.m_maxs.y, chunkCenter)));
+				if (distance < activationRangeSquared)
+				{
+					offsets.push_back(std::make_pair(distance, IntVec2(x, y)));
+				}
 			}
 		}
+		std::sort(offsets.begin(), offsets.end());
+		for (std::pair<float, IntVec2> const& offset : offsets)
+		{
+			m_activationOffsets.push_back(offset.second);
+		}
 	}
-	if (nearest && nearest->m_needsMesh)
+	m_activationCenter = playerChunk;
+	m_activationCursor = 0;
+
+	m_deactivationQueue.clear();
+	float inactiveRangeSquared = m_inactiveRange * m_inactiveRange;
+	for (Chunk* chunk : m_chunksLive)
+	{
+		IntVec2 offset = chunk->m_chunkCoords - playerChunk;
+		if (DistanceSquared((float)(offset.x * SIZE_X), (float)(offset.y * SIZE_Y), Vec3::ZERO) > inactiveRangeSquared)
+		{
+			m_deactivationQueue.push_back(chunk->m_chunkCoords);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------
+void World::ActivateChunk(IntVec2 const& chunkCoords)
+{
+	m_chunkCount++;
+	Chunk* chunk = new Chunk();
+	m_chunksLive.Insert(chunkCoords, chunk);
+	chunk->m_status = ChunkState::CHUNK_INITIALIZING;
+
+	chunk->Initialize(chunkCoords);
+	chunk->m_status = ChunkState::CHUNK_READY;
+
+	char filename[80];
+	sprintf_s(filename, "%s/Chunk(%i,%i).chunk", g_theGame->m_world->m_path.c_str(), chunkCoords.x, chunkCoords.y);
+	if (fileExists(filename))
 	{
-		nearest->CreateGeometry();
-		nearest->CreateBuffers();
-		nearest->m_needsMesh = false;
+		if (doMultithreaded)
+		{
+			Job* job = new ChunkLoadJob(chunk, JobType::JOB_LOAD); // assumes no failure
+			chunk->m_status = ChunkState::CHUNK_QUEUED;
+			QueueChunkJob(job, chunkCoords);
+		}
+		else
+		{
+			chunk->ReadChunkFromDisc(filename);
+			chunk->Activate(*this); // temporary
+			m_chunks.Insert(chunkCoords, chunk);
+		}
 	}
-	if (nearby && nearby->m_needsMesh)
+	else
 	{
-		nearby->CreateGeometry();
-		nearby->CreateBuffers();
-		nearby->m_needsMesh = false;
+		if (doMultithreaded)
+		{
+			Job* job = new ChunkGenerateJob(chunk); // assumes no failure
+			job->m_jobType = JobType::JOB_CREATE;
+			chunk->m_status = ChunkState::CHUNK_QUEUED;
+			QueueChunkJob(job, chunkCoords);
+		}
+		else
+		{
+			// old version of the code
+			chunk->Create();
+			chunk->Activate(*this);
+			m_chunks.Insert(chunkCoords, chunk);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------------
+void World::DeactivateChunk(Chunk* chunk)
+{
+	m_chunkCount--;
+	IntVec2 chunkCoords = chunk->m_chunkCoords;
+	DiscardChunkLighting(chunk);
+	if (doMultithreaded)
+	{
+		m_chunks.Erase(chunkCoords);
+		m_chunksLive.Erase(chunkCoords);
+		UnlinkNeighbors(chunk);
+		Job* job = new ChunkSaveJob(chunk, JobType::JOB_SAVE); // assumes no failure
+		job->m_priority = JobPriority::LOW; // nothing waits on a save
+		chunk->m_status = ChunkState::CHUNK_QUEUED;
+		g_theJobSystem->QueueJob(job);
+	}
+	else
+	{
+		UnlinkNeighbors(chunk);
+		chunk->Deactivate();
+		delete chunk;
+		m_chunks.Erase(chunkCoords);
+		m_chunksLive.Erase(chunkCoords); // put in the right place
+	}
+}
+
+//------------------------------------------------------------------------------------
+// deactivates the queued chunks, then walks the ring from the cursor activating every chunk that is not live yet, until the
+// frame's budget runs out or enough generate and load jobs are queued to keep the workers busy, whichever comes first
+void World::UpdateChunkActivation()
+{
+	PROFILE_SCOPE("World::UpdateChunkActivation");
+	IntVec2 playerChunk = Chunk::GetChunkForWorldPosition(m_player->m_position);
+	if (m_activationCursor < 0 || playerChunk != m_activationCenter)
+	{
+		RebuildChunkActivationRing(playerChunk);
+	}
+	double budgetEnd = GetCurrentTimeSeconds() + m_chunkActivationBudget;
+
+	// first, so the chunks they make room for can be activated this frame
+	int deactivated = 0;
+	int queued = 0;
+	for (int index = 0; index < (int)m_deactivationQueue.size(); index++)
+	{
+		IntVec2 chunkCoords = m_deactivationQueue[index];
+		Chunk* chunk = m_chunks.Find(chunkCoords);
+		if (chunk == nullptr || (deactivated > 0 && GetCurrentTimeSeconds() > budgetEnd))
+		{
+			if (chunk != nullptr || m_chunksLive.Contains(chunkCoords))
+			{
+				m_deactivationQueue[queued++] = chunkCoords; // out of time, or still being generated or loaded
+			}
+			continue;
+		}
+		DeactivateChunk(chunk);
+		deactivated++;
+	}
+	m_deactivationQueue.resize(queued);
+
+	int jobsAllowed = CHUNK_ACTIVATION_JOBS_PER_WORKER * g_theJobSystem->m_workerThreads - (m_chunksLive.GetCount() - m_chunks.GetCount());
+	int activated = 0;
+	while (m_activationCursor < (int)m_activationOffsets.size() && m_chunkCount < m_maxChunks)
+	{
+		IntVec2 chunkCoords = m_activationCenter + m_activationOffsets[m_activationCursor];
+		if (NotLiveChunk(chunkCoords))
+		{
+			if (jobsAllowed <= 0 || (activated > 0 && GetCurrentTimeSeconds() > budgetEnd))
+			{
+				break;
+			}
+			ActivateChunk(chunkCoords);
+			activated++;
+			jobsAllowed--;
+		}
+		m_activationCursor++;
+	}
+}
+
+//------------------------------------------------------------------------------------
+void World::Update(float deltaSeconds)
+{
+	PROFILE_SCOPE("World::Update");
+	m_timeOfDay += (deltaSeconds * m_worldTimeScale) / (60.f * 60.f * 24.f);
+
+	// activate or deactivate as many chunks as fit in the frame's budget
+	UpdateChunkActivation();
+
+	// chunks the player now approaches move ahead of ones it left behind, re-ranked when it changes chunk
+	UpdateChunkJobPriorities();
+
+	// activate every chunk that finished since the last frame, one per frame falls behind during fast flight
+	RetireCompletedChunkJobs();
+
+	// do lighting update after activate/deactive and before updating chunks, as much of it as fits the budget
+	ProcessDirtyLighting();
+
+	// meshes are built on workers from snapshots, this thread only uploads them when their jobs are retired
+	int meshCanUpdate = 0;
+	if (doMultithreaded)
+	{
+		QueueChunkMeshJobs();
+	}
+	else
+	{
+		// Get closest two chunks that need mesh updates
+		Chunk* nearest = nullptr;
+		Chunk* nearby = nullptr;
+		float nearestDistance = 9999.0f;
+		float testDistance = 0.0f;
+
+		for (Chunk* chunk : m_chunks)
+		{
+			if (chunk->NeedsMesh())
+			{
+				testDistance = CalcChunkToCameraDistance(chunk);
+				if (testDistance < nearestDistance)
+				{
+					nearby = nearest;
+					nearest = chunk;
+					nearestDistance = testDistance;
+				}
+			}
+		}
+		if (nearest && nearest->NeedsMesh())
+		{
+			nearest->CreateGeometry();
+			nearest->CreateBuffers();
+			nearest->m_sectionsNeedingMesh = 0;
+		}
+		if (nearby && nearby->NeedsMesh())
+		{
+			nearby->CreateGeometry();
+			nearby->CreateBuffers();
+			nearby->m_sectionsNeedingMesh = 0;
+		}
+		meshCanUpdate = 2;
 	}
 
 	// update chunks
-	int meshCanUpdate = 2;
-	for (iter = m_chunks.begin(); iter != m_chunks.end(); iter++)
+	for (Chunk* chunk : m_chunks)
 	{
-		Chunk* chunk = iter->second;
-		if ((meshCanUpdate > 0) && chunk->m_needsMesh)
+		if ((meshCanUpdate > 0) && chunk->NeedsMesh())
 		{
 			chunk->CreateGeometry();
 			chunk->CreateBuffers();
-			chunk->m_needsMesh = false;
+			chunk->m_sectionsNeedingMesh = 0;
 			meshCanUpdate--;
 		}
 		chunk->Update(deltaSeconds);
@@ -353,6 +547,7 @@ void World::Update(float deltaSeconds)
 //------------------------------------------------------------------------------------
 void World::Render()
 {
+	PROFILE_SCOPE("World::Render");
 	std::vector<Vertex_PCU> vertexArray;
 
 	// create basis at origin TEST DEBUG
@@ -375,14 +570,8 @@ void World::Render()
 	g_theRenderer->DrawVertexArray(int(vertexArray.size()), &vertexArray[0]);
 	vertexArray.clear();
 
-	ChunkMap::iterator iter;
-	for (iter = m_chunks.begin(); iter != m_chunks.end(); iter++)
+	for (Chunk* chunk : m_chunks)
 	{
-		Chunk* chunk = iter->second;
-		if (iter->first != chunk->m_chunkCoords)
-		{
-			ERROR_RECOVERABLE("Mismatch in render");
-		}
 		chunk->Render();
 	}
 
@@ -400,54 +589,41 @@ float World::DistanceSquared(float x, float y, Vec3 position)
 //------------------------------------------------------------------------------------
 bool World::NotLiveChunk(IntVec2 const& keyName) const
 {
-	auto iter = m_chunksLive.find(keyName);
-	if (iter == m_chunksLive.end())
-	{
-		return true;
-	}
-	return false;
+	return !m_chunksLive.Contains(keyName);
 }
 
 //------------------------------------------------------------------------------------
 bool World::EraseLiveChunk(IntVec2 const& keyName) const
 {
-	ChunkMap::const_iterator iter = m_chunks.find(keyName);
-	if (iter == m_chunks.end())
-	{
-		return false;
-	}
-	return true;
+	return m_chunks.Contains(keyName);
 }
 
 //------------------------------------------------------------------------------------
 Chunk* World::GetMappedValue(int x, int y) const
 {
-	return GetMappedValue(IntVec2(x, y));
+	return m_chunks.Find(x, y);
 }
 
 //------------------------------------------------------------------------------------
 Chunk* World::GetMappedValue(IntVec2 const& keyName) const
 {
-	ChunkMap::const_iterator iter = m_chunks.find(keyName);
-	if (iter == m_chunks.end())
-	{
-		return nullptr;
-	}
-	return iter->second;
+	return m_chunks.Find(keyName);
 }
 
 //------------------------------------------------------------------------------------
+// chunks still being generated or loaded stay live, they are activated when their jobs are retired
 void World::ClearChunkMap()
 {
-	ChunkMap::iterator iter;
-	for (iter = m_chunks.begin(); iter != m_chunks.end(); iter++)
+	for (Chunk* chunk : m_chunks)
 	{
-		Chunk* chunk = iter->second;
+		m_chunksLive.Erase(chunk->m_chunkCoords);
+		DiscardChunkLighting(chunk);
 		chunk->Deactivate();
 		delete chunk;
 	}
-	m_chunks.clear();
-	m_chunkCount = 0;
+	m_chunks.Clear();
+	m_chunkCount = m_chunksLive.GetCount();
+	m_activationCursor = -1;
 }
 
 //------------------------------------------------------------------------------------
@@ -459,13 +635,13 @@ void World::LinkNeighbors(Chunk* chunk)
 	{
 		neighbor->m_neighbors[SOUTH] = chunk;
 		chunk->m_neighbors[NORTH] = neighbor;
-		neighbor->m_needsMesh = true;
-		chunk->m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
+		chunk->MarkNeedsMesh();
 	}
 	else
 	{
 		chunk->m_neighbors[NORTH] = nullptr;
-		chunk->m_needsMesh = true;
+		chunk->MarkNeedsMesh();
 	}
 
 	neighbor = GetMappedValue(chunk->m_chunkCoords.x + 1, chunk->m_chunkCoords.y);
@@ -473,13 +649,13 @@ void World::LinkNeighbors(Chunk* chunk)
 	{
 		neighbor->m_neighbors[WEST] = chunk;
 		chunk->m_neighbors[EAST] = neighbor;
-		neighbor->m_needsMesh = true;
-		chunk->m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
+		chunk->MarkNeedsMesh();
 	}
 	else
 	{
 		chunk->m_neighbors[EAST] = nullptr;
-		chunk->m_needsMesh = true;
+		chunk->MarkNeedsMesh();
 	}
 
 	neighbor = GetMappedValue(chunk->m_chunkCoords.x, chunk->m_chunkCoords.y - 1);
@@ -487,13 +663,13 @@ void World::LinkNeighbors(Chunk* chunk)
 	{
 		neighbor->m_neighbors[NORTH] = chunk;
 		chunk->m_neighbors[SOUTH] = neighbor;
-		neighbor->m_needsMesh = true;
-		chunk->m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
+		chunk->MarkNeedsMesh();
 	}
 	else
 	{
 		chunk->m_neighbors[SOUTH] = nullptr;
-		chunk->m_needsMesh = true;
+		chunk->MarkNeedsMesh();
 	}
 
 	neighbor = GetMappedValue(chunk->m_chunkCoords.x - 1, chunk->m_chunkCoords.y);
@@ -501,13 +677,13 @@ void World::LinkNeighbors(Chunk* chunk)
 	{
 		neighbor->m_neighbors[EAST] = chunk;
 		chunk->m_neighbors[WEST] = neighbor;
-		neighbor->m_needsMesh = true;
-		chunk->m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
+		chunk->MarkNeedsMesh();
 	}
 	else
 	{
 		chunk->m_neighbors[WEST] = nullptr;
-		chunk->m_needsMesh = true;
+		chunk->MarkNeedsMesh();
 	}
 }
 
@@ -519,152 +695,49 @@ void World::UnlinkNeighbors(Chunk* chunk)
 	if (neighbor)
 	{
 		neighbor->m_neighbors[SOUTH] = nullptr;
-		neighbor->m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
 	}
 
 	neighbor = GetMappedValue(chunk->m_chunkCoords.x + 1, chunk->m_chunkCoords.y);
 	if (neighbor)
 	{
 		neighbor->m_neighbors[WEST] = nullptr;
-		neighbor->m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
 	}
 
 	neighbor = GetMappedValue(chunk->m_chunkCoords.x, chunk->m_chunkCoords.y - 1);
 	if (neighbor)
 	{
 		neighbor->m_neighbors[NORTH] = nullptr;
-		neighbor->m_needsMesh = true;
+		neighbor->MarkNeedsMesh();
 	}
 
 	neighbor = GetMappedValue(chunk->m_chunkCoords.x - 1, chunk->m_chunkCoords.y);
 	if (neighbor)
 	{
 		neighbor->m_neighbors[EAST] = nullptr;
-		neighbor->m_needsMesh = true;
-	}
-}
-
-//------------------------------------------------------------------------------------
-void World::ChangeLightToAtLeastOneLessThanNeighbor(uint8_t& indoor, uint8_t& outdoor, BlockIterator neighbor)
-{
-	if (neighbor.GetBlock() == nullptr)
-	{
-		return;
-	}
-	if (neighbor.GetBlock()->GetIndoorLight() > indoor)
-	{
-		indoor = neighbor.GetBlock()->GetIndoorLight() - 1;
-	}
-	if (neighbor.GetBlock()->GetOutdoorLight() > outdoor)
-	{
-		outdoor = neighbor.GetBlock()->GetOutdoorLight() - 1;
+		neighbor->MarkNeedsMesh();
 	}
 }
 
 //------------------------------------------------------------------------------------
+// chunks are relit on workers a phase at a time until the budget runs out, a chunk still relighting waits to be meshed
 void World::ProcessDirtyLighting()
 {
-	while (!m_queue.empty())
-	{
-		ProcessNextDirtyLightBlock(m_queue.front());
-		m_queue.pop_front();
-	}
+	PROFILE_SCOPE("World::ProcessDirtyLighting");
+	m_lighting.Process(*g_theJobSystem, m_lightingBudget);
 }
 
 //------------------------------------------------------------------------------------
-void World::ProcessNextDirtyLightBlock(BlockIterator& blockIterator)
+// after the block's type changed, only the blocks whose light changes are relit
+void World::UpdateBlockLighting(BlockIterator blockIterator)
 {
-	blockIterator.GetBlock()->SetLightDirty(false);
-	// calculate theoretical correct lighting for block
-	uint8_t indoor = blockIterator.GetBlock()->GetLightEmitted();
-	uint8_t outdoor = 0;
-	if (blockIterator.GetBlock()->IsSky())
-	{
-		outdoor = MAX_LIGHT;
-	}
-
-	// add outdoor glow lighting later if ever
-	// test indoor light of neighbors
-	if (blockIterator.GetBlock()->IsOpaque() == false)
-	{
-		ChangeLightToAtLeastOneLessThanNeighbor(indoor, outdoor, blockIterator.GetEastNeighbor());
-		ChangeLightToAtLeastOneLessThanNeighbor(indoor, outdoor, blockIterator.GetNorthNeighbor());
-		ChangeLightToAtLeastOneLessThanNeighbor(indoor, outdoor, blockIterator.GetWestNeighbor());
-		ChangeLightToAtLeastOneLessThanNeighbor(indoor, outdoor, blockIterator.GetSouthNeighbor());
-		ChangeLightToAtLeastOneLessThanNeighbor(indoor, outdoor, blockIterator.GetTopNeighbor());
-		ChangeLightToAtLeastOneLessThanNeighbor(indoor, outdoor, blockIterator.GetBottomNeighbor());
-	}
-
-	// mark chunk meshes in need of updating if lighting is incorrect
-	if (blockIterator.GetBlock()->GetIndoorLight() != indoor || blockIterator.GetBlock()->GetOutdoorLight() != outdoor)
-	{
-		blockIterator.GetBlock()->SetIndoorLight(indoor);
-		blockIterator.GetBlock()->SetOutdoorLight(outdoor);
-		blockIterator.m_chunk->m_needsMesh = true;
-		MarkNeighborsLightingDirty(blockIterator);
-	}
+	m_lighting.UpdateBlock(blockIterator.m_chunk, blockIterator.m_blockIndex);
 }
 
 //------------------------------------------------------------------------------------
-void World::MarkLightDirtyIfNotOpaque(BlockIterator blockIterator)
+// pending lighting keeps pointers to the chunk, so it must go before the chunk is deactivated, in constant time
+void World::DiscardChunkLighting(Chunk* chunk)
 {
-	if (blockIterator.m_chunk == nullptr)
-	{
-		return;
-	}
-	blockIterator.m_chunk->m_needsMesh = true;
-	if (blockIterator.GetBlock()->IsOpaque() == false)
-	{
-		MarkLightingDirty(blockIterator);
-	}
-}
-
-//------------------------------------------------------------------------------------
-void World::MarkNeighborsLightingDirty(BlockIterator blockIterator)
-{
-	MarkLightDirtyIfNotOpaque(blockIterator.GetEastNeighbor());
-	MarkLightDirtyIfNotOpaque(blockIterator.GetNorthNeighbor());
-	MarkLightDirtyIfNotOpaque(blockIterator.GetWestNeighbor());
-	MarkLightDirtyIfNotOpaque(blockIterator.GetSouthNeighbor());
-	MarkLightDirtyIfNotOpaque(blockIterator.GetTopNeighbor());
-	MarkLightDirtyIfNotOpaque(blockIterator.GetBottomNeighbor());
+	m_lighting.Discard(chunk);
 }
-
-//------------------------------------------------------------------------------------
-void World::MarkLightingDirty(BlockIterator blockIterator)
-{
-	if (blockIterator.GetBlock()->IsLightDirty())
-	{
-		return;
-	}
-	blockIterator.GetBlock()->SetLightDirty(true);
-	m_queue.push_back(blockIterator);
-}
-
-//------------------------------------------------------------------------------------
-void World::MarkLightingDirty(Chunk* chunk, int index)
-{
-	if (chunk->m_block[index].IsLightDirty())
-	{
-		return;
-	}
-	chunk->m_block[index].SetLightDirty(true);
-	m_queue.push_back(BlockIterator(chunk, index));
-}
-
-//------------------------------------------------------------------------------------
-void World::UndirtyAllBlocksInChunk(Chunk* chunk)
-{
-	std::deque<BlockIterator>::iterator qIterator =	m_queue.begin();
-	while (qIterator != m_queue.end())
-	{
-		if (qIterator->m_chunk == chunk)
-		{
-			chunk->m_block[qIterator->m_blockIndex].SetLightDirty(false);
-			m_queue.erase(qIterator);
-		}
-		qIterator++;
-	}
-}
-
-//------------------------------------------------------------------------------------
\ No newline at end of file
@@ -1,20 +1,40 @@
 #pragma once
 #include "Game/GameCommon.hpp"
 #include "Game/Chunk.hpp"
+#include "Game/ChunkGrid.hpp"
+#include "Game/NoiseTileCache.hpp"
 #include <vector>
 #include <deque>
 #include "BlockIterator.hpp"
 #include <set>
 
-typedef std::map< IntVec2, Chunk* > ChunkMap;
+struct ChunkMeshSnapshot;
+
 class Entity;
 
+// activation jobs still waiting to run, re-prioritized each frame as the camera moves
+struct QueuedChunkJob
+{
+	Job* m_job = nullptr;
+	IntVec2 m_chunkCoords;
+};
+
 class World
 {
 public:
 	virtual ~World();
 	World(int worldSeed);
 	float CalcChunkToCameraDistance(Chunk* chunk);
+	void GetChunkJobUrgency(IntVec2 const& chunkCoords, JobPriority& out_priority, double& out_deadline) const;
+	void QueueChunkJob(Job* job, IntVec2 const& chunkCoords);
+	void UpdateChunkJobPriorities();
+	void RemoveQueuedChunkJob(Job* job);
+	void RetireCompletedChunkJobs();
+	void QueueChunkMeshJobs();
+	void RebuildChunkActivationRing(IntVec2 const& playerChunk);
+	void ActivateChunk(IntVec2 const& chunkCoords);
+	void DeactivateChunk(Chunk* chunk);
+	void UpdateChunkActivation();
 	void Update(float deltaSeconds);
 	void Render();
 
@@ -26,17 +46,12 @@ public:
 	void ClearChunkMap();
 	void LinkNeighbors(Chunk* chunk);
 	void UnlinkNeighbors(Chunk* chunk);
-	void ChangeLightToAtLeastOneLessThanNeighbor( uint8_t& indoor, uint8_t& outdoor, BlockIterator neighbor );
 	void ProcessDirtyLighting();
-	void ProcessNextDirtyLightBlock(BlockIterator& blockIterator);
-	void MarkLightDirtyIfNotOpaque(BlockIterator blockIterator);
-	void MarkNeighborsLightingDirty(BlockIterator blockIterator);
-	void MarkLightingDirty(BlockIterator blockIterator);
-	void MarkLightingDirty(Chunk* chunk, int index);
-	void UndirtyAllBlocksInChunk(Chunk* chunk);
-
-	ChunkMap m_chunks;
-	ChunkMap m_chunksLive;
+	void UpdateBlockLighting(BlockIterator blockIterator);
+	void DiscardChunkLighting(Chunk* chunk);
+
+	ChunkGrid m_chunks;			// active chunks
+	ChunkGrid m_chunksLive;		// active chunks and the ones being generated or loaded
 	std::string m_path;
 
 	int m_worldSeed = 0;
@@ -48,7 +63,21 @@ public:
 	int m_maxChunksRadiusY = 0;
 	int m_maxChunks = 0;
 	int m_chunkCount = 0;
-	std::deque<BlockIterator> m_queue;
+	double m_chunkActivationBudget = 0.001; // seconds per frame spent activating and deactivating, at least one of each still runs
+	std::vector<IntVec2> m_activationOffsets; // every chunk in activation range of the player's chunk, nearest first
+	IntVec2 m_activationCenter; // the player's chunk when the ring and the deactivation queue were built
+	int m_activationCursor = -1; // offsets before it are all live, -1 rebuilds the ring next frame
+	std::vector<IntVec2> m_deactivationQueue; // chunks past m_inactiveRange when the player last crossed a chunk boundary
+	ChunkLighting m_lighting; // light updates queued per chunk, run on workers
+	double m_lightingBudget = 0.002; // seconds per frame spent relighting, whatever is left settles over the next frames
+	std::vector<QueuedChunkJob> m_queuedChunkJobs;
+	IntVec2 m_priorityCenter; // the player's chunk when the queued chunk jobs were last re-ranked
+	double m_lastReprioritizeTime = 0.0;
+	std::vector<Job*> m_completedJobs; // reused every frame for the finished jobs being retired
+	NoiseTileCache m_noiseCache; // shared by every chunk generation job
+	std::vector<ChunkMeshSnapshot*> m_freeMeshSnapshots; // returned by retired mesh jobs for the next ones
+	std::vector<std::pair<float, Chunk*>> m_meshCandidates; // reused every frame, chunks waiting for a mesh by distance
+	int m_meshJobsInFlight = 0;
 
 	Entity* m_player;
 };
\ No newline at end of file
@@ -0,0 +1,106 @@
+// Vertex_Voxel, block corner relative to the chunk and face index in w, light and sprite in color
+struct vs_input_t
+{
+	uint4 localPositionAndFace : POSITION;
+	float4 color : COLOR;
+};
+
+struct v2p_t
+{
+	float4 position : SV_Position;
+	float4 color : COLOR;
+	float2 uv : TEXCOORD;
+	float4 worldPos : WorldPos;
+};
+
+cbuffer VS_CONSTANT_BUFFER : register(b2)
+{
+	float4x4 ProjectionMatrix;
+	float4x4 ViewMatrix;
+};
+
+cbuffer VS_MODEL_BUFFER : register(b3)
+{
+	float4x4 ModelMatrix;
+	float4 ModelColor;
+};
+
+cbuffer GameConstants : register(b8)
+{
+	float4		b_camWorldPos;			// Used for fog thickness calculations, specular lighting, etc.
+	float4		b_skyColor;				// Also used as fog color
+	float4		b_outdoorLightColor;	// Used for outdoor lighting exposure
+	float4		b_indoorLightColor;		// Used for outdoor lighting exposure
+	float		b_fogStartDist;			// Fog has zero opacity at or before this distance
+	float		b_fogEndDist;			// Fog has maximum opacity at or beyond this distance
+	float		b_fogMaxAlpha;			// At and beyond fogEndDist, fog gets this much opacity
+	float		b_time;					// time is a handy value in many instances
+};
+
+Texture2D diffuseTexture : register(t0);
+SamplerState diffuseSampler : register(s0);
+
+v2p_t VertexMain(vs_input_t input)
+{
+	v2p_t v2p;
+	float3 cameraWorldPos = -ViewMatrix._m30_m31_m32;
+	float3 localPosition = float3(input.localPositionAndFace.xyz);
+	float4 localPos = float4(localPosition, 1.0);
+	float4 worldPos = mul(ModelMatrix, localPos);
+	float4 viewPos = mul(ViewMatrix, worldPos);
+	float4 clipPos =  mul(ProjectionMatrix, viewPos);
+	v2p.position = clipPos;
+	v2p.color = input.color * ModelColor;
+	// uvs in blocks along each face's texture axes, matching the orientation Chunk::CreateGeometry gives its quads
+	float2 faceUVs[6] =
+	{
+		float2( localPosition.x, localPosition.y ),		// top
+		float2( localPosition.x, localPosition.z ),		// south
+		float2( localPosition.y, localPosition.z ),		// east
+		float2( -localPosition.x, localPosition.z ),	// north
+		float2( -localPosition.y, localPosition.z ),	// west
+		float2( localPosition.x, -localPosition.y ),	// bottom
+	};
+	v2p.uv = faceUVs[ min( input.localPositionAndFace.w, 5 ) ];
+	v2p.worldPos = worldPos;
+	return v2p;
+}
+
+float3 DiminishingAddComponents( float3 a, float3 b )
+{
+	   return 1.0f - (1.0f - a) * (1.0f - b);
+}
+
+// uvs count blocks and the sprite's column, row come in color.b, color.a so the sprite repeats once per block
+// across merged quads as well as single faces, the atlas is SPRITE_GRID sprites on each side
+static const float2 SPRITE_GRID = float2( 64.0, 64.0 );
+
+float4 PixelMain(v2p_t input) : SV_Target0
+{
+	float2 spriteCoords = round( input.color.ba * 255.0 );
+	float2 spriteSize = 1.0 / SPRITE_GRID;
+	float2 inset = spriteSize * 0.01; // same correction as SpriteSheet::GetSpriteUVs
+	float2 uvMins = float2( spriteCoords.x, SPRITE_GRID.y - 1.0 - spriteCoords.y ) * spriteSize + inset;
+	float2 uvExtent = spriteSize - 2.0 * inset;
+	float2 atlasUV = uvMins + frac( input.uv ) * uvExtent;
+	// gradients from the unwrapped uvs, so mip selection does not jump at every block edge
+	float4 diffuseTexel = diffuseTexture.SampleGrad(diffuseSampler, atlasUV, ddx( input.uv ) * uvExtent, ddy( input.uv ) * uvExtent);
+	clip( diffuseTexel.a - 0.01 );
+	
+	// Compute lit pixel color
+	float outdoorLightExposure = input.color.r;
+	float indoorLightExposure = input.color.g;
+	float3 outdoorLight = outdoorLightExposure * b_outdoorLightColor.rgb;
+	float3 indoorLight = indoorLightExposure * b_indoorLightColor.rgb;
+	float3 diffuseLight = DiminishingAddComponents( outdoorLight, indoorLight );
+	float3 diffuseRGB = diffuseLight * diffuseTexel.rgb;
+	
+	// Compute the fog
+	float3 dispCamToPixel = input.worldPos.xyz - b_camWorldPos.xyz;
+	float distCamToPixel = length( dispCamToPixel );
+	float fogDensity = b_fogMaxAlpha * saturate( (distCamToPixel - b_fogStartDist) / (b_fogEndDist - b_fogStartDist) );
+	float3 finalRGB = lerp( diffuseRGB, b_skyColor.rgb, fogDensity );
+	float finalAlpha = saturate( diffuseTexel.a + fogDensity ); // fog can add opacity
+	float4 finalColor = float4( finalRGB, finalAlpha );
+	return finalColor;
+}
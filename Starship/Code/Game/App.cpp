@@ -13,11 +13,13 @@
 #include "Engine/Renderer/SimpleTriangleFont.hpp"
 #include "Engine/Renderer/Window.hpp"
 #include "Engine/Core/Clock.hpp"
+#include "Engine/Core/Profiler.hpp"
 
 //App* g_theApp = nullptr; // created and owned by Main_windows.cpp?
 Renderer* g_theRenderer = nullptr; // created and owned by the App
 InputSystem* g_theInput = nullptr;
 AudioSystem* g_theAudio = nullptr;
+JobSystem* g_theJobSystem = nullptr;
 Window* g_theWindow = nullptr;
 
 void App::Run()
@@ -36,6 +38,8 @@ App::~App()
 {
 	delete m_theGame;
 	m_theGame = nullptr;
+	delete g_theJobSystem;
+	g_theJobSystem = nullptr;
 	delete g_theAudio;
 	g_theAudio = nullptr;
 	delete g_theConsole;
@@ -77,12 +81,17 @@ void App::Startup()
 	AudioSystemConfig audioSystemConfig;
 	g_theAudio = new AudioSystem(audioSystemConfig);
 
+	JobSystemConfig jobSystemConfig;
+	g_theJobSystem = new JobSystem(jobSystemConfig);
+
 	g_theEventSystem->Startup();
 	g_theInput->Startup();
 	g_theWindow->Startup();
 	g_theRenderer->Startup();
 	g_theConsole->Startup();
 	g_theAudio->Startup();
+	g_theJobSystem->Startup();
+	Profiler::SetThreadName("main");
 
 	m_theGame = new Game(); // create an instance that will handle different modes soon
 	m_theGame->Startup(); // start up the game when there is a renderer
@@ -92,6 +101,7 @@ void App::Shutdown()
 {
 	m_theGame->Shutdown();
 
+	g_theJobSystem->Shutdown();
 	g_theAudio->Shutdown();
 	g_theConsole->Shutdown();
 	g_theRenderer->Shutdown();
@@ -132,6 +142,7 @@ void App::BeginFrame()
 	g_theRenderer->BeginFrame();
 	g_theConsole->BeginFrame();
 	g_theAudio->BeginFrame();
+	g_theJobSystem->BeginFrame();
 };
 
 void App::Update(float deltaSeconds)
@@ -153,6 +164,8 @@ void App::Render() const
 
 void App::EndFrame()
 {
+	g_theJobSystem->EndFrame();
+	Profiler::EndFrame();
 	g_theAudio->EndFrame();
 	g_theConsole->EndFrame();
 	g_theRenderer->EndFrame();
@@ -20,6 +20,8 @@
 #include "Engine/Renderer/SimpleTriangleFont.hpp"
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/JobSystemBenchmark.hpp"
+#include "Engine/Core/Profiler.hpp"
 
 extern AudioSystem* g_theAudio;
 
@@ -31,9 +33,50 @@ bool Command_Test(EventArgs& args)
 	return false;
 }
 
+// console command: parallelbench workers=<max> repeats=<count>
+// scaling of the bullet overlap tests for the current wave, worker count 0 is the serial baseline
+bool Command_ParallelBenchmark(EventArgs& args)
+{
+	Game* game = g_theApp->m_theGame;
+	int maxWorkers = args.GetValue("workers", 16);
+	int repeats = args.GetValue("repeats", 1000);
+	RunParallelScalingBenchmark("bullet hits", maxWorkers, repeats, [game](JobSystem& jobSystem) { game->FindBulletHits(jobSystem); });
+	return true;
+}
+
+// console command: jobidle reset=<true|false>
+// busy, spinning and parked time per worker plus the queue to start latency, since startup or the last reset
+bool Command_JobIdle(EventArgs& args)
+{
+	g_theJobSystem->ReportWorkerIdleStats();
+	if (args.GetValue("reset", false))
+	{
+		g_theJobSystem->ResetWorkerIdleStats();
+		g_theJobSystem->ResetQueueWaitHistograms();
+	}
+	return true;
+}
+
+// console command: jobtrace seconds=<duration> file=<path>
+// starts recording every job run, the next jobtrace (or the time limit) writes Chrome trace JSON for chrome://tracing
+bool Command_JobTrace(EventArgs& args)
+{
+	if (g_theJobSystem->IsTracing())
+	{
+		g_theJobSystem->StopTrace();
+		return true;
+	}
+	g_theJobSystem->StartTrace(args.GetValue("seconds", 0.0f), args.GetValue("file", "JobTrace.json"));
+	return true;
+}
+
 Game::Game()
 {
 	g_theEventSystem->SubscribeEventCallbackFunction("test", Command_Test);
+	g_theEventSystem->SubscribeEventCallbackFunction("parallelbench", Command_ParallelBenchmark);
+	g_theEventSystem->SubscribeEventCallbackFunction("jobidle", Command_JobIdle);
+	g_theEventSystem->SubscribeEventCallbackFunction("jobtrace", Command_JobTrace);
+	g_theEventSystem->SubscribeEventCallbackFunction("profile", Command_Profile);
 }
 
 void Game::Startup()
@@ -75,6 +118,7 @@ void Game::Startup()
 
 void Game::Update(float deltaSeconds)
 {
+	PROFILE_SCOPE("Game::Update");
 	static int frameCount = 0;
 	frameCount++;
 	if (frameCount % 44 == 0)
@@ -324,8 +368,44 @@ void Game::CheckWormholeCollisions()
 	}
 }
 
+// one bit per bullet slot for each enemy it overlaps, filled in parallel since only positions are read
+template <typename EnemyType>
+static void FindEnemyBulletHits(EnemyType* const* enemies, int enemyCount, Bullet* const* bullets, uint64_t* out_hits, JobSystem& jobSystem)
+{
+	jobSystem.ParallelFor(0, enemyCount, COLLISION_ENEMIES_PER_BATCH, [&](int iA)
+	{
+		uint64_t hits = 0;
+		EnemyType const* enemy = enemies[iA];
+		if (enemy && !enemy->m_isDead)
+		{
+			for (int iB = 0; iB < MAX_BULLETS; iB++)
+			{
+				Bullet const* bullet = bullets[iB];
+				if (bullet && !bullet->m_isDead && DoDiscsOverlap(enemy->m_position, enemy->m_physicalRadius, bullet->m_position, bullet->m_physicalRadius))
+				{
+					hits |= 1ull << iB;
+				}
+			}
+		}
+		out_hits[iA] = hits;
+	});
+}
+
+void Game::FindBulletHits(JobSystem& jobSystem)
+{
+	PROFILE_SCOPE("Game::FindBulletHits");
+	static_assert(MAX_BULLETS <= 64, "bullet hits are stored one bit per bullet slot");
+	FindEnemyBulletHits(m_asteroids, MAX_ASTEROIDS, m_bullets, m_asteroidBulletHits, jobSystem);
+	FindEnemyBulletHits(m_wasps, MAX_WASPS, m_bullets, m_waspBulletHits, jobSystem);
+	FindEnemyBulletHits(m_beetles, MAX_BEETLES, m_bullets, m_beetleBulletHits, jobSystem);
+}
+
 void Game::CheckCollisions()
 {
+	PROFILE_SCOPE("Game::CheckCollisions");
+	// overlap tests run up front, hits are then resolved in slot order so bullets die exactly as before
+	FindBulletHits(*g_theJobSystem);
+
 	// Test and handle collisions between entities of interest
 	for (int iA = 0; iA < MAX_ASTEROIDS; iA++)
 	{
@@ -351,7 +431,7 @@ void Game::CheckCollisions()
 			Bullet*& bullet = m_bullets[iB];
 			if (bullet == nullptr || bullet->m_isDead)
 				continue; // skip non-existent or garbage bullets
-			if (DoDiscsOverlap(asteroid->m_position, asteroid->m_physicalRadius, bullet->m_position, bullet->m_physicalRadius))
+			if (m_asteroidBulletHits[iA] & (1ull << iB))
 			{
 				--asteroid->m_health; // bullet hit reduces health by one
 				if (asteroid->m_health <= 0)
@@ -391,7 +471,7 @@ void Game::CheckCollisions()
 			Bullet*& bullet = m_bullets[iB];
 			if (bullet == nullptr || bullet->m_isDead)
 				continue; // skip non-existent or garbage bullets
-			if (DoDiscsOverlap(wasp->m_position, wasp->m_physicalRadius, bullet->m_position, bullet->m_physicalRadius))
+			if (m_waspBulletHits[iA] & (1ull << iB))
 			{
 				--wasp->m_health; // bullet hit reduces health by one
 				if (wasp->m_health <= 0)
@@ -431,7 +511,7 @@ void Game::CheckCollisions()
 			Bullet*& bullet = m_bullets[iB];
 			if (bullet == nullptr || bullet->m_isDead)
 				continue; // skip non-existent or garbage bullets
-			if (DoDiscsOverlap(beetle->m_position, beetle->m_physicalRadius, bullet->m_position, bullet->m_physicalRadius))
+			if (m_beetleBulletHits[iA] & (1ull << iB))
 			{
 				--beetle->m_health; // bullet hit reduces health by one
 				if (beetle->m_health <= 0)
@@ -530,6 +610,7 @@ void Game::DeleteGarbageEntities()
 
 void Game::Render() const
 {
+	PROFILE_SCOPE("Game::Render");
 	std::string str;
 	std::vector<Vertex_PCU> vertexArray;
 	float cellHeight = 0.0f;
@@ -33,6 +33,9 @@ public:
 	Beetle* m_beetles[MAX_BEETLES] = {};
 	Debris* m_debris[MAX_DEBRIS] = {};
 	Wormhole* m_wormhole[MAX_WORMHOLES] = {};
+	uint64_t m_asteroidBulletHits[MAX_ASTEROIDS] = {};	// bit per bullet slot, filled by FindBulletHits
+	uint64_t m_waspBulletHits[MAX_WASPS] = {};
+	uint64_t m_beetleBulletHits[MAX_BEETLES] = {};
 
 	float shakeFraction = 0.0f;
 
@@ -61,6 +64,7 @@ public:
 	void UpdateEntities(float deltaSeconds);
 	void UpdateCameras( float deltaSeconds);
 	void CheckWormholeCollisions();
+	void FindBulletHits(JobSystem& jobSystem);
 	void CheckCollisions();
 	bool WaveComplete();
 	void DeleteGarbageEntities();
@@ -3,6 +3,7 @@
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/InputSystem/XboxController.hpp"
 #include "Engine/Audio/AudioSystem.hpp"
+#include "Engine/Core/JobSystem.hpp"
 #include "Engine/Renderer/SimpleTriangleFont.hpp"
 #include "Engine/Renderer/Window.hpp"
 #include "Engine/Core/Rgba8.hpp"
@@ -15,6 +16,7 @@ constexpr int MAX_BULLETS = 50;
 constexpr int MAX_DEBRIS = 600;
 constexpr int MAX_BEETLES = 6;
 constexpr int MAX_WASPS = 3;
+constexpr int COLLISION_ENEMIES_PER_BATCH = 8; // ParallelFor grain for the bullet overlap tests
 constexpr float WORLD_SIZE_X = 200.f;
 constexpr float WORLD_SIZE_Y = 100.f;
 constexpr float WORLD_CENTER_X = WORLD_SIZE_X / 2.f;
@@ -107,4 +109,5 @@ void DebugDrawRing(Vec2 center, float radius, Rgba8 color, float width);
 extern Renderer* g_theRenderer; // created and owned by the App
 extern InputSystem* g_theInput;
 extern AudioSystem* g_theAudio;
+extern JobSystem* g_theJobSystem;
 extern Window* g_theWindow;
\ No newline at end of file